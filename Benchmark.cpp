@@ -0,0 +1,838 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if MY_VECTOR_PARALLEL_STL
+#include <execution>
+#endif
+#include "MyVector.h"
+#include "MyChunkedReader.h"
+#include "MyConcurrentVector.h"
+#include "MyCowVector.h"
+#include "MyIndexedVector.h"
+#include "MyMappedAllocator.h"
+#include "MySmallVector.h"
+#include "MySoAVector.h"
+/*
+ * BENCHMARK FILE.
+ *
+ * Each benchmark runs a workload a fixed number of times and reports the average time of one run.
+ * Build with optimizations, e.g.: g++ -std=c++17 -O2 -pthread Benchmark.cpp -o Benchmark, or the Benchmark
+ * target of the CMake project (Release by default). Add -DMY_VECTOR_PARALLEL_STL=1 -ltbb to time the std algorithms
+ * with std::execution::par_unseq.
+ *
+ *      --large         also run the 100M element workloads (needs a few GB of memory)
+ *      --json FILE     additionally write every result to FILE as JSON, to track regressions between releases
+ */
+
+
+// Keeps the optimizer from throwing away results we never look at.
+static volatile size_t gSink = 0;
+
+struct BenchmarkResult {
+    std::string mName;
+    size_t mIterations;
+    double mNanoseconds; /// Average time of one run
+};
+
+// Everything measured so far, for the JSON report.
+static MyVector<BenchmarkResult> gResults;
+
+template<typename Workload>
+void runBenchmark(const std::string &name, size_t iterations, Workload workload) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        workload();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(1) << elapsed / iterations << " ns/run" << std::endl;
+    gResults.pushBack({name, iterations, elapsed / iterations});
+}
+
+bool writeJsonReport(const std::string &fileName) {
+    std::ofstream report(fileName);
+    report << "{\n  \"unit\": \"ns/run\",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < gResults.getSize(); i++) {
+        report << "    {\"name\": \"" << gResults[i].mName << "\", \"iterations\": " << gResults[i].mIterations
+               << ", \"nsPerRun\": " << std::fixed << std::setprecision(1) << gResults[i].mNanoseconds << "}"
+               << (i + 1 < gResults.getSize() ? ",\n" : "\n");
+    }
+    report << "  ]\n}\n";
+    return report.good();
+}
+
+// The std algorithms with a parallel execution policy when the standard library has one (libstdc++ needs TBB for
+// it, the CMake project turns this on when it finds TBB), sequential ones otherwise.
+#if MY_VECTOR_PARALLEL_STL
+static const std::string kStdPolicy = "par_unseq";
+
+template<typename Iterator>
+double stdReduce(Iterator first, Iterator last) { return std::reduce(std::execution::par_unseq, first, last, 0.0); }
+
+template<typename Iterator>
+void stdSort(Iterator first, Iterator last) { std::sort(std::execution::par_unseq, first, last); }
+#else
+static const std::string kStdPolicy = "seq";
+
+template<typename Iterator>
+double stdReduce(Iterator first, Iterator last) { return std::reduce(first, last, 0.0); }
+
+template<typename Iterator>
+void stdSort(Iterator first, Iterator last) { std::sort(first, last); }
+#endif
+
+// Comparator that will compare people by their age.
+struct PersonAgeComparator {
+    bool operator()(const Person &firstPerson, const Person &secondPerson) const {
+        return firstPerson.getAge() < secondPerson.getAge();
+    }
+};
+
+/* ============================================================================================================  *
+ *                                     MyVector VS std::vector                                                   |
+ * ============================================================================================================  */
+
+/// find() needs operator==, Person doesn't have one
+template<typename T, typename = void>
+struct HasEquality : std::false_type {};
+
+template<typename T>
+struct HasEquality<T, std::void_t<decltype(std::declval<const T &>() == std::declval<const T &>())>>
+        : std::true_type {};
+
+/**
+ * std::vector counterpart of MyVector::serialize, same file layout.
+ */
+template<typename T>
+void writeStdVector(const std::vector<T> &vector, const std::string &fileName) {
+    std::ofstream outFileStream(fileName, std::ios::binary);
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        MyFileHeader header = MyFileHeader::describe<T>(vector.size());
+        outFileStream.write((char *) &header, sizeof(header));
+        outFileStream.write((char *) vector.data(), static_cast<std::streamsize>(vector.size() * sizeof(T)));
+    } else {
+        size_t size = vector.size();
+        outFileStream.write((char *) &size, sizeof(size));
+        for (const T &element : vector) {
+            myWriteTextElement(outFileStream, element);
+        }
+    }
+}
+
+/**
+ * std::vector counterpart of MyVector::deserialize, same file layout.
+ */
+template<typename T>
+void readStdVector(std::vector<T> &vector, const std::string &fileName) {
+    std::ifstream inputFileStream(fileName, std::ios::binary);
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        MyFileHeader header{};
+        inputFileStream.read((char *) &header, sizeof(header));
+        vector.resize(header.mElementCount);
+        inputFileStream.read((char *) vector.data(), static_cast<std::streamsize>(vector.size() * sizeof(T)));
+    } else {
+        size_t size = 0;
+        inputFileStream.read((char *) &size, sizeof(size));
+        vector.reserve(size);
+        std::string data;
+        for (size_t i = 0; i < size; i++) {
+            T element;
+            myReadTextElement(inputFileStream, element, data);
+            vector.push_back(std::move(element));
+        }
+    }
+}
+
+/**
+ * Runs every workload on MyVector<T> and std::vector<T> side by side, results are named
+ * "MyVector<type> operation/size" and "std::vector<type> operation/size".
+ * @param make - T(size_t i), the i-th element.
+ * @param missing - a value that is not among the elements, for find.
+ * @param less - comparator for both sorts.
+ * @param weight - size_t(const T &), something to add up while iterating.
+ */
+template<typename T, typename Make, typename Less, typename Weight>
+void compareWithStdVector(const std::string &typeName, size_t size, Make make, const T &missing, Less less,
+                          Weight weight) {
+    const std::string my = "MyVector<" + typeName + "> ";
+    const std::string std = "std::vector<" + typeName + "> ";
+    const std::string suffix = "/" + std::to_string(size);
+    const size_t iterations = std::max<size_t>(1, 2000000 / size);
+
+    std::vector<T> values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        values.push_back(make(i));
+    }
+    MyVector<T> myFull;
+    myFull.appendRange(values.begin(), values.end());
+
+    runBenchmark(my + "pushBack" + suffix, iterations, [&] {
+        MyVector<T> vector;
+        for (const T &value : values) {
+            vector.pushBack(value);
+        }
+        gSink += vector.getSize();
+    });
+    runBenchmark(std + "pushBack" + suffix, iterations, [&] {
+        std::vector<T> vector;
+        for (const T &value : values) {
+            vector.push_back(value);
+        }
+        gSink += vector.size();
+    });
+
+    runBenchmark(my + "emplaceBack" + suffix, iterations, [&] {
+        MyVector<T> vector;
+        for (size_t i = 0; i < size; i++) {
+            vector.emplaceBack(make(i));
+        }
+        gSink += vector.getSize();
+    });
+    runBenchmark(std + "emplaceBack" + suffix, iterations, [&] {
+        std::vector<T> vector;
+        for (size_t i = 0; i < size; i++) {
+            vector.emplace_back(make(i));
+        }
+        gSink += vector.size();
+    });
+
+    runBenchmark(my + "copy" + suffix, iterations, [&] {
+        MyVector<T> copy(myFull);
+        gSink += copy.getSize();
+    });
+    runBenchmark(std + "copy" + suffix, iterations, [&] {
+        std::vector<T> copy(values);
+        gSink += copy.size();
+    });
+
+    runBenchmark(my + "move" + suffix, iterations, [&] {
+        MyVector<T> moved(std::move(myFull));
+        myFull = std::move(moved);
+        gSink += myFull.getSize();
+    });
+    runBenchmark(std + "move" + suffix, iterations, [&] {
+        std::vector<T> moved(std::move(values));
+        values = std::move(moved);
+        gSink += values.size();
+    });
+
+    if constexpr (HasEquality<T>::value) {
+        runBenchmark(my + "find (missing)" + suffix, iterations, [&] { gSink += myFull.find(missing); });
+        runBenchmark(std + "find (missing)" + suffix, iterations, [&] {
+            gSink += static_cast<size_t>(std::find(values.begin(), values.end(), missing) - values.begin());
+        });
+    }
+
+    // Every run sorts a fresh copy, so the copy is part of the time on both sides.
+    runBenchmark(my + "sort(compare)" + suffix, iterations, [&] {
+        MyVector<T> copy(myFull);
+        copy.sort(less);
+        gSink += copy.getSize();
+    });
+    runBenchmark(my + "sort(compare, parallel)" + suffix, iterations, [&] {
+        MyVector<T> copy(myFull);
+        copy.sort(less, MyParallelPolicy());
+        gSink += copy.getSize();
+    });
+    runBenchmark(std + "sort(compare)" + suffix, iterations, [&] {
+        std::vector<T> copy(values);
+        std::sort(copy.begin(), copy.end(), less);
+        gSink += copy.size();
+    });
+
+    runBenchmark(my + "iterate" + suffix, iterations, [&] {
+        size_t total = 0;
+        for (const T &element : myFull) {
+            total += weight(element);
+        }
+        gSink += total;
+    });
+    runBenchmark(std + "iterate" + suffix, iterations, [&] {
+        size_t total = 0;
+        for (const T &element : values) {
+            total += weight(element);
+        }
+        gSink += total;
+    });
+
+    const std::string fileName = "Benchmark.bin";
+    runBenchmark(my + "serialize/deserialize" + suffix, iterations, [&] {
+        myFull.serialize(fileName);
+        MyVector<T> loaded;
+        loaded.deserialize(fileName);
+        gSink += loaded.getSize();
+    });
+    runBenchmark(std + "serialize/deserialize" + suffix, iterations, [&] {
+        writeStdVector(values, fileName);
+        std::vector<T> loaded;
+        readStdVector(loaded, fileName);
+        gSink += loaded.size();
+    });
+    std::remove(fileName.c_str());
+}
+
+int main(int argc, char **argv) {
+    bool large = false;
+    std::string jsonFileName;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--large") == 0) {
+            large = true;
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonFileName = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--large] [--json FILE]" << std::endl;
+            return 2;
+        }
+    }
+
+    MyVector<size_t> comparisonSizes = {1000, 100000};
+    if (large) {
+        comparisonSizes.pushBack(10000000);
+    }
+    for (size_t size : comparisonSizes) {
+        compareWithStdVector<int>("int", size, [](size_t i) { return static_cast<int>(i * 2654435761u % 1000003); },
+                                  -1, std::less<int>(), [](int value) { return static_cast<size_t>(value); });
+        compareWithStdVector<std::string>("string", size, [](size_t i) {
+            return "element-number-" + std::to_string(i * 2654435761u % 1000003);
+        }, std::string("missing"), std::less<std::string>(), [](const std::string &value) { return value.size(); });
+        compareWithStdVector<Person>("Person", size, [](size_t i) {
+            return Person("Person" + std::to_string(i), static_cast<int>(i * 7919 % 100));
+        }, Person(), PersonAgeComparator(), [](const Person &person) { return static_cast<size_t>(person.getAge()); });
+    }
+
+    /* ============================================================================================================  *
+     *                                     SHORT VECTORS                                                             |
+     * ============================================================================================================  */
+
+    // Build a short vector and throw it away, like a per-request scratch list.
+    const size_t shortIterations = 1000000;
+    for (size_t length : {4, 8, 16}) {
+        std::string suffix = "/" + std::to_string(length);
+
+        runBenchmark("MyVector<int> build" + suffix, shortIterations, [length] {
+            MyVector<int> vector;
+            for (size_t i = 0; i < length; i++) {
+                vector.pushBack(static_cast<int>(i));
+            }
+            gSink += vector.getSize();
+        });
+
+        runBenchmark("MySmallVector<int, 16> build" + suffix, shortIterations, [length] {
+            MySmallVector<int, 16> vector;
+            for (size_t i = 0; i < length; i++) {
+                vector.pushBack(static_cast<int>(i));
+            }
+            gSink += vector.getSize();
+        });
+
+        runBenchmark("MyVector<Person> build" + suffix, shortIterations, [length] {
+            MyVector<Person> vector;
+            for (size_t i = 0; i < length; i++) {
+                vector.emplaceBack("Andriy", static_cast<int>(i));
+            }
+            gSink += vector.getSize();
+        });
+
+        runBenchmark("MySmallVector<Person, 16> build" + suffix, shortIterations, [length] {
+            MySmallVector<Person, 16> vector;
+            for (size_t i = 0; i < length; i++) {
+                vector.emplaceBack("Andriy", static_cast<int>(i));
+            }
+            gSink += vector.getSize();
+        });
+    }
+
+    /* ============================================================================================================  *
+     *                                     SORT                                                                      |
+     * ============================================================================================================  */
+
+    std::mt19937 random(42);
+    MyVector<size_t> sortSizes = {1000, 1000000};
+    if (large) {
+        sortSizes.pushBack(100000000);
+    }
+    for (size_t size : sortSizes) {
+        std::string suffix = "/" + std::to_string(size);
+        size_t iterations = size <= 1000 ? 1000 : 1;
+
+        MyVector<int> ints;
+        for (size_t i = 0; i < size; i++) {
+            ints.pushBack(static_cast<int>(random()));
+        }
+        runBenchmark("MyVector<int> sort(less)" + suffix, iterations, [&ints] {
+            MyVector<int> copy(ints);
+            copy.sort(std::less<int>());
+            gSink += copy[0];
+        });
+        runBenchmark("MyVector<int> radixSort" + suffix, iterations, [&ints] {
+            MyVector<int> copy(ints);
+            copy.radixSort();
+            gSink += copy[0];
+        });
+        runBenchmark("MyVector<int> sort(less, parallel)" + suffix, iterations, [&ints] {
+            MyVector<int> copy(ints);
+            copy.sort(std::less<int>(), MyParallelPolicy());
+            gSink += copy[0];
+        });
+        runBenchmark("MyVector<int> partialSort(100)" + suffix, iterations, [&ints] {
+            MyVector<int> copy(ints);
+            copy.partialSort(100, std::less<int>());
+            gSink += copy[0];
+        });
+        runBenchmark("MyVector<int> nthElement(median)" + suffix, iterations, [&ints] {
+            MyVector<int> copy(ints);
+            copy.nthElement(copy.getSize() / 2, std::less<int>());
+            gSink += copy[copy.getSize() / 2];
+        });
+
+        if (size > 1000000) {
+            continue; // 100M people would need ~4 GB on their own
+        }
+        MyVector<Person> people;
+        for (size_t i = 0; i < size; i++) {
+            people.emplaceBack("Person", static_cast<int>(random() % 100));
+        }
+        runBenchmark("MyVector<Person> sort(age)" + suffix, iterations, [&people] {
+            MyVector<Person> copy(people);
+            copy.sort(PersonAgeComparator());
+            gSink += copy[0].getAge();
+        });
+        runBenchmark("MyVector<Person> radixSort(age)" + suffix, iterations, [&people] {
+            MyVector<Person> copy(people);
+            copy.radixSort([](const Person &person) { return person.getAge(); });
+            gSink += copy[0].getAge();
+        });
+        runBenchmark("MyVector<Person> sort(age, parallel)" + suffix, iterations, [&people] {
+            MyVector<Person> copy(people);
+            copy.sort(PersonAgeComparator(), MyParallelPolicy());
+            gSink += copy[0].getAge();
+        });
+        runBenchmark("MyVector<Person> sortBy(age)" + suffix, iterations, [&people] {
+            MyVector<Person> copy(people);
+            copy.sortBy([](const Person &person) { return person.getAge(); });
+            gSink += copy[0].getAge();
+        });
+        runBenchmark("MyVector<Person> partialSort(100, age)" + suffix, iterations, [&people] {
+            MyVector<Person> copy(people);
+            copy.partialSort(100, PersonAgeComparator());
+            gSink += copy[0].getAge();
+        });
+        runBenchmark("MyVector<Person> topK(100, age)" + suffix, iterations, [&people] {
+            MyVector<Person> copy(people);
+            copy.topK(100, [](const Person &person) { return person.getAge(); });
+            gSink += copy[0].getAge();
+        });
+
+        // Same people split into a name and an age column: sorts and scans only touch the ages.
+        using PersonAge = MyField<Person, int, &Person::getAge>;
+        MyPersonSoAVector peopleColumns;
+        peopleColumns.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            peopleColumns.pushBack(people[i]);
+        }
+        runBenchmark("MyPersonSoAVector sortBy(age)" + suffix, iterations, [&peopleColumns] {
+            MyPersonSoAVector copy(peopleColumns);
+            copy.sortBy<PersonAge>();
+            gSink += copy[0].get<PersonAge>();
+        });
+        runBenchmark("MyPersonSoAVector radixSortBy(age)" + suffix, iterations, [&peopleColumns] {
+            MyPersonSoAVector copy(peopleColumns);
+            copy.radixSortBy<PersonAge>();
+            gSink += copy[0].get<PersonAge>();
+        });
+        runBenchmark("MyVector<Person> count(age == 42)" + suffix, iterations, [&people] {
+            size_t matches = 0;
+            for (size_t i = 0; i < people.getSize(); i++) {
+                matches += people[i].getAge() == 42 ? 1 : 0;
+            }
+            gSink += matches;
+        });
+        runBenchmark("MyPersonSoAVector count(age == 42)" + suffix, iterations, [&peopleColumns] {
+            gSink += peopleColumns.count<PersonAge>(42);
+        });
+    }
+
+    /* ============================================================================================================  *
+     *                                     FIND                                                                      |
+     * ============================================================================================================  */
+
+    // Worst case membership check: the value isn't there, so every element is looked at.
+    const size_t findSize = 10000000;
+    MyVector<int> findInts;
+    MyVector<char> findChars;
+    MyVector<float> findFloats;
+    for (size_t i = 0; i < findSize; i++) {
+        findInts.pushBack(static_cast<int>(i));
+        findChars.pushBack(static_cast<char>('a' + i % 26));
+        findFloats.pushBack(static_cast<float>(i));
+    }
+    std::string suffix = "/" + std::to_string(findSize);
+    runBenchmark("scalar find<int> (missing)" + suffix, 10, [&findInts] {
+        gSink += myFindScalar(&findInts[0], findInts.getSize(), -1);
+    });
+    runBenchmark("MyVector<int> find (missing)" + suffix, 10, [&findInts] { gSink += findInts.find(-1); });
+    runBenchmark("MyVector<int> count" + suffix, 10, [&findInts] { gSink += findInts.count(42); });
+    runBenchmark("scalar find<char> (missing)" + suffix, 10, [&findChars] {
+        gSink += myFindScalar(&findChars[0], findChars.getSize(), 'Z');
+    });
+    runBenchmark("MyVector<char> find (missing)" + suffix, 10, [&findChars] { gSink += findChars.find('Z'); });
+    runBenchmark("MyVector<float> find (missing)" + suffix, 10, [&findFloats] { gSink += findFloats.find(-1.0f); });
+
+    // Packed flags: one popcount/ctz per 64 of them, against std::vector<bool>.
+    MyVector<bool> findFlags;
+    std::vector<bool> stdFlags;
+    findFlags.resize(findSize, false);
+    stdFlags.resize(findSize, false);
+    for (size_t i = 0; i < findSize; i += 7) {
+        findFlags[i] = true;
+        stdFlags[i] = true;
+    }
+    runBenchmark("MyVector<bool> count" + suffix, 10, [&findFlags] { gSink += findFlags.count(true); });
+    runBenchmark("std::vector<bool> count" + suffix, 10, [&stdFlags] {
+        gSink += static_cast<size_t>(std::count(stdFlags.begin(), stdFlags.end(), true));
+    });
+    MyVector<bool> noFlags;
+    noFlags.resize(findSize, false);
+    runBenchmark("MyVector<bool> find (missing)" + suffix, 10, [&noFlags] { gSink += noFlags.find(true); });
+    runBenchmark("MyVector<bool> &=" + suffix, 10, [&findFlags] {
+        MyVector<bool> copy(findFlags);
+        copy &= findFlags;
+        gSink += copy.getSize();
+    });
+
+    /* ============================================================================================================  *
+     *                                     COMPRESSED SERIALIZATION                                                  |
+     * ============================================================================================================  */
+
+    // Sorted ids, which is what the delta codec is for, written and read back with every codec.
+    {
+        MyVector<int> ids;
+        for (size_t i = 0; i < findSize; i++) {
+            ids.pushBack(static_cast<int>(i * 3 + random() % 3));
+        }
+        const std::string fileName = "Benchmark.bin";
+        const std::pair<const char *, MyCodec> codecs[] = {
+                {"raw", MyCodec::Raw}, {"varint", MyCodec::Varint}, {"delta", MyCodec::DeltaZigZag},
+                {"frame of reference", MyCodec::FrameOfReference}};
+        for (const auto &codec : codecs) {
+            runBenchmark(std::string("MyVector<int> serialize(") + codec.first + ")" + suffix, 3, [&] {
+                gSink += ids.serialize(fileName, codec.second);
+            });
+            runBenchmark(std::string("MyVector<int> deserialize(") + codec.first + ")" + suffix, 3, [&] {
+                MyVector<int> loaded;
+                gSink += loaded.deserialize(fileName);
+            });
+            std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+            std::cout << "    " << codec.first << ": " << file.tellg() << " bytes" << std::endl;
+        }
+
+        // The caller only pays for starting the background write; the total includes the fsync and rename.
+        MyVector<std::future<MyIoStatus>> pending;
+        runBenchmark("MyVector<int> serializeAsync (caller)" + suffix, 3, [&] {
+            pending.emplaceBack(ids.serializeAsync(fileName + std::to_string(pending.getSize())));
+        });
+        for (size_t i = 0; i < pending.getSize(); i++) {
+            gSink += pending[i].get().ok();
+            std::remove((fileName + std::to_string(i)).c_str());
+        }
+        runBenchmark("MyVector<int> serializeAsync (total)" + suffix, 3, [&] {
+            gSink += ids.serializeAsync(fileName).get().ok();
+        });
+        std::remove(fileName.c_str());
+    }
+
+    /* ============================================================================================================  *
+     *                                     CHUNKED SERIALIZATION                                                     |
+     * ============================================================================================================  */
+
+    // A people dump: the text layout against chunked blocks decoded on the shared pool, and reading a slice of
+    // 1000 people out of the middle without loading the rest.
+    {
+        const size_t crowdSize = large ? 10000000 : 1000000;
+        MyVector<Person> crowd;
+        for (size_t i = 0; i < crowdSize; i++) {
+            crowd.emplaceBack("Person" + std::to_string(i), static_cast<int>(i % 90));
+        }
+        std::string suffix = "/" + std::to_string(crowdSize);
+        const std::string textName = "Benchmark.txt";
+        const std::string chunkedName = "Benchmark.chunked";
+        runBenchmark("MyVector<Person> serialize(text)" + suffix, 3, [&] { gSink += crowd.serialize(textName); });
+        runBenchmark("MyVector<Person> serialize(chunked)" + suffix, 3, [&] {
+            gSink += crowd.serialize(chunkedName, MyChunkedOptions());
+        });
+        runBenchmark("MyVector<Person> deserialize(text)" + suffix, 3, [&] {
+            MyVector<Person> loaded;
+            gSink += loaded.deserialize(textName);
+        });
+        runBenchmark("MyVector<Person> deserialize(chunked)" + suffix, 3, [&] {
+            MyVector<Person> loaded;
+            gSink += loaded.deserialize(chunkedName);
+        });
+        runBenchmark("MyChunkedReader<Person> readRange(1000)" + suffix, 10, [&] {
+            MyChunkedReader<Person> reader(chunkedName);
+            MyVector<Person> slice;
+            gSink += reader.readRange(crowdSize / 2, crowdSize / 2 + 1000, slice);
+        });
+        std::remove(textName.c_str());
+        std::remove(chunkedName.c_str());
+    }
+
+    /* ============================================================================================================  *
+     *                                     PARALLEL ALGORITHMS                                                       |
+     * ============================================================================================================  */
+
+    // One thread versus the shared pool (hardware_concurrency() threads) over the same buffer.
+    const size_t parallelSize = large ? 100000000 : 10000000;
+    MyVector<double> doubles;
+    for (size_t i = 0; i < parallelSize; i++) {
+        doubles.pushBack(static_cast<double>(i % 1000));
+    }
+    suffix = "/" + std::to_string(parallelSize);
+    MyParallelPolicy serial{1};
+    MyParallelPolicy parallel;
+    auto sum = [](double left, double right) { return left + right; };
+    auto isBig = [](double value) { return value > 500.0; };
+    runBenchmark("MyVector<double> reduce(serial)" + suffix, 10, [&] {
+        gSink += static_cast<size_t>(doubles.reduce(0.0, sum, serial));
+    });
+    runBenchmark("MyVector<double> reduce(parallel)" + suffix, 10, [&] {
+        gSink += static_cast<size_t>(doubles.reduce(0.0, sum, parallel));
+    });
+    runBenchmark("MyVector<double> countIf(serial)" + suffix, 10, [&] { gSink += doubles.countIf(isBig, serial); });
+    runBenchmark("MyVector<double> countIf(parallel)" + suffix, 10, [&] { gSink += doubles.countIf(isBig, parallel); });
+    runBenchmark("MyVector<double> transform(serial)" + suffix, 10, [&] {
+        doubles.transform([](double value) { return value * 0.5 + 1.0; }, serial);
+    });
+    runBenchmark("MyVector<double> transform(parallel)" + suffix, 10, [&] {
+        doubles.transform([](double value) { return value * 0.5 + 1.0; }, parallel);
+    });
+
+    // The std algorithms on MyVector iterators, std::vector iterators and raw pointers should take the same time.
+    std::vector<double> stdDoubles(doubles.begin(), doubles.end());
+    runBenchmark("std::reduce(" + kStdPolicy + ", MyVector<double>)" + suffix, 10, [&] {
+        gSink += static_cast<size_t>(stdReduce(doubles.cbegin(), doubles.cend()));
+    });
+    runBenchmark("std::reduce(" + kStdPolicy + ", std::vector<double>)" + suffix, 10, [&] {
+        gSink += static_cast<size_t>(stdReduce(stdDoubles.cbegin(), stdDoubles.cend()));
+    });
+    runBenchmark("std::reduce(" + kStdPolicy + ", double *)" + suffix, 10, [&] {
+        gSink += static_cast<size_t>(stdReduce(doubles.data(), doubles.data() + doubles.getSize()));
+    });
+    MyVector<int> unsortedInts;
+    for (size_t i = 0; i < parallelSize / 10; i++) {
+        unsortedInts.pushBack(static_cast<int>(random()));
+    }
+    std::vector<int> stdUnsortedInts(unsortedInts.begin(), unsortedInts.end());
+    std::string sortSuffix = "/" + std::to_string(unsortedInts.getSize());
+    runBenchmark("std::sort(" + kStdPolicy + ", MyVector<int>)" + sortSuffix, 3, [&] {
+        MyVector<int> copy(unsortedInts);
+        stdSort(copy.begin(), copy.end());
+        gSink += static_cast<size_t>(copy[0]);
+    });
+    runBenchmark("std::sort(" + kStdPolicy + ", std::vector<int>)" + sortSuffix, 3, [&] {
+        std::vector<int> copy(stdUnsortedInts);
+        stdSort(copy.begin(), copy.end());
+        gSink += static_cast<size_t>(copy[0]);
+    });
+
+    /* ============================================================================================================  *
+     *                                     GROWTH                                                                    |
+     * ============================================================================================================  */
+
+    // pushBack from empty, the vector grows the whole way: heap blocks get copied, mapped ones grow in place.
+    const size_t growthSize = large ? 1000000000 : 50000000;
+    suffix = "/" + std::to_string(growthSize);
+    runBenchmark("MyVector<int> pushBack" + suffix, 3, [growthSize] {
+        MyVector<int> ints;
+        for (size_t i = 0; i < growthSize; i++) {
+            ints.pushBack(static_cast<int>(i));
+        }
+        gSink += ints.getCapacity();
+    });
+    runBenchmark("MyVector<int, 1.5x> pushBack" + suffix, 3, [growthSize] {
+        MyVector<int, MyHeapAllocator<int>, MyOneAndHalfGrowth> ints;
+        for (size_t i = 0; i < growthSize; i++) {
+            ints.pushBack(static_cast<int>(i));
+        }
+        gSink += ints.getCapacity();
+    });
+    runBenchmark("MyLargeVector<int> pushBack" + suffix, 3, [growthSize] {
+        MyLargeVector<int> ints;
+        for (size_t i = 0; i < growthSize; i++) {
+            ints.pushBack(static_cast<int>(i));
+        }
+        gSink += ints.getCapacity();
+    });
+
+    /* ============================================================================================================  *
+     *                                     CONCURRENT APPEND                                                         |
+     * ============================================================================================================  */
+
+    // Several producers appending to one shared list: lock-free segments versus MyVector behind a mutex.
+    const size_t perProducer = 1000000;
+    for (unsigned producers : {1u, 4u}) {
+        suffix = "/" + std::to_string(producers) + "x" + std::to_string(perProducer);
+        runBenchmark("MyConcurrentVector<long> pushBack" + suffix, 3, [producers, perProducer] {
+            MyConcurrentVector<long> shared;
+            MyVector<std::thread> threads;
+            for (unsigned producer = 0; producer < producers; producer++) {
+                threads.emplaceBack([&shared, perProducer] {
+                    for (size_t i = 0; i < perProducer; i++) {
+                        shared.pushBack(static_cast<long>(i));
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            gSink += shared.getSize();
+        });
+        runBenchmark("MyVector<long> + mutex pushBack" + suffix, 3, [producers, perProducer] {
+            MyVector<long> shared;
+            std::mutex sharedMutex;
+            MyVector<std::thread> threads;
+            for (unsigned producer = 0; producer < producers; producer++) {
+                threads.emplaceBack([&shared, &sharedMutex, perProducer] {
+                    for (size_t i = 0; i < perProducer; i++) {
+                        std::lock_guard<std::mutex> lock(sharedMutex);
+                        shared.pushBack(static_cast<long>(i));
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            gSink += shared.getSize();
+        });
+    }
+
+    /* ============================================================================================================  *
+     *                                     COPY-ON-WRITE                                                             |
+     * ============================================================================================================  */
+
+    // A reader taking a short-lived copy of a large config vector and looking one value up in it.
+    {
+        const size_t configSize = 1000000;
+        MyVector<std::string> configValues;
+        for (size_t i = 0; i < configSize; i++) {
+            configValues.pushBack("setting " + std::to_string(i));
+        }
+        std::string suffix = "/" + std::to_string(configSize);
+        runBenchmark("MyVector<std::string> copy + read" + suffix, 10, [&configValues] {
+            MyVector<std::string> copy(configValues);
+            gSink += copy[12345].size();
+        });
+        MyCowVector<std::string> config(std::move(configValues));
+        runBenchmark("MyCowVector<std::string> snapshot + read" + suffix, 10, [&config] {
+            const MyCowVector<std::string> copy = config.snapshot();
+            gSink += copy[12345].size();
+        });
+        runBenchmark("MyCowVector<std::string> snapshot + write" + suffix, 10, [&config] {
+            MyCowVector<std::string> copy = config.snapshot();
+            copy[12345] = "changed";
+            gSink += copy.getSize();
+        });
+    }
+
+    /* ============================================================================================================  *
+     *                                     REMOVE                                                                    |
+     * ============================================================================================================  */
+
+    // A simulation tick dropping about 30% of its entities, scattered at random. Every run starts from a fresh copy.
+    {
+        const size_t tickSize = 4000000;
+        MyVector<int> entities;
+        std::mt19937 random(7);
+        for (size_t i = 0; i < tickSize; i++) {
+            entities.pushBack(static_cast<int>(random() % 1000000));
+        }
+        auto isDead = [](int entity) { return entity % 10 < 3; };
+        std::string suffix = "/" + std::to_string(tickSize);
+        runBenchmark("MyVector<int> copy" + suffix, 10, [&] {
+            MyVector<int> copy(entities);
+            gSink += copy.getSize();
+        });
+        runBenchmark("MyVector<int> copy + removeIf" + suffix, 10, [&] {
+            MyVector<int> copy(entities);
+            gSink += copy.removeIf(isDead);
+        });
+        runBenchmark("MyVector<int> copy + std::remove_if" + suffix, 10, [&] {
+            MyVector<int> copy(entities);
+            gSink += copy.erase(static_cast<size_t>(std::remove_if(copy.begin(), copy.end(), isDead) - copy.begin()),
+                                copy.getSize());
+        });
+        runBenchmark("MyVector<int> filter into new vector" + suffix, 10, [&] {
+            MyVector<int> survivors;
+            for (int entity : entities) {
+                if (!isDead(entity)) {
+                    survivors.pushBack(entity);
+                }
+            }
+            gSink += survivors.getSize();
+        });
+    }
+
+    /* ============================================================================================================  *
+     *                                     HASH INDEX                                                                |
+     * ============================================================================================================  */
+
+    // Membership lookups against a few million keys, and what keeping the index costs the appends.
+    {
+        const size_t keyCount = 2000000;
+        std::string suffix = "/" + std::to_string(keyCount);
+        runBenchmark("MyVector<long> pushBack" + suffix, 3, [keyCount] {
+            MyVector<long> keys;
+            for (size_t i = 0; i < keyCount; i++) {
+                keys.pushBack(static_cast<long>(i * 3));
+            }
+            gSink += keys.getSize();
+        });
+        runBenchmark("MyIndexedVector<long> pushBack" + suffix, 3, [keyCount] {
+            MyIndexedVector<long> keys;
+            for (size_t i = 0; i < keyCount; i++) {
+                keys.pushBack(static_cast<long>(i * 3));
+            }
+            gSink += keys.getSize();
+        });
+        MyVector<long> plainKeys;
+        for (size_t i = 0; i < keyCount; i++) {
+            plainKeys.pushBack(static_cast<long>(i * 3));
+        }
+        runBenchmark("MyIndexedVector<long> appendRange" + suffix, 3, [&plainKeys] {
+            MyIndexedVector<long> keys;
+            keys.appendRange(plainKeys.begin(), plainKeys.end());
+            gSink += keys.getSize();
+        });
+        MyIndexedVector<long> indexedKeys{MyVector<long>(plainKeys)};
+        runBenchmark("MyVector<long> 100 x contains" + suffix, 3, [&plainKeys] {
+            for (long key = 0; key < 100; key++) {
+                gSink += plainKeys.contains(key * 60001);
+            }
+        });
+        runBenchmark("MyIndexedVector<long> 100 x contains" + suffix, 10, [&indexedKeys] {
+            for (long key = 0; key < 100; key++) {
+                gSink += indexedKeys.contains(key * 60001);
+            }
+        });
+    }
+
+    if (!jsonFileName.empty() && !writeJsonReport(jsonFileName)) {
+        std::cerr << "Couldn't write " << jsonFileName << std::endl;
+        return 1;
+    }
+    return 0;
+}
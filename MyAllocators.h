@@ -0,0 +1,466 @@
+//
+// Allocators that can be plugged into MyVector<T, Alloc>.
+//
+// Every allocator here follows the std allocator shape (value_type, allocate, deallocate, ==) so it also works with
+// standard containers. On top of that MyVector looks for two optional hooks:
+//
+//      reallocate(block, oldCapacity, newCapacity) - moves a block of trivially relocatable elements, may grow in place.
+//      tryExpand(block, oldCapacity, newCapacity)  - grows a block in place without moving it, returns false if it can't.
+//
+// The mmap-backed allocator for very large vectors lives in MyMappedAllocator.h, it is Linux only.
+//
+
+#ifndef VECTOR_MYALLOCATORS_H
+#define VECTOR_MYALLOCATORS_H
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Tells MyVector whether objects of type T can be moved to another address with a plain memcpy, leaving the old
+ * bytes behind without calling a destructor on them. Every trivially copyable type qualifies; specialize this for
+ * your own types (e.g. ones holding only a unique_ptr) to get the same realloc-based growth.
+ */
+template<typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+/// Detects the optional reallocate() hook of an allocator
+template<typename Alloc, typename = void>
+struct HasReallocate : std::false_type {};
+
+template<typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc &>().reallocate(
+        std::declval<typename Alloc::value_type *>(), size_t(), size_t()))>> : std::true_type {};
+
+/// Detects the optional tryExpand() hook of an allocator
+template<typename Alloc, typename = void>
+struct HasTryExpand : std::false_type {};
+
+template<typename Alloc>
+struct HasTryExpand<Alloc, std::void_t<decltype(std::declval<Alloc &>().tryExpand(
+        std::declval<typename Alloc::value_type *>(), size_t(), size_t()))>> : std::true_type {};
+
+/* ============================================================================================================  *
+ *                                     HEAP ALLOCATOR                                                            |
+ * ============================================================================================================  */
+
+/**
+ * Default allocator of MyVector.
+ *
+ * Trivially relocatable elements live in malloc memory so growth can be a single realloc, everything else goes
+ * through operator new.
+ */
+template<typename T>
+class MyHeapAllocator {
+
+private:
+    /// malloc only guarantees alignment up to max_align_t
+    static constexpr bool kUsesMalloc = IsTriviallyRelocatable<T>::value && alignof(T) <= alignof(std::max_align_t);
+    static constexpr bool kOverAligned = alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    MyHeapAllocator() = default;
+
+    template<typename U>
+    MyHeapAllocator(const MyHeapAllocator<U> &) noexcept {}
+
+    T *allocate(size_t capacity) {
+        if constexpr (kUsesMalloc) {
+            void *memBlock = std::malloc(capacity * sizeof(T));
+            if (memBlock == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(memBlock);
+        } else if constexpr (kOverAligned) {
+            return static_cast<T *>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+        } else {
+            return static_cast<T *>(::operator new(capacity * sizeof(T)));
+        }
+    }
+
+    void deallocate(T *memBlock, size_t) noexcept {
+        if constexpr (kUsesMalloc) {
+            std::free(static_cast<void *>(memBlock));
+        } else if constexpr (kOverAligned) {
+            ::operator delete(static_cast<void *>(memBlock), std::align_val_t(alignof(T)));
+        } else {
+            ::operator delete(static_cast<void *>(memBlock));
+        }
+    }
+
+    /**
+     * Moves oldCapacity elements into a block of newCapacity, the C runtime often does it without copying.
+     * Only valid for trivially relocatable T.
+     */
+    T *reallocate(T *memBlock, size_t oldCapacity, size_t newCapacity) {
+        if constexpr (kUsesMalloc) {
+            void *newMemBlock = std::realloc(static_cast<void *>(memBlock), newCapacity * sizeof(T));
+            if (newMemBlock == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(newMemBlock);
+        } else {
+            T *newMemBlock = allocate(newCapacity);
+            if (memBlock != nullptr) {
+                size_t bytes = (oldCapacity < newCapacity ? oldCapacity : newCapacity) * sizeof(T);
+                std::memcpy(static_cast<void *>(newMemBlock), static_cast<const void *>(memBlock), bytes);
+                deallocate(memBlock, oldCapacity);
+            }
+            return newMemBlock;
+        }
+    }
+
+    template<typename U>
+    bool operator==(const MyHeapAllocator<U> &) const noexcept { return true; }
+
+    template<typename U>
+    bool operator!=(const MyHeapAllocator<U> &) const noexcept { return false; }
+};
+
+/* ============================================================================================================  *
+ *                                     ARENA                                                                     |
+ * ============================================================================================================  */
+
+/**
+ * Monotonic arena: hands out memory by bumping a pointer through big chunks and never frees single blocks.
+ * Everything goes away at once with release() or when the arena dies, which fits per-request scratch vectors.
+ *
+ * The block handed out last can still be grown or given back, so a single vector growing in the arena
+ * does not leave a trail of dead copies behind.
+ *
+ * Not thread-safe: use one arena per request/thread.
+ */
+class MyArenaResource {
+
+private:
+    struct Chunk {
+        Chunk *mPrevious; /// Chunks form a list, newest first
+        size_t mSize; /// Usable bytes after the header
+    };
+
+    static constexpr size_t kHeaderSize = (sizeof(Chunk) + alignof(std::max_align_t) - 1)
+                                          & ~(alignof(std::max_align_t) - 1);
+
+    Chunk *mChunks = nullptr; /// Newest chunk, the one we are bumping through
+    char *mCursor = nullptr; /// First free byte of the newest chunk
+    char *mChunkEnd = nullptr; /// One past the last byte of the newest chunk
+    char *mLastBlock = nullptr; /// Start of the last handed out block, the only one that can still grow
+    size_t mChunkSize; /// Minimal size of a new chunk
+
+public:
+    explicit MyArenaResource(size_t chunkSize = 64 * 1024) : mChunkSize(chunkSize) {}
+
+    MyArenaResource(const MyArenaResource &) = delete;
+
+    MyArenaResource &operator=(const MyArenaResource &) = delete;
+
+    ~MyArenaResource() { freeChunks(nullptr); }
+
+    void *allocate(size_t bytes, size_t alignment) {
+        char *block = alignUp(mCursor, alignment);
+        if (mCursor == nullptr || block + bytes > mChunkEnd) {
+            addChunk(bytes + alignment);
+            block = alignUp(mCursor, alignment);
+        }
+        mCursor = block + bytes;
+        mLastBlock = block;
+        return block;
+    }
+
+    /**
+     * Only the most recent block is actually given back, everything else waits for release().
+     */
+    void deallocate(void *block, size_t) noexcept {
+        if (block != nullptr && block == mLastBlock) {
+            mCursor = mLastBlock;
+            mLastBlock = nullptr;
+        }
+    }
+
+    /**
+     * Grows the most recent block in place if the current chunk has room for it.
+     */
+    bool tryExpand(void *block, size_t newBytes) noexcept {
+        if (block == nullptr || block != mLastBlock || mLastBlock + newBytes > mChunkEnd) {
+            return false;
+        }
+        mCursor = mLastBlock + newBytes;
+        return true;
+    }
+
+    /**
+     * Frees everything handed out so far. The first chunk is kept and rewound, so a reused arena
+     * doesn't go back to malloc for small requests.
+     */
+    void release() noexcept {
+        if (mChunks == nullptr) {
+            return;
+        }
+        Chunk *first = mChunks;
+        while (first->mPrevious != nullptr) {
+            first = first->mPrevious;
+        }
+        freeChunks(first);
+        mChunks = first;
+        mCursor = reinterpret_cast<char *>(first) + kHeaderSize;
+        mChunkEnd = mCursor + first->mSize;
+        mLastBlock = nullptr;
+    }
+
+private:
+    static char *alignUp(char *pointer, size_t alignment) {
+        auto address = reinterpret_cast<std::uintptr_t>(pointer);
+        return reinterpret_cast<char *>((address + alignment - 1) & ~(std::uintptr_t(alignment) - 1));
+    }
+
+    void addChunk(size_t minimalBytes) {
+        size_t chunkSize = minimalBytes > mChunkSize ? minimalBytes : mChunkSize;
+        void *memBlock = std::malloc(kHeaderSize + chunkSize);
+        if (memBlock == nullptr) {
+            throw std::bad_alloc();
+        }
+        auto chunk = static_cast<Chunk *>(memBlock);
+        chunk->mPrevious = mChunks;
+        chunk->mSize = chunkSize;
+        mChunks = chunk;
+        mCursor = static_cast<char *>(memBlock) + kHeaderSize;
+        mChunkEnd = mCursor + chunkSize;
+        mLastBlock = nullptr;
+    }
+
+    /**
+     * Frees chunks from the newest one down to (not including) the given one.
+     */
+    void freeChunks(Chunk *keep) noexcept {
+        while (mChunks != nullptr && mChunks != keep) {
+            Chunk *previous = mChunks->mPrevious;
+            std::free(mChunks);
+            mChunks = previous;
+        }
+    }
+};
+
+/**
+ * Typed handle to a MyArenaResource, the arena must outlive every vector using it.
+ */
+template<typename T>
+class MyArenaAllocator {
+
+private:
+    template<typename U> friend class MyArenaAllocator;
+
+    MyArenaResource *mArena;
+
+public:
+    using value_type = T;
+
+    explicit MyArenaAllocator(MyArenaResource &arena) noexcept : mArena(&arena) {}
+
+    template<typename U>
+    MyArenaAllocator(const MyArenaAllocator<U> &anotherAllocator) noexcept : mArena(anotherAllocator.mArena) {}
+
+    T *allocate(size_t capacity) { return static_cast<T *>(mArena->allocate(capacity * sizeof(T), alignof(T))); }
+
+    void deallocate(T *memBlock, size_t capacity) noexcept { mArena->deallocate(memBlock, capacity * sizeof(T)); }
+
+    bool tryExpand(T *memBlock, size_t, size_t newCapacity) noexcept {
+        return mArena->tryExpand(memBlock, newCapacity * sizeof(T));
+    }
+
+    MyArenaResource &getArena() const noexcept { return *mArena; }
+
+    template<typename U>
+    bool operator==(const MyArenaAllocator<U> &anotherAllocator) const noexcept {
+        return mArena == anotherAllocator.mArena;
+    }
+
+    template<typename U>
+    bool operator!=(const MyArenaAllocator<U> &anotherAllocator) const noexcept { return !(*this == anotherAllocator); }
+};
+
+/* ============================================================================================================  *
+ *                                     POOL                                                                      |
+ * ============================================================================================================  */
+
+/**
+ * Size-class pool: blocks are rounded up to a power of two and freed blocks are kept on a per-class free list,
+ * so building and dropping vectors in a loop stops hitting malloc after the first round.
+ *
+ * Every block is a separate malloc, which means a block may be freed into any pool (or to free()) safely.
+ * That lets each thread keep its own pool with no locking at all, see threadLocal().
+ */
+class MyPoolResource {
+
+private:
+    static constexpr size_t kMinBlockShift = 4; /// Smallest class is 16 bytes, enough to hold the free-list link
+    static constexpr size_t kMaxBlockShift = 16; /// Blocks above 64 KiB go straight to malloc
+    static constexpr size_t kClassCount = kMaxBlockShift - kMinBlockShift + 1;
+    static constexpr size_t kCachedBytesPerClass = 256 * 1024; /// Bound on idle memory kept by one class
+
+    struct FreeBlock {
+        FreeBlock *mNext;
+    };
+
+    FreeBlock *mFreeLists[kClassCount] = {}; /// Idle blocks of every class
+    size_t mFreeCounts[kClassCount] = {}; /// Length of each free list
+
+public:
+    MyPoolResource() = default;
+
+    MyPoolResource(const MyPoolResource &) = delete;
+
+    MyPoolResource &operator=(const MyPoolResource &) = delete;
+
+    ~MyPoolResource() { trim(); }
+
+    /**
+     * Pool of the calling thread, created on first use and emptied when the thread exits.
+     */
+    static MyPoolResource &threadLocal() {
+        thread_local MyPoolResource pool;
+        return pool;
+    }
+
+    /**
+     * Bytes actually reserved for a request of the given size.
+     */
+    static size_t blockSize(size_t bytes) noexcept {
+        size_t size = size_t(1) << kMinBlockShift;
+        while (size < bytes) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    void *allocate(size_t bytes) {
+        size_t classIndex = sizeClass(bytes);
+        if (classIndex < kClassCount && mFreeLists[classIndex] != nullptr) {
+            FreeBlock *block = mFreeLists[classIndex];
+            mFreeLists[classIndex] = block->mNext;
+            mFreeCounts[classIndex]--;
+            return block;
+        }
+        void *memBlock = std::malloc(classIndex < kClassCount ? blockSize(bytes) : bytes);
+        if (memBlock == nullptr) {
+            throw std::bad_alloc();
+        }
+        return memBlock;
+    }
+
+    void deallocate(void *memBlock, size_t bytes) noexcept {
+        if (memBlock == nullptr) {
+            return;
+        }
+        size_t classIndex = sizeClass(bytes);
+        if (classIndex >= kClassCount || mFreeCounts[classIndex] >= maxCached(classIndex)) {
+            std::free(memBlock);
+            return;
+        }
+        auto block = static_cast<FreeBlock *>(memBlock);
+        block->mNext = mFreeLists[classIndex];
+        mFreeLists[classIndex] = block;
+        mFreeCounts[classIndex]++;
+    }
+
+    /**
+     * A block can grow for free while the new size still falls into its class.
+     */
+    static bool tryExpand(size_t oldBytes, size_t newBytes) noexcept {
+        return sizeClass(oldBytes) < kClassCount && sizeClass(oldBytes) == sizeClass(newBytes);
+    }
+
+    /**
+     * Gives every idle block back to malloc.
+     */
+    void trim() noexcept {
+        for (size_t i = 0; i < kClassCount; i++) {
+            while (mFreeLists[i] != nullptr) {
+                FreeBlock *next = mFreeLists[i]->mNext;
+                std::free(mFreeLists[i]);
+                mFreeLists[i] = next;
+            }
+            mFreeCounts[i] = 0;
+        }
+    }
+
+private:
+    static size_t sizeClass(size_t bytes) noexcept {
+        size_t shift = kMinBlockShift;
+        while ((size_t(1) << shift) < bytes && shift <= kMaxBlockShift) {
+            shift++;
+        }
+        return shift - kMinBlockShift;
+    }
+
+    static size_t maxCached(size_t classIndex) noexcept {
+        size_t count = kCachedBytesPerClass >> (classIndex + kMinBlockShift);
+        return count < 4 ? 4 : count;
+    }
+};
+
+/**
+ * Typed handle to a MyPoolResource. A default constructed allocator uses the pool of whichever thread
+ * is calling it, so vectors can be moved between threads freely.
+ *
+ * Over-aligned types bypass the pool and use aligned operator new.
+ */
+template<typename T>
+class MyPoolAllocator {
+
+private:
+    template<typename U> friend class MyPoolAllocator;
+
+    static constexpr bool kPooled = alignof(T) <= alignof(std::max_align_t);
+
+    MyPoolResource *mPool = nullptr; /// nullptr means the pool of the calling thread
+
+    MyPoolResource &pool() const { return mPool != nullptr ? *mPool : MyPoolResource::threadLocal(); }
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type; /// Blocks are plain mallocs, any pool can take back any block
+
+    MyPoolAllocator() = default;
+
+    explicit MyPoolAllocator(MyPoolResource &pool) noexcept : mPool(&pool) {}
+
+    template<typename U>
+    MyPoolAllocator(const MyPoolAllocator<U> &anotherAllocator) noexcept : mPool(anotherAllocator.mPool) {}
+
+    T *allocate(size_t capacity) {
+        if constexpr (kPooled) {
+            return static_cast<T *>(pool().allocate(capacity * sizeof(T)));
+        } else {
+            return static_cast<T *>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+        }
+    }
+
+    void deallocate(T *memBlock, size_t capacity) noexcept {
+        if constexpr (kPooled) {
+            pool().deallocate(memBlock, capacity * sizeof(T));
+        } else {
+            ::operator delete(static_cast<void *>(memBlock), std::align_val_t(alignof(T)));
+        }
+    }
+
+    bool tryExpand(T *memBlock, size_t oldCapacity, size_t newCapacity) noexcept {
+        return kPooled && memBlock != nullptr
+               && MyPoolResource::tryExpand(oldCapacity * sizeof(T), newCapacity * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const MyPoolAllocator<U> &) const noexcept { return true; }
+
+    template<typename U>
+    bool operator!=(const MyPoolAllocator<U> &) const noexcept { return false; }
+};
+
+#endif //VECTOR_MYALLOCATORS_H
@@ -0,0 +1,244 @@
+//
+// Double-buffered file output for MyVector::serializeAsync.
+//
+// MyDoubleBufferedFile is a std::streambuf with two buffers and its own I/O thread: while the thread writes one
+// buffer to the file, the encoder fills the other one, and they swap when the encoder runs out of room. Encoding
+// and writing overlap, and the encoder only waits when the disk is slower than it is.
+//
+// By default the data goes to "<fileName>.tmp", which is fsync'ed and then renamed over fileName, so a crash or
+// failure halfway leaves the previous file intact rather than a truncated one.
+//
+// POSIX only (open, fsync, rename).
+//
+
+#ifndef VECTOR_MYASYNCFILE_H
+#define VECTOR_MYASYNCFILE_H
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include "MyCodecs.h"
+#include "MySerialization.h"
+
+/**
+ * What went wrong while writing a file asynchronously.
+ */
+enum class MyIoError {
+    None,
+    Open, /// The (temporary) file couldn't be created
+    Encode, /// The elements can't be written in the requested format/codec
+    Write,
+    Sync, /// fsync failed, the data may not be on disk
+    Rename /// The finished temporary file couldn't replace the target
+};
+
+/**
+ * Outcome of an asynchronous write: which step failed, and the errno it failed with.
+ */
+struct MyIoStatus {
+    MyIoError mError = MyIoError::None;
+    int mErrno = 0;
+
+    bool ok() const { return mError == MyIoError::None; }
+
+    explicit operator bool() const { return ok(); }
+};
+
+/**
+ * How MyVector::serializeAsync writes its file.
+ */
+struct MyAsyncWriteOptions {
+    MyFileFormat mFormat = MyFileFormat::Binary;
+    MyCodec mCodec = MyCodec::Raw; /// Compress the elements, see MyCodecs.h
+    bool mSync = true; /// fsync the file (and the directory after renaming) before reporting success
+    bool mAtomicRename = true; /// Write "<fileName>.tmp" and rename it over fileName once complete
+    size_t mBufferBytes = 1 << 20; /// Size of each of the two buffers
+};
+
+class MyDoubleBufferedFile : public std::streambuf {
+
+private:
+    int mFileDescriptor = -1;
+    std::string mFileName; /// Where the data ends up
+    std::string mWritePath; /// Where it is written to, mFileName or the temporary file
+    MyAsyncWriteOptions mOptions;
+
+    std::unique_ptr<char[]> mBuffers[2];
+    int mFilling = 0; /// Buffer the encoder is filling, the other one may be with the I/O thread
+
+    std::thread mWriter;
+    std::mutex mMutex;
+    std::condition_variable mChanged;
+    size_t mPendingBytes = 0; /// Bytes of the other buffer waiting for the I/O thread, guarded by mMutex
+    bool mPending = false; /// The I/O thread has a buffer to write, guarded by mMutex
+    bool mStopping = false; /// No more buffers will come, guarded by mMutex
+    MyIoStatus mStatus; /// First failure, guarded by mMutex
+
+public:
+    MyDoubleBufferedFile() = default;
+
+    MyDoubleBufferedFile(const MyDoubleBufferedFile &) = delete;
+
+    MyDoubleBufferedFile &operator=(const MyDoubleBufferedFile &) = delete;
+
+    ~MyDoubleBufferedFile() override {
+        if (mFileDescriptor >= 0) {
+            close(false);
+        }
+    }
+
+    /**
+     * Creates the file and starts the I/O thread.
+     */
+    MyIoStatus open(const std::string &fileName, const MyAsyncWriteOptions &options) {
+        mFileName = fileName;
+        mWritePath = options.mAtomicRename ? fileName + ".tmp" : fileName;
+        mOptions = options;
+        mFileDescriptor = ::open(mWritePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (mFileDescriptor < 0) {
+            return MyIoStatus{MyIoError::Open, errno};
+        }
+        size_t bufferBytes = options.mBufferBytes > 0 ? options.mBufferBytes : 1;
+        mBuffers[0].reset(new char[bufferBytes]);
+        mBuffers[1].reset(new char[bufferBytes]);
+        setp(mBuffers[0].get(), mBuffers[0].get() + bufferBytes);
+        mWriter = std::thread([this] { writeLoop(); });
+        return MyIoStatus();
+    }
+
+    /**
+     * Writes what is still buffered, stops the I/O thread and closes the file.
+     * @param commit - fsync and rename into place if everything went well; false (or any failure) removes the
+     * temporary file instead.
+     * @return the first failure, if any.
+     */
+    MyIoStatus close(bool commit = true) {
+        handOff();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mChanged.notify_all();
+        mWriter.join();
+
+        MyIoStatus status = mStatus;
+        if (status && commit && mOptions.mSync && ::fsync(mFileDescriptor) != 0) {
+            status = MyIoStatus{MyIoError::Sync, errno};
+        }
+        if (::close(mFileDescriptor) != 0 && status && commit) {
+            status = MyIoStatus{MyIoError::Write, errno};
+        }
+        mFileDescriptor = -1;
+
+        if (!status || !commit) {
+            if (mOptions.mAtomicRename) {
+                std::remove(mWritePath.c_str());
+            }
+            return status;
+        }
+        if (mOptions.mAtomicRename) {
+            if (std::rename(mWritePath.c_str(), mFileName.c_str()) != 0) {
+                status = MyIoStatus{MyIoError::Rename, errno};
+                std::remove(mWritePath.c_str());
+            } else if (mOptions.mSync) {
+                syncDirectory();
+            }
+        }
+        return status;
+    }
+
+protected:
+    int_type overflow(int_type character) override {
+        if (!handOff()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(character, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(character);
+            pbump(1);
+        }
+        return traits_type::not_eof(character);
+    }
+
+    int sync() override { return handOff() ? 0 : -1; }
+
+private:
+    /**
+     * Gives the filled buffer to the I/O thread, once it is done with the previous one, and continues in the other.
+     * @return false once a write has failed.
+     */
+    bool handOff() {
+        size_t filled = static_cast<size_t>(pptr() - pbase());
+        std::unique_lock<std::mutex> lock(mMutex);
+        mChanged.wait(lock, [this] { return !mPending; });
+        if (!mStatus) {
+            return false;
+        }
+        if (filled == 0) {
+            return true;
+        }
+        mPendingBytes = filled;
+        mPending = true;
+        mFilling ^= 1;
+        lock.unlock();
+        mChanged.notify_all();
+        setp(mBuffers[mFilling].get(), mBuffers[mFilling].get() + (epptr() - pbase()));
+        return true;
+    }
+
+    void writeLoop() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true) {
+            mChanged.wait(lock, [this] { return mPending || mStopping; });
+            if (!mPending) {
+                return;
+            }
+            const char *data = mBuffers[mFilling ^ 1].get();
+            size_t remaining = mPendingBytes;
+            lock.unlock();
+
+            MyIoStatus status;
+            while (remaining > 0) {
+                ssize_t written = ::write(mFileDescriptor, data, remaining);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    status = MyIoStatus{MyIoError::Write, written < 0 ? errno : EIO};
+                    break;
+                }
+                data += written;
+                remaining -= static_cast<size_t>(written);
+            }
+
+            lock.lock();
+            if (mStatus && !status) {
+                mStatus = status;
+            }
+            mPending = false;
+            mChanged.notify_all();
+        }
+    }
+
+    /**
+     * Makes the rename itself durable. Best effort, the data is already on disk.
+     */
+    void syncDirectory() const {
+        size_t slash = mFileName.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : mFileName.substr(0, slash);
+        int directoryDescriptor = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (directoryDescriptor >= 0) {
+            ::fsync(directoryDescriptor);
+            ::close(directoryDescriptor);
+        }
+    }
+};
+
+#endif //VECTOR_MYASYNCFILE_H
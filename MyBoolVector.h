@@ -0,0 +1,575 @@
+//
+// MyVector<bool>: flags packed 64 to a word instead of one byte each.
+//
+// Eight times less memory, and the queries work a whole word at a time: count() is a popcount per word, find()
+// skips words without a match and takes the first one with a ctz, and the bulk &=, |=, ^= combine two vectors
+// 64 flags per instruction. Bits past getSize() in the last word are always zero, so none of them needs a special
+// case for the tail.
+//
+// Since a single bit has no address, operator[] hands out a MyBitReference proxy instead of a bool &:
+//
+//      MyVector<bool> seen;
+//      seen.resize(1000, false);
+//      seen[42] = true;
+//      seen.count(true);   // 1
+//
+// Included by MyVector.h, there is no need to include it directly.
+//
+
+#ifndef VECTOR_MYBOOLVECTOR_H
+#define VECTOR_MYBOOLVECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include "MyFind.h"
+#include "MySerialization.h"
+#include "MyVector.h"
+
+template<typename Alloc, typename Growth>
+class MyVector<bool, Alloc, Growth> {
+
+    static_assert(std::is_same<typename Alloc::value_type, bool>::value, "Alloc::value_type must be bool");
+
+public:
+    using Word = uint64_t;
+    using allocator_type = Alloc;
+
+    static constexpr size_t kWordBits = sizeof(Word) * 8;
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+private:
+    using WordAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Word>;
+
+    MyVector<Word, WordAlloc, Growth> mWords; /// (mSize + 63) / 64 words, flag i is bit i % 64 of word i / 64
+    size_t mSize = 0; /// Number of flags
+
+public:
+    /**
+     * Stands in for bool & : reads and writes one bit of a word.
+     */
+    class MyBitReference {
+        Word *mWord;
+        Word mMask;
+
+    public:
+        MyBitReference(Word *word, size_t bit) : mWord(word), mMask(Word(1) << bit) {}
+
+        operator bool() const { return (*mWord & mMask) != 0; }
+
+        MyBitReference &operator=(bool value) {
+            *mWord = value ? *mWord | mMask : *mWord & ~mMask;
+            return *this;
+        }
+
+        MyBitReference &operator=(const MyBitReference &anotherReference) { return *this = bool(anotherReference); }
+
+        void flip() { *mWord ^= mMask; }
+    };
+
+    MyVector() = default;
+
+    explicit MyVector(const Alloc &allocator) : mWords(WordAlloc(allocator)) {}
+
+    MyVector(std::initializer_list<bool> initializerList, const Alloc &allocator = Alloc())
+            : mWords(WordAlloc(allocator)) {
+        appendRange(initializerList.begin(), initializerList.end());
+    }
+
+    void swap(MyVector<bool, Alloc, Growth> &anotherVector) noexcept {
+        mWords.swap(anotherVector.mWords);
+        std::swap(mSize, anotherVector.mSize);
+    }
+
+    friend void swap(MyVector<bool, Alloc, Growth> &first, MyVector<bool, Alloc, Growth> &second) noexcept {
+        first.swap(second);
+    }
+
+    Alloc getAllocator() const { return Alloc(mWords.getAllocator()); }
+
+    /* ============================================================================================================  *
+     *                                     MODIFIERS                                                                 |
+     * ============================================================================================================  */
+
+    void pushBack(bool value) {
+        if (mSize % kWordBits == 0) {
+            mWords.pushBack(0);
+        }
+        if (value) {
+            mWords[mSize / kWordBits] |= Word(1) << (mSize % kWordBits);
+        }
+        mSize++;
+    }
+
+    MyBitReference emplaceBack(bool value) {
+        pushBack(value);
+        return (*this)[mSize - 1];
+    }
+
+    void popBack() {
+        if (mSize > 0) {
+            resize(mSize - 1);
+        }
+    }
+
+    void clear() {
+        mWords.clear();
+        mSize = 0;
+    }
+
+    void shrinkToFit() { mWords.shrinkToFit(); }
+
+    /**
+     * Flags appended when growing are false.
+     */
+    void resize(size_t newSize) { resize(newSize, false); }
+
+    void resize(size_t newSize, bool value) {
+        size_t oldSize = mSize;
+        mWords.resize(wordsFor(newSize), 0);
+        mSize = newSize;
+        if (newSize > oldSize) {
+            fill(oldSize, newSize, value);
+        } else {
+            clearTail();
+        }
+    }
+
+    /**
+     * Replaces the contents with count copies of value, whole words at a time.
+     */
+    void assign(size_t count, bool value) {
+        mWords.assign(wordsFor(count), value ? ~Word(0) : 0);
+        mSize = count;
+        clearTail();
+    }
+
+    template<typename Iterator>
+    void appendRange(Iterator first, Iterator last) {
+        if constexpr (MyIsForwardIterator<Iterator>::value) {
+            reserve(mSize + static_cast<size_t>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            pushBack(static_cast<bool>(*first));
+        }
+    }
+
+    /**
+     * Removes the flags in [begin, end), the ones after them move left.
+     * @return begin, now the position of the first flag that followed the erased ones.
+     */
+    size_t erase(size_t begin, size_t end) {
+        if (end > mSize) {
+            end = mSize;
+        }
+        if (begin >= end) {
+            return begin;
+        }
+        for (size_t from = end, to = begin; from < mSize; from++, to++) {
+            (*this)[to] = test(from);
+        }
+        resize(mSize - (end - begin));
+        return begin;
+    }
+
+    /* ============================================================================================================  *
+     *                                     ELEMENT ACCESS                                                            |
+     * ============================================================================================================  */
+
+    MyBitReference operator[](size_t position) {
+        return MyBitReference(&mWords[position / kWordBits], position % kWordBits);
+    }
+
+    bool operator[](size_t position) const { return test(position); }
+
+    MyBitReference at(size_t position) { return (*this)[position]; }
+
+    bool test(size_t position) const { return (mWords[position / kWordBits] >> (position % kWordBits)) & 1; }
+
+    /**
+     * Inverts every flag.
+     */
+    void flip() {
+        for (size_t i = 0; i < wordsFor(mSize); i++) {
+            mWords[i] = ~mWords[i];
+        }
+        clearTail();
+    }
+
+    /* ============================================================================================================  *
+     *                                     CAPACITY                                                                  |
+     * ============================================================================================================  */
+
+    size_t getSize() const { return mSize; }
+
+    size_t getCapacity() const { return mWords.getCapacity() * kWordBits; }
+
+    void reserve(size_t capacity) { mWords.reserve(wordsFor(capacity)); }
+
+    /* ============================================================================================================  *
+     *                                     FIND/COUNT                                                                |
+     * ============================================================================================================  */
+
+    /**
+     * Words without a matching flag are skipped whole, the first match in a word is found with ctz.
+     * @return position of the first flag equal to value, npos if there is none.
+     */
+    size_t find(bool value) const { return find(0, mSize, value); }
+
+    /**
+     * @return position of the first flag in [begin, end) equal to value, npos if there is none or the zone is invalid.
+     */
+    size_t find(size_t begin, size_t end, bool value) const {
+        if (begin >= end || end > mSize) {
+            return npos;
+        }
+        size_t firstWord = begin / kWordBits;
+        size_t lastWord = (end - 1) / kWordBits;
+        for (size_t i = firstWord; i <= lastWord; i++) {
+            Word matches = value ? mWords[i] : ~mWords[i];
+            if (i == firstWord) {
+                matches &= ~Word(0) << (begin % kWordBits);
+            }
+            if (i == lastWord) {
+                matches &= lowBits(end - i * kWordBits);
+            }
+            if (matches != 0) {
+                return i * kWordBits + static_cast<size_t>(__builtin_ctzll(matches));
+            }
+        }
+        return npos;
+    }
+
+    /**
+     * One popcount per word.
+     * @return how many flags are equal to value.
+     */
+    size_t count(bool value) const {
+        size_t ones = mSize == 0 ? 0 : myPopCount(&mWords[0], wordsFor(mSize));
+        return value ? ones : mSize - ones;
+    }
+
+    bool contains(bool value) const { return find(value) != npos; }
+
+    bool all() const { return !contains(false); }
+
+    bool any() const { return contains(true); }
+
+    bool none() const { return !contains(true); }
+
+    /* ============================================================================================================  *
+     *                                     BULK OPERATIONS                                                           |
+     * ============================================================================================================  */
+
+    /*
+     * Combine two vectors word by word. The size stays ours: past the end of anotherVector it counts as all false,
+     * its flags past our end are ignored.
+     */
+
+    MyVector<bool, Alloc, Growth> &operator&=(const MyVector<bool, Alloc, Growth> &anotherVector) {
+        size_t common = combine(anotherVector, [](Word &word, Word other) { word &= other; });
+        for (size_t i = common; i < wordsFor(mSize); i++) {
+            mWords[i] = 0;
+        }
+        return *this;
+    }
+
+    MyVector<bool, Alloc, Growth> &operator|=(const MyVector<bool, Alloc, Growth> &anotherVector) {
+        combine(anotherVector, [](Word &word, Word other) { word |= other; });
+        return *this;
+    }
+
+    MyVector<bool, Alloc, Growth> &operator^=(const MyVector<bool, Alloc, Growth> &anotherVector) {
+        combine(anotherVector, [](Word &word, Word other) { word ^= other; });
+        return *this;
+    }
+
+    friend MyVector<bool, Alloc, Growth> operator&(MyVector<bool, Alloc, Growth> first,
+                                                   const MyVector<bool, Alloc, Growth> &second) {
+        return first &= second;
+    }
+
+    friend MyVector<bool, Alloc, Growth> operator|(MyVector<bool, Alloc, Growth> first,
+                                                   const MyVector<bool, Alloc, Growth> &second) {
+        return first |= second;
+    }
+
+    friend MyVector<bool, Alloc, Growth> operator^(MyVector<bool, Alloc, Growth> first,
+                                                   const MyVector<bool, Alloc, Growth> &second) {
+        return first ^= second;
+    }
+
+    bool operator==(const MyVector<bool, Alloc, Growth> &anotherVector) const {
+        if (mSize != anotherVector.mSize) {
+            return false;
+        }
+        for (size_t i = 0; i < wordsFor(mSize); i++) {
+            if (mWords[i] != anotherVector.mWords[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const MyVector<bool, Alloc, Growth> &anotherVector) const { return !(*this == anotherVector); }
+
+    /* ============================================================================================================  *
+     *                                     SERIALIZATION                                                             |
+     * ============================================================================================================  */
+
+    /**
+     * Binary files hold a MyFileHeader (kKindBits, the number of flags) followed by the raw words, 1/8 of a byte
+     * per flag. MyFileFormat::Text writes the usual length-prefixed "0"/"1" per flag.
+     * @return false if the file couldn't be written.
+     */
+    bool serialize(const std::string &fileName, MyFileFormat format = MyFileFormat::Binary) {
+        std::ofstream outFileStream(fileName, std::ios::binary);
+        if (outFileStream.good()) {
+            if (format == MyFileFormat::Binary) {
+                MyFileHeader header = MyFileHeader::describeBits(mSize);
+                outFileStream.write((char *) &header, sizeof(header));
+                if (mSize > 0) {
+                    outFileStream.write((char *) &mWords[0],
+                                        static_cast<std::streamsize>(wordsFor(mSize) * sizeof(Word)));
+                }
+            } else {
+                outFileStream.write((char *) &mSize, sizeof(mSize));
+                for (size_t i = 0; i < mSize; i++) {
+                    myWriteTextElement(outFileStream, test(i));
+                }
+            }
+            outFileStream.close();
+        }
+        return !outFileStream.fail();
+    }
+
+    /**
+     * Appends the flags stored in a file: packed words, the text layout, or one byte per flag as written before
+     * MyVector<bool> was packed.
+     * @return false if the file couldn't be opened, is truncated or holds something else.
+     */
+    bool deserialize(const std::string &fileName) {
+        std::ifstream inputFileStream(fileName, std::ios::binary);
+        if (!inputFileStream) {
+            return false;
+        }
+
+        MyFileHeader header{};
+        inputFileStream.read((char *) &header, sizeof(header.mMagic));
+        if (!inputFileStream) {
+            return false;
+        }
+
+        if (header.hasMagic()) {
+            inputFileStream.read((char *) &header + sizeof(header.mMagic), sizeof(header) - sizeof(header.mMagic));
+            if (inputFileStream && header.holdsBits()) {
+                return readWords(inputFileStream, header.mElementCount,
+                                 header.mEndianness != MyFileHeader::nativeEndianness());
+            }
+            if (inputFileStream && header.template matches<bool>()) {
+                return readBytes(inputFileStream, header.mElementCount);
+            }
+            return false;
+        }
+
+        size_t numberOfElements;
+        std::memcpy(&numberOfElements, header.mMagic, sizeof(numberOfElements));
+        return myReadTextElements<bool>(inputFileStream, numberOfElements,
+                                        [this](size_t count) { reserve(mSize + count); },
+                                        [this](bool element) { pushBack(element); });
+    }
+
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+
+private:
+    template<typename Vector, typename Reference>
+    class MyIterator {
+        Vector *mVector;
+        size_t mPosition;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = bool;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Reference;
+
+        MyIterator(Vector *vector, size_t position) : mVector(vector), mPosition(position) {}
+
+        MyIterator &operator++() noexcept {
+            mPosition++;
+            return *this;
+        }
+
+        MyIterator operator++(int) {
+            MyIterator iterator = *this;
+            ++(*this);
+            return iterator;
+        }
+
+        MyIterator &operator--() {
+            mPosition--;
+            return *this;
+        }
+
+        MyIterator operator--(int) {
+            MyIterator iterator = *this;
+            --(*this);
+            return iterator;
+        }
+
+        Reference operator*() const { return (*mVector)[mPosition]; }
+
+        bool operator==(const MyIterator &iteratorToCompareWith) const {
+            return mPosition == iteratorToCompareWith.mPosition;
+        }
+
+        bool operator!=(const MyIterator &iteratorToCompareWith) const {
+            return mPosition != iteratorToCompareWith.mPosition;
+        }
+    };
+
+public:
+    MyIterator<MyVector<bool, Alloc, Growth>, MyBitReference> begin() { return {this, 0}; }
+
+    MyIterator<MyVector<bool, Alloc, Growth>, MyBitReference> end() { return {this, mSize}; }
+
+    MyIterator<const MyVector<bool, Alloc, Growth>, bool> begin() const { return {this, 0}; }
+
+    MyIterator<const MyVector<bool, Alloc, Growth>, bool> end() const { return {this, mSize}; }
+
+    /* ============================================================================================================  *
+     *                                     UTIL                                                                      |
+     * ============================================================================================================  */
+
+private:
+    static size_t wordsFor(size_t bits) { return (bits + kWordBits - 1) / kWordBits; }
+
+    /// The lowest count bits set, count in [1, 64]
+    static Word lowBits(size_t count) { return count >= kWordBits ? ~Word(0) : (Word(1) << count) - 1; }
+
+    /**
+     * Zeroes the bits past mSize in the last word, every query relies on them being zero.
+     */
+    void clearTail() {
+        if (mSize % kWordBits != 0) {
+            mWords[mSize / kWordBits] &= lowBits(mSize % kWordBits);
+        }
+    }
+
+    /**
+     * Sets the flags in [begin, end) to value: partial words bit-masked, whole words in one store.
+     */
+    void fill(size_t begin, size_t end, bool value) {
+        for (; begin < end && begin % kWordBits != 0; begin++) {
+            (*this)[begin] = value;
+        }
+        for (; begin + kWordBits <= end; begin += kWordBits) {
+            mWords[begin / kWordBits] = value ? ~Word(0) : 0;
+        }
+        for (; begin < end; begin++) {
+            (*this)[begin] = value;
+        }
+    }
+
+    /**
+     * Applies operation(Word &ours, Word theirs) to every word both vectors have.
+     * @return number of words combined.
+     */
+    template<typename Operation>
+    size_t combine(const MyVector<bool, Alloc, Growth> &anotherVector, Operation operation) {
+        size_t common = wordsFor(mSize < anotherVector.mSize ? mSize : anotherVector.mSize);
+        for (size_t i = 0; i < common; i++) {
+            operation(mWords[i], anotherVector.mWords[i]);
+        }
+        clearTail();
+        return common;
+    }
+
+    /**
+     * Appends count packed flags. When we end on a word boundary they are read straight into the words, otherwise
+     * every word read is split across two of ours.
+     */
+    bool readWords(std::istream &inStream, uint64_t count, bool swapped) {
+        size_t words = wordsFor(count);
+        if (myRemainingBytes(inStream) / sizeof(Word) < words) {
+            return false;
+        }
+        size_t oldSize = mSize;
+        if (oldSize % kWordBits == 0) {
+            mWords.resize(wordsFor(oldSize) + words, 0);
+            if (words > 0) {
+                inStream.read((char *) &mWords[wordsFor(oldSize)], static_cast<std::streamsize>(words * sizeof(Word)));
+            }
+            if (!inStream) {
+                mWords.resize(wordsFor(oldSize));
+                return false;
+            }
+            if (swapped && words > 0) {
+                myByteSwap(&mWords[wordsFor(oldSize)], words);
+            }
+            mSize = oldSize + count;
+            clearTail();
+            return true;
+        }
+
+        std::unique_ptr<Word[]> buffer(new Word[words]);
+        if (!inStream.read((char *) buffer.get(), static_cast<std::streamsize>(words * sizeof(Word)))) {
+            return false;
+        }
+        if (swapped) {
+            myByteSwap(buffer.get(), words);
+        }
+        size_t shift = oldSize % kWordBits;
+        resize(oldSize + count);
+        for (size_t i = 0; i < words; i++) {
+            size_t target = oldSize / kWordBits + i;
+            mWords[target] |= buffer[i] << shift;
+            if (target + 1 < wordsFor(mSize)) {
+                mWords[target + 1] |= buffer[i] >> (kWordBits - shift);
+            }
+        }
+        clearTail();
+        return true;
+    }
+
+    /**
+     * Appends count flags stored one byte each.
+     */
+    bool readBytes(std::istream &inStream, uint64_t count) {
+        if (myRemainingBytes(inStream) < count) {
+            return false;
+        }
+        reserve(mSize + count);
+        char buffer[4096];
+        while (count > 0) {
+            size_t chunk = count < sizeof(buffer) ? count : sizeof(buffer);
+            if (!inStream.read(buffer, static_cast<std::streamsize>(chunk))) {
+                return false;
+            }
+            for (size_t i = 0; i < chunk; i++) {
+                pushBack(buffer[i] != 0);
+            }
+            count -= chunk;
+        }
+        return true;
+    }
+
+public:
+
+    void print() const {
+        for (size_t i = 0; i < mSize; i++) {
+            std::cout << test(i) << "; ";
+        }
+        std::cout << std::endl;
+    }
+};
+
+#endif //VECTOR_MYBOOLVECTOR_H
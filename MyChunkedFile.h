@@ -0,0 +1,520 @@
+//
+// Chunked vector files: the elements are cut into blocks of a fixed number of elements, each block is written on
+// its own (raw bytes, a codec from MyCodecs.h, or the text layout for other types) with a CRC32C checksum, and an
+// index of where every block starts sits at the end of the file:
+//
+//      MyFileHeader (mVersion = kChunkedVersion, mCodec = codec of the blocks)
+//      block 0 | block 1 | ... | block n-1
+//      MyChunkedBlock[n]                      offset, size and checksum of every block
+//      MyChunkedTrailer                       block size, block count, where the index starts, its checksum
+//
+// Because blocks don't depend on each other they are encoded and decoded on several threads, and a reader can
+// jump straight to the block holding element i (see MyChunkedReader.h) instead of parsing everything before it.
+// A block that fails its checksum is reported instead of being decoded into garbage.
+//
+// Files are read with pread, POSIX only.
+//
+
+#ifndef VECTOR_MYCHUNKEDFILE_H
+#define VECTOR_MYCHUNKEDFILE_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MyCodecs.h"
+#include "MyFind.h"
+#include "MySerialization.h"
+#include "MyThreadPool.h"
+
+/**
+ * How MyVector::serialize writes a chunked file.
+ */
+struct MyChunkedOptions {
+    size_t mBlockElements = 4096; /// Elements per block: the unit of parallel work and of random access
+    MyCodec mCodec = MyCodec::Raw; /// Codec of every block, see MyCodecs.h
+    MyParallelPolicy mPolicy; /// Threads encoding the blocks
+};
+
+/**
+ * Index entry of one block.
+ */
+struct MyChunkedBlock {
+    uint64_t mOffset; /// From the start of the file
+    uint64_t mBytes;
+    uint32_t mChecksum; /// CRC32C of the block's bytes
+    uint32_t mReserved; /// Zero
+};
+
+/**
+ * Last bytes of a chunked file, found by seeking to its end.
+ */
+struct MyChunkedTrailer {
+    static constexpr char kMagic[8] = {'M', 'Y', 'V', 'E', 'C', 'I', 'D', 'X'};
+
+    char mMagic[8]; /// Always kMagic
+    uint64_t mBlockElements; /// Elements per block, the last block may hold fewer
+    uint64_t mBlockCount;
+    uint64_t mIndexOffset; /// Where the MyChunkedBlock entries start
+    uint32_t mIndexChecksum; /// CRC32C of the entries
+    uint32_t mReserved; /// Zero
+};
+
+static_assert(sizeof(MyChunkedBlock) == 24, "MyChunkedBlock layout must not depend on the compiler");
+static_assert(sizeof(MyChunkedTrailer) == 40, "MyChunkedTrailer layout must not depend on the compiler");
+
+/* ============================================================================================================  *
+ *                                     CHECKSUM                                                                  |
+ * ============================================================================================================  */
+
+/**
+ * Byte-at-a-time table of the CRC32C (Castagnoli) polynomial, reflected.
+ */
+struct MyCrc32cTable {
+    uint32_t mEntries[256];
+
+    constexpr MyCrc32cTable() : mEntries() {
+        for (uint32_t byte = 0; byte < 256; byte++) {
+            uint32_t crc = byte;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+            }
+            mEntries[byte] = crc;
+        }
+    }
+};
+
+inline uint32_t myCrc32cScalar(const char *data, size_t size) {
+    static constexpr MyCrc32cTable table;
+    uint32_t crc = ~0u;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.mEntries[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#if MY_FIND_X86 && defined(__x86_64__)
+
+/// Same checksum with the SSE4.2 crc32 instruction, 8 bytes at a time
+__attribute__((target("sse4.2"))) inline uint32_t myCrc32cHardware(const char *data, size_t size) {
+    uint64_t crc = ~0u;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        crc = _mm_crc32_u64(crc, word);
+    }
+    auto crc32 = static_cast<uint32_t>(crc);
+    for (; i < size; i++) {
+        crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(data[i]));
+    }
+    return ~crc32;
+}
+
+#endif
+
+/**
+ * CRC32C of size bytes, with the crc32 instruction when the CPU has it.
+ */
+inline uint32_t myCrc32c(const char *data, size_t size) {
+#if MY_FIND_X86 && defined(__x86_64__)
+    static const bool hasCrc32 = __builtin_cpu_supports("sse4.2");
+    if (hasCrc32) {
+        return myCrc32cHardware(data, size);
+    }
+#endif
+    return myCrc32cScalar(data, size);
+}
+
+/* ============================================================================================================  *
+ *                                     BLOCKS                                                                    |
+ * ============================================================================================================  */
+
+/**
+ * True if the blocks of T hold raw element bytes rather than encoded or text elements.
+ */
+template<typename T>
+constexpr bool myChunkIsRaw(MyCodec codec) { return std::is_trivially_copyable<T>::value && codec == MyCodec::Raw; }
+
+/**
+ * Read-only std::streambuf over bytes already in memory, so a block can be decoded without copying it.
+ */
+class MyMemoryStreamBuffer : public std::streambuf {
+public:
+    MyMemoryStreamBuffer(const char *data, size_t size) {
+        char *begin = const_cast<char *>(data);
+        setg(begin, begin, begin + size);
+    }
+
+    bool atEnd() const { return gptr() == egptr(); }
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override {
+        if (!(which & std::ios_base::in)) {
+            return pos_type(off_type(-1));
+        }
+        char *base = direction == std::ios_base::beg ? eback() : direction == std::ios_base::cur ? gptr() : egptr();
+        if (offset < eback() - base || offset > egptr() - base) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), base + offset, egptr());
+        return pos_type(gptr() - eback());
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override {
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+};
+
+/**
+ * Encodes count elements as one block: with the codec, or in the text layout when T isn't trivially copyable.
+ * Raw blocks are never encoded, their bytes are written straight from the elements.
+ */
+template<typename T>
+std::string myEncodeChunk(MyCodec codec, const T *data, size_t count) {
+    std::ostringstream outStream;
+    if (codec != MyCodec::Raw) {
+        myEncode(outStream, codec, data, count);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            myWriteTextElement(outStream, data[i]);
+        }
+    }
+    return outStream.str();
+}
+
+/**
+ * Decodes one block of count elements.
+ * @param sink - called in order with (const T *elements, size_t count), or with (T *element, 1) for text elements
+ * which may be moved from.
+ * @return false if the bytes don't hold exactly count elements.
+ */
+template<typename T, typename Sink>
+bool myDecodeChunk(MyCodec codec, const char *bytes, size_t size, size_t count, Sink sink) {
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        if (codec == MyCodec::Raw) {
+            if (size != count * sizeof(T)) {
+                return false;
+            }
+            // Copied out in pieces of about 4 KiB, the bytes needn't be aligned for T
+            constexpr size_t kPiece = sizeof(T) < 4096 ? 4096 / sizeof(T) : 1;
+            alignas(T) unsigned char piece[kPiece * sizeof(T)];
+            for (size_t first = 0; first < count; first += kPiece) {
+                size_t pieceSize = count - first < kPiece ? count - first : kPiece;
+                std::memcpy(piece, bytes + first * sizeof(T), pieceSize * sizeof(T));
+                sink(reinterpret_cast<const T *>(piece), pieceSize);
+            }
+            return true;
+        }
+    }
+    MyMemoryStreamBuffer buffer(bytes, size);
+    std::istream inStream(&buffer);
+    if (codec != MyCodec::Raw) {
+        // Dictionary elements point into the shared entries, so they go out as const
+        auto readOnly = [&sink](const T *elements, size_t elementCount) { sink(elements, elementCount); };
+        return myDecode<T>(inStream, codec, count, readOnly) && buffer.atEnd();
+    }
+    if constexpr (std::is_default_constructible<T>::value) {
+        std::string scratch;
+        for (size_t i = 0; i < count; i++) {
+            T element{};
+            if (!myReadTextElement(inStream, element, scratch)) {
+                return false;
+            }
+            sink(&element, size_t(1));
+        }
+        return buffer.atEnd();
+    } else {
+        return false;
+    }
+}
+
+/* ============================================================================================================  *
+ *                                     WRITE                                                                     |
+ * ============================================================================================================  */
+
+/**
+ * Writes count elements as a chunked file. Blocks are encoded a few per thread at a time and written in order,
+ * so memory stays bounded by those few blocks. Raw blocks are only checksummed, then written in one go.
+ */
+template<typename T>
+void myWriteChunked(std::ostream &outStream, const T *data, size_t count, const MyChunkedOptions &options) {
+    size_t blockElements = options.mBlockElements > 0 ? options.mBlockElements : 1;
+    size_t blockCount = (count + blockElements - 1) / blockElements;
+    size_t chunkCount = myChunkCount(count, options.mPolicy);
+    std::unique_ptr<MyChunkedBlock[]> blocks(new MyChunkedBlock[blockCount]());
+    auto blockSize = [count, blockElements](size_t block) {
+        return count - block * blockElements < blockElements ? count - block * blockElements : blockElements;
+    };
+
+    MyFileHeader header = MyFileHeader::describe<T>(count);
+    header.mVersion = MyFileHeader::kChunkedVersion;
+    header.mCodec = static_cast<uint8_t>(options.mCodec);
+    outStream.write((const char *) &header, sizeof(header));
+    uint64_t offset = sizeof(header);
+
+    if (myChunkIsRaw<T>(options.mCodec)) {
+        myParallelChunks(blockCount, chunkCount < blockCount ? chunkCount : blockCount, options.mPolicy,
+                         [&](size_t, size_t begin, size_t end) {
+                             for (size_t block = begin; block < end; block++) {
+                                 const char *bytes = (const char *) (data + block * blockElements);
+                                 blocks[block].mBytes = blockSize(block) * sizeof(T);
+                                 blocks[block].mChecksum = myCrc32c(bytes, blocks[block].mBytes);
+                             }
+                         });
+        for (size_t block = 0; block < blockCount; block++) {
+            blocks[block].mOffset = offset;
+            offset += blocks[block].mBytes;
+        }
+        outStream.write((const char *) data, static_cast<std::streamsize>(count * sizeof(T)));
+    } else {
+        size_t wave = chunkCount > 1 ? chunkCount : 1;
+        std::unique_ptr<std::string[]> payloads(new std::string[wave]);
+        for (size_t first = 0; first < blockCount; first += wave) {
+            size_t waveBlocks = blockCount - first < wave ? blockCount - first : wave;
+            myParallelChunks(waveBlocks, chunkCount > 1 ? waveBlocks : 1, options.mPolicy,
+                             [&](size_t, size_t begin, size_t end) {
+                                 for (size_t i = begin; i < end; i++) {
+                                     size_t block = first + i;
+                                     payloads[i] = myEncodeChunk(options.mCodec, data + block * blockElements,
+                                                                 blockSize(block));
+                                     blocks[block].mBytes = payloads[i].size();
+                                     blocks[block].mChecksum = myCrc32c(payloads[i].data(), payloads[i].size());
+                                 }
+                             });
+            for (size_t i = 0; i < waveBlocks; i++) {
+                blocks[first + i].mOffset = offset;
+                offset += payloads[i].size();
+                outStream.write(payloads[i].data(), static_cast<std::streamsize>(payloads[i].size()));
+            }
+        }
+    }
+
+    MyChunkedTrailer trailer{};
+    std::memcpy(trailer.mMagic, MyChunkedTrailer::kMagic, sizeof(trailer.mMagic));
+    trailer.mBlockElements = blockElements;
+    trailer.mBlockCount = blockCount;
+    trailer.mIndexOffset = offset;
+    trailer.mIndexChecksum = myCrc32c((const char *) blocks.get(), blockCount * sizeof(MyChunkedBlock));
+    outStream.write((const char *) blocks.get(), static_cast<std::streamsize>(blockCount * sizeof(MyChunkedBlock)));
+    outStream.write((const char *) &trailer, sizeof(trailer));
+}
+
+/* ============================================================================================================  *
+ *                                     READ                                                                      |
+ * ============================================================================================================  */
+
+/**
+ * An open chunked file: its header and block index, and checksummed reads of single blocks. Blocks may be read
+ * from several threads at once.
+ */
+class MyChunkedFile {
+
+private:
+    /// No layout packs more elements into a byte (a dictionary block of 128 equal elements takes 4 bytes), so an
+    /// index claiming more is corrupted, and nothing gets allocated for its elements
+    static constexpr size_t kMaxElementsPerByte = kMyCodecBlockSize / sizeof(uint32_t);
+
+    int mFileDescriptor = -1;
+    MyFileHeader mHeader{};
+    MyChunkedTrailer mTrailer{};
+    std::unique_ptr<MyChunkedBlock[]> mBlocks;
+
+public:
+    MyChunkedFile() = default;
+
+    MyChunkedFile(const MyChunkedFile &) = delete;
+
+    MyChunkedFile &operator=(const MyChunkedFile &) = delete;
+
+    ~MyChunkedFile() {
+        if (mFileDescriptor >= 0) {
+            ::close(mFileDescriptor);
+        }
+    }
+
+    /**
+     * Opens the file and loads its index.
+     * @return false if it can't be opened, isn't a chunked file, or its index is truncated or corrupted.
+     */
+    bool open(const std::string &fileName) {
+        mFileDescriptor = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat status{};
+        if (mFileDescriptor < 0 || ::fstat(mFileDescriptor, &status) != 0) {
+            return false;
+        }
+        auto fileSize = static_cast<uint64_t>(status.st_size);
+        if (fileSize < sizeof(mHeader) + sizeof(mTrailer)
+            || !readFully((char *) &mHeader, sizeof(mHeader), 0) || !mHeader.isChunked()
+            || !readFully((char *) &mTrailer, sizeof(mTrailer), fileSize - sizeof(mTrailer))
+            || std::memcmp(mTrailer.mMagic, MyChunkedTrailer::kMagic, sizeof(mTrailer.mMagic)) != 0
+            || mTrailer.mBlockElements == 0) {
+            return false;
+        }
+
+        uint64_t indexEnd = fileSize - sizeof(mTrailer);
+        uint64_t expectedBlocks = mHeader.mElementCount / mTrailer.mBlockElements
+                                  + (mHeader.mElementCount % mTrailer.mBlockElements != 0 ? 1 : 0);
+        if (mTrailer.mBlockCount != expectedBlocks || mTrailer.mIndexOffset < sizeof(mHeader)
+            || mTrailer.mIndexOffset > indexEnd
+            || (indexEnd - mTrailer.mIndexOffset) / sizeof(MyChunkedBlock) != mTrailer.mBlockCount
+            || (indexEnd - mTrailer.mIndexOffset) % sizeof(MyChunkedBlock) != 0) {
+            return false;
+        }
+        mBlocks.reset(new MyChunkedBlock[mTrailer.mBlockCount]);
+        size_t indexBytes = mTrailer.mBlockCount * sizeof(MyChunkedBlock);
+        if (!readFully((char *) mBlocks.get(), indexBytes, mTrailer.mIndexOffset)
+            || myCrc32c((const char *) mBlocks.get(), indexBytes) != mTrailer.mIndexChecksum) {
+            return false;
+        }
+        for (uint64_t block = 0; block < mTrailer.mBlockCount; block++) {
+            const MyChunkedBlock &entry = mBlocks[block];
+            if (entry.mOffset < sizeof(mHeader) || entry.mOffset > mTrailer.mIndexOffset
+                || entry.mBytes > mTrailer.mIndexOffset - entry.mOffset
+                || blockSize(block) / kMaxElementsPerByte > entry.mBytes) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const MyFileHeader &getHeader() const { return mHeader; }
+
+    MyCodec getCodec() const { return static_cast<MyCodec>(mHeader.mCodec); }
+
+    size_t getElementCount() const { return mHeader.mElementCount; }
+
+    size_t getBlockElements() const { return mTrailer.mBlockElements; }
+
+    size_t getBlockCount() const { return mTrailer.mBlockCount; }
+
+    /**
+     * @return position of the first element of block.
+     */
+    size_t blockFirst(size_t block) const { return block * mTrailer.mBlockElements; }
+
+    /**
+     * @return number of elements in block.
+     */
+    size_t blockSize(size_t block) const {
+        size_t rest = getElementCount() - blockFirst(block);
+        return rest < mTrailer.mBlockElements ? rest : mTrailer.mBlockElements;
+    }
+
+    size_t getBlockBytes(size_t block) const { return mBlocks[block].mBytes; }
+
+    /**
+     * Reads the getBlockBytes(block) bytes of a block into destination.
+     * @return false if the read failed or the bytes don't match the block's checksum.
+     */
+    bool readBlock(size_t block, char *destination) const {
+        const MyChunkedBlock &entry = mBlocks[block];
+        return readFully(destination, entry.mBytes, entry.mOffset)
+               && myCrc32c(destination, entry.mBytes) == entry.mChecksum;
+    }
+
+    /**
+     * Reads and decodes a block, see myDecodeChunk().
+     * @param buffer - scratch for the block's bytes, grown when too small and reused between calls.
+     */
+    template<typename T, typename Sink>
+    bool decodeBlock(size_t block, std::unique_ptr<char[]> &buffer, size_t &bufferSize, Sink sink) const {
+        size_t bytes = getBlockBytes(block);
+        if (bytes > bufferSize) {
+            buffer.reset(new char[bytes]);
+            bufferSize = bytes;
+        }
+        return readBlock(block, buffer.get())
+               && myDecodeChunk<T>(getCodec(), buffer.get(), bytes, blockSize(block), sink);
+    }
+
+private:
+    bool readFully(char *destination, size_t size, uint64_t offset) const {
+        while (size > 0) {
+            ssize_t got = ::pread(mFileDescriptor, destination, size, static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return false;
+            }
+            destination += got;
+            size -= static_cast<size_t>(got);
+            offset += static_cast<uint64_t>(got);
+        }
+        return true;
+    }
+};
+
+/**
+ * Appends the elements [begin, end) of a chunked file to out, decoding only the blocks they lie in. Blocks are
+ * decoded a few per thread at a time into temporary vectors, then moved over in order.
+ * @param out - a MyVector; on failure it keeps the elements it had before.
+ * @return false if the range is past the end of the file or a block is corrupted.
+ */
+template<typename T, typename Vector>
+bool myReadChunkedRange(const MyChunkedFile &file, size_t begin, size_t end, Vector &out,
+                        const MyParallelPolicy &policy) {
+    if (begin > end || end > file.getElementCount()) {
+        return false;
+    }
+    if (begin == end) {
+        return true;
+    }
+    size_t firstBlock = begin / file.getBlockElements();
+    size_t lastBlock = (end - 1) / file.getBlockElements() + 1;
+    size_t chunkCount = myChunkCount(end - begin, policy);
+    size_t wave = chunkCount > 1 ? chunkCount : 1;
+    std::unique_ptr<Vector[]> decoded(new Vector[wave]);
+    std::atomic<bool> ok{true};
+    size_t oldSize = out.getSize();
+    out.reserve(oldSize + (end - begin));
+
+    for (size_t first = firstBlock; first < lastBlock && ok; first += wave) {
+        size_t waveBlocks = lastBlock - first < wave ? lastBlock - first : wave;
+        auto decodeBlocks = [&](size_t, size_t from, size_t to) {
+            std::unique_ptr<char[]> buffer;
+            size_t bufferSize = 0;
+            for (size_t i = from; i < to && ok; i++) {
+                Vector &elements = decoded[i];
+                size_t position = file.blockFirst(first + i);
+                elements.clear();
+                auto append = [&elements, &position, begin, end](auto *values, size_t count) {
+                    // Only the first and the last block may stick out of the range
+                    size_t skip = position < begin ? (begin - position < count ? begin - position : count) : 0;
+                    size_t keep = position + count > end ? (end > position ? end - position : 0) : count;
+                    if (skip < keep) {
+                        elements.appendRange(std::make_move_iterator(values + skip),
+                                             std::make_move_iterator(values + keep));
+                    }
+                    position += count;
+                };
+                if (!file.decodeBlock<T>(first + i, buffer, bufferSize, append)) {
+                    ok = false;
+                }
+            }
+        };
+        myParallelChunks(waveBlocks, chunkCount > 1 ? waveBlocks : 1, policy, decodeBlocks);
+        for (size_t i = 0; i < waveBlocks && ok; i++) {
+            out.appendRange(std::make_move_iterator(decoded[i].begin()), std::make_move_iterator(decoded[i].end()));
+        }
+    }
+    if (!ok) {
+        out.erase(oldSize, out.getSize());
+    }
+    return ok;
+}
+
+#endif //VECTOR_MYCHUNKEDFILE_H
@@ -0,0 +1,94 @@
+//
+// Random access into chunked vector files written by MyVector::serialize(fileName, MyChunkedOptions).
+//
+// The block index at the end of the file tells where the block holding any element starts, so reading element i
+// or a slice only reads and decodes the blocks involved, never what comes before them. The index is loaded once
+// when the reader is opened; the block decoded last is kept, so walking nearby elements with readAt() decodes
+// every block once.
+//
+//      MyChunkedReader<Person> reader("people.chunked");
+//      Person person;
+//      reader.readAt(123456789, person);
+//      MyVector<Person> slice;
+//      reader.readRange(5000000, 5001000, slice);
+//
+
+#ifndef VECTOR_MYCHUNKEDREADER_H
+#define VECTOR_MYCHUNKEDREADER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include "MyChunkedFile.h"
+#include "MyVector.h"
+
+template<typename T>
+class MyChunkedReader {
+
+private:
+    static constexpr size_t kNoBlock = static_cast<size_t>(-1);
+
+    MyChunkedFile mFile;
+    bool mOpen = false; /// File opened, its index accepted and its elements are T
+    MyVector<T> mBlock; /// Elements of the block decoded last
+    size_t mBlockIndex = kNoBlock; /// Which block mBlock holds
+    std::unique_ptr<char[]> mBuffer; /// Bytes of the block being decoded
+    size_t mBufferSize = 0;
+
+public:
+    /**
+     * Opens the file and loads its block index, check isOpen() to see if it worked.
+     */
+    explicit MyChunkedReader(const std::string &fileName) {
+        mOpen = mFile.open(fileName) && mFile.getHeader().template matchesChunked<T>();
+    }
+
+    MyChunkedReader(const MyChunkedReader<T> &) = delete;
+
+    MyChunkedReader<T> &operator=(const MyChunkedReader<T> &) = delete;
+
+    bool isOpen() const { return mOpen; }
+
+    /**
+     * @return number of elements in the whole file.
+     */
+    size_t getSize() const { return mOpen ? mFile.getElementCount() : 0; }
+
+    size_t getBlockElements() const { return mOpen ? mFile.getBlockElements() : 0; }
+
+    /**
+     * Reads the element at position, decoding only its block.
+     * @return false if position is past the end or the block is corrupted.
+     */
+    bool readAt(size_t position, T &element) {
+        if (position >= getSize()) {
+            return false;
+        }
+        size_t block = position / mFile.getBlockElements();
+        if (block != mBlockIndex) {
+            mBlockIndex = kNoBlock;
+            mBlock.clear();
+            auto append = [this](auto *values, size_t count) { mBlock.appendRange(values, values + count); };
+            if (!mFile.decodeBlock<T>(block, mBuffer, mBufferSize, append)) {
+                mBlock.clear();
+                return false;
+            }
+            mBlockIndex = block;
+        }
+        element = mBlock[position - mFile.blockFirst(block)];
+        return true;
+    }
+
+    /**
+     * Appends the elements [begin, end) to out, decoding the blocks involved in parallel.
+     * @return false if the range is past the end or a block is corrupted; out is left as it was.
+     */
+    template<typename Alloc, typename Growth>
+    bool readRange(size_t begin, size_t end, MyVector<T, Alloc, Growth> &out,
+                   const MyParallelPolicy &policy = MyParallelPolicy()) {
+        return mOpen && myReadChunkedRange<T>(mFile, begin, end, out, policy);
+    }
+};
+
+#endif //VECTOR_MYCHUNKEDREADER_H
@@ -0,0 +1,479 @@
+//
+// Compression codecs for the binary vector file format, selected by MyFileHeader::mCodec.
+//
+//      Varint              integers as LEB128, 7 bits per byte; signed ones zigzag encoded first so small
+//                          negative numbers stay short
+//      DeltaZigZag         differences between neighbours, zigzag encoded and bit-packed: sorted or nearly sorted
+//                          integers (ids, timestamps) shrink to a few bits each
+//      FrameOfReference    every value minus the smallest one of its block, bit-packed: integers from a narrow range
+//      Dictionary          every distinct value written once, elements become bit-packed indices into that list:
+//                          strings (or hashable trivially copyable values) that repeat a lot
+//
+// Elements are encoded in blocks of kMyCodecBlockSize, each preceded by its length in bytes and decodable on its
+// own. Inside a block every packed value has the same bit width, so unpacking is one branch-free loop the compiler
+// can vectorize, and a reader can skip or hand out blocks without decoding the ones before them.
+//
+// Encoded files are written in the byte order of the machine, readers of the other byte order reject them.
+//
+
+#ifndef VECTOR_MYCODECS_H
+#define VECTOR_MYCODECS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include "MySerialization.h"
+
+/**
+ * Values of MyFileHeader::mCodec.
+ */
+enum class MyCodec : uint8_t {
+    Raw = 0, /// Element bytes as they are, no codec
+    Varint = 1,
+    DeltaZigZag = 2,
+    FrameOfReference = 3,
+    Dictionary = 4
+};
+
+/// Elements per independently decodable block
+static constexpr size_t kMyCodecBlockSize = 128;
+
+/// Largest payload a block can have: 128 varints of 10 bytes
+static constexpr size_t kMyCodecMaxBlockBytes = kMyCodecBlockSize * 10;
+
+/// Integers the bit-level codecs work on
+template<typename T>
+struct MyIsCodecInteger : std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value
+                                                       && sizeof(T) <= sizeof(uint64_t)> {};
+
+/// Types the dictionary can hold: hashable, comparable, default constructible, and written exactly - std::string as
+/// length + bytes, trivially copyable values as their bytes
+template<typename T, typename = void>
+struct MyIsDictionaryCodable : std::false_type {};
+
+template<typename T>
+struct MyIsDictionaryCodable<T, std::void_t<decltype(std::hash<T>()(std::declval<const T &>())),
+        decltype(std::declval<const T &>() == std::declval<const T &>())>>
+        : std::integral_constant<bool, std::is_default_constructible<T>::value
+                                       && (std::is_same<T, std::string>::value
+                                           || std::is_trivially_copyable<T>::value)> {};
+
+/**
+ * @return true if elements of type T can be written with the given codec.
+ */
+template<typename T>
+constexpr bool myCodecSupports(MyCodec codec) {
+    switch (codec) {
+        case MyCodec::Raw:
+            return std::is_trivially_copyable<T>::value;
+        case MyCodec::Varint:
+        case MyCodec::DeltaZigZag:
+        case MyCodec::FrameOfReference:
+            return MyIsCodecInteger<T>::value;
+        case MyCodec::Dictionary:
+            return MyIsDictionaryCodable<T>::value;
+    }
+    return false;
+}
+
+/* ============================================================================================================  *
+ *                                     BITS                                                                      |
+ * ============================================================================================================  */
+
+/**
+ * Integer widened to 64 bits: signed values sign-extended, so wrapping arithmetic on the result matches T's.
+ */
+template<typename T>
+uint64_t myWiden(T value) {
+    if constexpr (std::is_signed<T>::value) {
+        return static_cast<uint64_t>(static_cast<int64_t>(value));
+    } else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+inline uint64_t myZigZag(uint64_t value) { return (value << 1) ^ (0 - (value >> 63)); }
+
+inline uint64_t myUnZigZag(uint64_t value) { return (value >> 1) ^ (0 - (value & 1)); }
+
+/// Bits needed for value, 0 for 0
+inline unsigned myBitWidth(uint64_t value) {
+    return value == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(value));
+}
+
+/// Words holding count values of the given width
+inline size_t myPackedWords(size_t count, unsigned width) { return (count * width + 63) / 64; }
+
+/**
+ * Packs count values of width bits each back to back into words, which must be zeroed.
+ */
+inline void myPackBits(const uint64_t *values, size_t count, unsigned width, uint64_t *words) {
+    if (width == 0) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t bit = i * width;
+        size_t word = bit / 64;
+        unsigned shift = bit % 64;
+        words[word] |= values[i] << shift;
+        if (shift + width > 64) {
+            words[word + 1] |= values[i] >> (64 - shift);
+        }
+    }
+}
+
+/**
+ * Inverse of myPackBits(). Same steps for every value whatever the data, so the loop vectorizes.
+ */
+inline void myUnpackBits(const uint64_t *words, size_t count, unsigned width, uint64_t *values) {
+    if (width == 0) {
+        std::fill(values, values + count, 0);
+        return;
+    }
+    const uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+    size_t lastWord = myPackedWords(count, width) - 1;
+    for (size_t i = 0; i < count; i++) {
+        size_t bit = i * width;
+        size_t word = bit / 64;
+        unsigned shift = bit % 64;
+        uint64_t low = words[word] >> shift;
+        // The shift by 64 - shift is only taken when the value spills into the next word, i.e. shift > 0
+        uint64_t high = shift + width > 64 && word < lastWord ? words[word + 1] << (64 - shift) : 0;
+        values[i] = (low | high) & mask;
+    }
+}
+
+/* ============================================================================================================  *
+ *                                     BLOCKS                                                                    |
+ * ============================================================================================================  */
+
+/*
+ * A block on disk: uint32 payload length, then the payload.
+ *
+ *      Varint              LEB128 bytes of every value
+ *      DeltaZigZag         first value (8 bytes), bit width (1 byte), packed zigzag deltas of the others
+ *      FrameOfReference    smallest value (8 bytes), bit width (1 byte), packed differences to it
+ *      Dictionary          bit width (1 byte), packed indices
+ */
+
+/**
+ * Appends width (1 byte) and the packed values to payload, at most one block of them.
+ */
+inline void myAppendPacked(std::string &payload, const uint64_t *values, size_t count, unsigned width) {
+    payload.push_back(static_cast<char>(width));
+    uint64_t words[kMyCodecBlockSize] = {};
+    myPackBits(values, count, width, words);
+    payload.append(reinterpret_cast<const char *>(words), myPackedWords(count, width) * sizeof(uint64_t));
+}
+
+/**
+ * Reads what myAppendPacked() wrote.
+ * @return false if the payload is too short or the width is impossible.
+ */
+inline bool myReadPacked(const char *payload, size_t length, size_t count, uint64_t *values) {
+    if (length < 1 || static_cast<unsigned char>(payload[0]) > 64) {
+        return false;
+    }
+    unsigned width = static_cast<unsigned char>(payload[0]);
+    size_t words = myPackedWords(count, width);
+    if (count > kMyCodecBlockSize || length - 1 != words * sizeof(uint64_t)) {
+        return false;
+    }
+    uint64_t packed[kMyCodecBlockSize];
+    std::memcpy(packed, payload + 1, words * sizeof(uint64_t));
+    myUnpackBits(packed, count, width, values);
+    return true;
+}
+
+/**
+ * Encodes one block of widened integers with an integer codec.
+ */
+template<typename T>
+std::string myEncodeIntegerBlock(MyCodec codec, const uint64_t *values, size_t count) {
+    std::string payload;
+    uint64_t scratch[kMyCodecBlockSize];
+    if (codec == MyCodec::Varint) {
+        for (size_t i = 0; i < count; i++) {
+            uint64_t value = std::is_signed<T>::value ? myZigZag(values[i]) : values[i];
+            while (value >= 0x80) {
+                payload.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            payload.push_back(static_cast<char>(value));
+        }
+    } else if (codec == MyCodec::DeltaZigZag) {
+        payload.append(reinterpret_cast<const char *>(values), sizeof(uint64_t));
+        uint64_t widest = 0;
+        for (size_t i = 1; i < count; i++) {
+            scratch[i - 1] = myZigZag(values[i] - values[i - 1]);
+            widest |= scratch[i - 1];
+        }
+        myAppendPacked(payload, scratch, count - 1, myBitWidth(widest));
+    } else {
+        uint64_t reference = values[0];
+        for (size_t i = 1; i < count; i++) {
+            bool smaller = std::is_signed<T>::value ? static_cast<int64_t>(values[i]) < static_cast<int64_t>(reference)
+                                                    : values[i] < reference;
+            reference = smaller ? values[i] : reference;
+        }
+        uint64_t widest = 0;
+        for (size_t i = 0; i < count; i++) {
+            scratch[i] = values[i] - reference;
+            widest |= scratch[i];
+        }
+        payload.append(reinterpret_cast<const char *>(&reference), sizeof(reference));
+        myAppendPacked(payload, scratch, count, myBitWidth(widest));
+    }
+    return payload;
+}
+
+/**
+ * Decodes one block written by myEncodeIntegerBlock() into count widened integers.
+ * @return false if the block is corrupted.
+ */
+template<typename T>
+bool myDecodeIntegerBlock(MyCodec codec, const char *payload, size_t length, size_t count, uint64_t *values) {
+    if (codec == MyCodec::Varint) {
+        size_t position = 0;
+        for (size_t i = 0; i < count; i++) {
+            uint64_t value = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (position >= length || shift > 63) {
+                    return false;
+                }
+                auto byte = static_cast<unsigned char>(payload[position++]);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+            }
+            values[i] = std::is_signed<T>::value ? myUnZigZag(value) : value;
+        }
+        return position == length;
+    }
+
+    uint64_t base;
+    if (length < sizeof(base)) {
+        return false;
+    }
+    std::memcpy(&base, payload, sizeof(base));
+    if (codec == MyCodec::DeltaZigZag) {
+        values[0] = base;
+        if (!myReadPacked(payload + sizeof(base), length - sizeof(base), count - 1, values + 1)) {
+            return false;
+        }
+        for (size_t i = 1; i < count; i++) {
+            values[i] = values[i - 1] + myUnZigZag(values[i]);
+        }
+        return true;
+    }
+    if (!myReadPacked(payload + sizeof(base), length - sizeof(base), count, values)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] += base;
+    }
+    return true;
+}
+
+inline void myWriteBlock(std::ostream &outStream, const std::string &payload) {
+    auto length = static_cast<uint32_t>(payload.size());
+    outStream.write((const char *) &length, sizeof(length));
+    outStream.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+}
+
+/**
+ * Reads the next block into payload, reusing its memory.
+ * @return false if the stream ends before the block does or the length is more than any block can take.
+ */
+inline bool myReadBlock(std::istream &inStream, std::string &payload) {
+    uint32_t length;
+    if (!inStream.read((char *) &length, sizeof(length)) || length > kMyCodecMaxBlockBytes) {
+        return false;
+    }
+    payload.resize(length);
+    return length == 0 || static_cast<bool>(inStream.read(&payload[0], length));
+}
+
+/* ============================================================================================================  *
+ *                                     DICTIONARY                                                                |
+ * ============================================================================================================  */
+
+/**
+ * What the dictionary tells values apart by: floating point values by their bits, so -0.0 doesn't become 0.0
+ * and every NaN keeps its payload; anything else by operator==.
+ */
+template<typename T>
+decltype(auto) myDictionaryKey(const T &value) {
+    if constexpr (std::is_floating_point<T>::value && sizeof(T) <= sizeof(uint64_t)) {
+        std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t> bits;
+        static_assert(sizeof(bits) == sizeof(T), "Unsupported floating point width");
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    } else {
+        return value;
+    }
+}
+
+/// Fewest bytes an entry takes on disk
+template<typename T>
+constexpr size_t myDictionaryEntryMinBytes() {
+    return std::is_same<T, std::string>::value ? sizeof(uint64_t) : sizeof(T);
+}
+
+/**
+ * Writes one dictionary entry: a string as its length and bytes, a trivially copyable value as its bytes.
+ */
+template<typename T>
+void myWriteDictionaryEntry(std::ostream &outStream, const T &entry) {
+    if constexpr (std::is_same<T, std::string>::value) {
+        uint64_t length = entry.size();
+        outStream.write((const char *) &length, sizeof(length));
+        outStream.write(entry.data(), static_cast<std::streamsize>(length));
+    } else {
+        outStream.write((const char *) &entry, sizeof(T));
+    }
+}
+
+/**
+ * Reads what myWriteDictionaryEntry() wrote.
+ * @param remaining - bytes left in the stream, lengths beyond it are corruption rather than a reason to allocate.
+ * @return false if the stream ran out or the entry can't fit in it.
+ */
+template<typename T>
+bool myReadDictionaryEntry(std::istream &inStream, T &entry, uint64_t &remaining) {
+    if constexpr (std::is_same<T, std::string>::value) {
+        uint64_t length;
+        if (remaining < sizeof(length) || !inStream.read((char *) &length, sizeof(length))
+            || length > remaining - sizeof(length)) {
+            return false;
+        }
+        remaining -= sizeof(length) + length;
+        entry.resize(length);
+        return length == 0 || static_cast<bool>(inStream.read(&entry[0], static_cast<std::streamsize>(length)));
+    } else {
+        remaining -= sizeof(T);
+        return static_cast<bool>(inStream.read((char *) &entry, sizeof(T)));
+    }
+}
+
+/* ============================================================================================================  *
+ *                                     ENCODE/DECODE                                                             |
+ * ============================================================================================================  */
+
+/**
+ * Writes count elements with the given codec, the header is the caller's business.
+ * The codec must be supported for T, see myCodecSupports().
+ */
+template<typename T>
+void myEncode(std::ostream &outStream, MyCodec codec, const T *data, size_t count) {
+    if constexpr (MyIsCodecInteger<T>::value) {
+        if (codec != MyCodec::Dictionary) {
+            uint64_t values[kMyCodecBlockSize];
+            for (size_t first = 0; first < count; first += kMyCodecBlockSize) {
+                size_t blockSize = count - first < kMyCodecBlockSize ? count - first : kMyCodecBlockSize;
+                for (size_t i = 0; i < blockSize; i++) {
+                    values[i] = myWiden(data[first + i]);
+                }
+                myWriteBlock(outStream, myEncodeIntegerBlock<T>(codec, values, blockSize));
+            }
+            return;
+        }
+    }
+    if constexpr (MyIsDictionaryCodable<T>::value) {
+        // Dictionary: distinct values in order of first appearance, then the blocks of indices
+        std::unordered_map<std::decay_t<decltype(myDictionaryKey(*data))>, uint64_t> indexOf;
+        std::unique_ptr<uint64_t[]> indices(new uint64_t[count]);
+        std::unique_ptr<const T *[]> entries(new const T *[count]);
+        uint64_t entryCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            auto inserted = indexOf.try_emplace(myDictionaryKey(data[i]), entryCount);
+            if (inserted.second) {
+                entries[entryCount++] = &data[i];
+            }
+            indices[i] = inserted.first->second;
+        }
+        outStream.write((const char *) &entryCount, sizeof(entryCount));
+        for (uint64_t i = 0; i < entryCount; i++) {
+            myWriteDictionaryEntry(outStream, *entries[i]);
+        }
+        unsigned width = myBitWidth(entryCount == 0 ? 0 : entryCount - 1);
+        for (size_t first = 0; first < count; first += kMyCodecBlockSize) {
+            size_t blockSize = count - first < kMyCodecBlockSize ? count - first : kMyCodecBlockSize;
+            std::string payload;
+            myAppendPacked(payload, indices.get() + first, blockSize, width);
+            myWriteBlock(outStream, payload);
+        }
+    }
+}
+
+/**
+ * Reads count elements written by myEncode(), block by block.
+ * @param sink - void(const T *elements, size_t count), called with the decoded elements in order.
+ * @return false if the data is corrupted or the codec doesn't fit T.
+ */
+template<typename T, typename Sink>
+bool myDecode(std::istream &inStream, MyCodec codec, uint64_t count, Sink sink) {
+    if (!myCodecSupports<T>(codec) || codec == MyCodec::Raw) {
+        return false;
+    }
+    std::string payload;
+    uint64_t values[kMyCodecBlockSize];
+    if constexpr (MyIsCodecInteger<T>::value) {
+        if (codec != MyCodec::Dictionary) {
+            T block[kMyCodecBlockSize];
+            for (uint64_t first = 0; first < count; first += kMyCodecBlockSize) {
+                size_t blockSize = count - first < kMyCodecBlockSize ? count - first : kMyCodecBlockSize;
+                if (!myReadBlock(inStream, payload)
+                    || !myDecodeIntegerBlock<T>(codec, payload.data(), payload.size(), blockSize, values)) {
+                    return false;
+                }
+                for (size_t i = 0; i < blockSize; i++) {
+                    block[i] = static_cast<T>(values[i]);
+                }
+                sink(block, blockSize);
+            }
+            return true;
+        }
+    }
+    if constexpr (MyIsDictionaryCodable<T>::value) {
+        uint64_t entryCount;
+        if (!inStream.read((char *) &entryCount, sizeof(entryCount))) {
+            return false;
+        }
+        uint64_t remaining = myRemainingBytes(inStream);
+        if (remaining / myDictionaryEntryMinBytes<T>() < entryCount) {
+            return false;
+        }
+        std::unique_ptr<T[]> entries(new T[entryCount]);
+        for (uint64_t i = 0; i < entryCount; i++) {
+            if (!myReadDictionaryEntry(inStream, entries[i], remaining)) {
+                return false;
+            }
+        }
+        for (uint64_t first = 0; first < count; first += kMyCodecBlockSize) {
+            size_t blockSize = count - first < kMyCodecBlockSize ? count - first : kMyCodecBlockSize;
+            if (!myReadBlock(inStream, payload) || !myReadPacked(payload.data(), payload.size(), blockSize, values)) {
+                return false;
+            }
+            for (size_t i = 0; i < blockSize; i++) {
+                if (values[i] >= entryCount) {
+                    return false;
+                }
+                sink(&entries[values[i]], 1);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+#endif //VECTOR_MYCODECS_H
@@ -0,0 +1,143 @@
+//
+// In-place stream compaction behind MyVector::removeIf: drops the elements a predicate picks and closes the gaps,
+// keeping the order of the survivors, in a single pass.
+//
+// 4 and 8 byte arithmetic elements are compacted with AVX2 when the CPU has it: for every block of 32 bytes the
+// predicate gives a mask of the survivors, a lookup table turns the mask into a lane permutation, and one
+// permute + one unaligned store write them all at once. The store may spill garbage past the survivors, but only
+// into the block that has just been loaded, so nothing unread is lost.
+// Other trivially copyable elements take a branch-free scalar loop, everything else a plain move loop.
+//
+
+#ifndef VECTOR_MYCOMPACT_H
+#define VECTOR_MYCOMPACT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "MyFind.h"
+
+/* ============================================================================================================  *
+ *                                     SCALAR                                                                    |
+ * ============================================================================================================  */
+
+/**
+ * Moves the survivors of [data, data + count) to the front. Elements before the first removed one stay put.
+ * @return number of survivors; [survivors, count) holds moved-from objects.
+ */
+template<typename T, typename Predicate>
+size_t myRemoveIfScalar(T *data, size_t count, Predicate &remove) {
+    T *end = data + count;
+    T *write = data;
+    while (write != end && !remove(static_cast<const T &>(*write))) {
+        ++write;
+    }
+    if (write == end) {
+        return count;
+    }
+    for (T *read = write + 1; read != end; ++read) {
+        if (!remove(static_cast<const T &>(*read))) {
+            *write++ = std::move(*read);
+        }
+    }
+    return static_cast<size_t>(write - data);
+}
+
+/**
+ * Same for trivially copyable elements: every element is copied to the write position, which only moves on for
+ * survivors, so the loop has no data dependent branch.
+ */
+template<typename T, typename Predicate>
+size_t myRemoveIfBranchless(T *data, size_t count, Predicate &remove, size_t read = 0, size_t write = 0) {
+    for (; read < count; read++) {
+        T value = data[read];
+        data[write] = value;
+        write += remove(static_cast<const T &>(value)) ? 0 : 1;
+    }
+    return write;
+}
+
+/* ============================================================================================================  *
+ *                                     AVX2                                                                      |
+ * ============================================================================================================  */
+
+#if MY_FIND_X86
+
+/**
+ * For every mask of survivors among Lanes elements, the 32-bit lane indices that gather them to the front.
+ * 8-byte elements take two 32-bit lanes each.
+ */
+template<size_t Lanes>
+struct MyCompactTable {
+    alignas(32) uint32_t mOrder[1u << Lanes][8];
+
+    constexpr MyCompactTable() : mOrder() {
+        constexpr uint32_t kWordsPerLane = 8 / Lanes;
+        for (uint32_t mask = 0; mask < (1u << Lanes); mask++) {
+            uint32_t next = 0;
+            for (uint32_t lane = 0; lane < Lanes; lane++) {
+                if ((mask >> lane) & 1) {
+                    for (uint32_t word = 0; word < kWordsPerLane; word++) {
+                        mOrder[mask][next++] = lane * kWordsPerLane + word;
+                    }
+                }
+            }
+        }
+    }
+};
+
+template<size_t Lanes>
+const MyCompactTable<Lanes> &myCompactTable() {
+    static constexpr MyCompactTable<Lanes> table;
+    return table;
+}
+
+template<typename T, typename Predicate>
+__attribute__((target("avx2,popcnt"))) size_t myRemoveIfAvx2(T *data, size_t count, Predicate &remove) {
+    constexpr size_t kLanes = 32 / sizeof(T);
+    const auto &table = myCompactTable<kLanes>();
+    size_t write = 0;
+    size_t read = 0;
+    for (; read + kLanes <= count; read += kLanes) {
+        unsigned keep = 0;
+        for (size_t lane = 0; lane < kLanes; lane++) {
+            keep |= (remove(static_cast<const T &>(data[read + lane])) ? 0u : 1u) << lane;
+        }
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + read));
+        __m256i order = _mm256_load_si256(reinterpret_cast<const __m256i *>(table.mOrder[keep]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + write), _mm256_permutevar8x32_epi32(block, order));
+        write += static_cast<size_t>(__builtin_popcount(keep));
+    }
+    return myRemoveIfBranchless(data, count, remove, read, write);
+}
+
+#endif
+
+/* ============================================================================================================  *
+ *                                     DISPATCH                                                                  |
+ * ============================================================================================================  */
+
+/**
+ * Stable in-place removal of every element remove(const T &) picks, each survivor is moved at most once.
+ * @return number of survivors, now at the front; the rest are moved-from (or stale copies) and must be destroyed.
+ */
+template<typename T, typename Predicate>
+size_t myRemoveIf(T *data, size_t count, Predicate &remove) {
+    if constexpr (std::is_arithmetic<T>::value) {
+#if MY_FIND_X86
+        if constexpr (sizeof(T) == 4 || sizeof(T) == 8) {
+            if (mySimdLevel() == MySimdLevel::Avx2) {
+                return myRemoveIfAvx2(data, count, remove);
+            }
+        }
+#endif
+        return myRemoveIfBranchless(data, count, remove);
+    } else if constexpr (std::is_trivially_copyable<T>::value) {
+        return myRemoveIfBranchless(data, count, remove);
+    } else {
+        return myRemoveIfScalar(data, count, remove);
+    }
+}
+
+#endif //VECTOR_MYCOMPACT_H
@@ -0,0 +1,376 @@
+//
+// Append-only vector many threads can push to at once, without a lock.
+//
+// Elements live in segments of 64, 128, 256, ... elements that are allocated once and never move, so references
+// and pointers to elements stay valid for the lifetime of the vector. A producer claims its slot with one
+// fetch_add on the claimed size, makes sure the segment exists (racing producers agree with a compare-exchange)
+// and constructs the element in place.
+//
+// Slots are filled out of order, so there are two sizes: the claimed one, and the published one that readers see.
+// Every slot has a ready flag; after constructing its element a producer moves the published size forward over
+// every ready slot, finishing the work of slower producers if they are done in the meantime. Everything below
+// getSize() is fully constructed and may be read while other threads keep pushing.
+//
+// Not thread-safe: clear(), reserve() and destruction, they need the vector to be quiet.
+//
+
+#ifndef VECTOR_MYCONCURRENTVECTOR_H
+#define VECTOR_MYCONCURRENTVECTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "MyAllocators.h"
+#include "MyFind.h"
+
+template<typename T, typename Alloc = MyHeapAllocator<T>>
+class MyConcurrentVector {
+
+    static_assert(std::is_same<typename Alloc::value_type, T>::value, "Alloc::value_type must be T");
+
+private:
+    static constexpr size_t kFirstSegmentShift = 6; /// The first segment holds 64 elements, each next one twice more
+    static constexpr size_t kMaxSegments = sizeof(size_t) * 8 - kFirstSegmentShift;
+
+    struct Segment {
+        T *mData; /// Raw memory for the elements of this segment
+        std::unique_ptr<std::atomic<bool>[]> mReady; /// mReady[i] is set once mData[i] is constructed
+    };
+
+    std::atomic<Segment *> mSegments[kMaxSegments] = {}; /// Allocated on first use, never moved
+    std::atomic<size_t> mClaimed{0}; /// Slots handed out to producers
+    std::atomic<size_t> mPublished{0}; /// Slots below this are constructed and visible to readers
+    Alloc mAllocator;
+
+public:
+    using allocator_type = Alloc;
+
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+    MyConcurrentVector() = default;
+
+    explicit MyConcurrentVector(const Alloc &allocator) : mAllocator(allocator) {}
+
+    MyConcurrentVector(std::initializer_list<T> initializerList, const Alloc &allocator = Alloc())
+            : mAllocator(allocator) {
+        for (auto &element: initializerList)
+            pushBack(element);
+    }
+
+    // Other threads may hold references into the segments, the vector itself can't be copied or moved
+    MyConcurrentVector(const MyConcurrentVector<T, Alloc> &) = delete;
+
+    MyConcurrentVector<T, Alloc> &operator=(const MyConcurrentVector<T, Alloc> &) = delete;
+
+    ~MyConcurrentVector() {
+        clear();
+        for (size_t segment = 0; segment < kMaxSegments; segment++) {
+            if (Segment *allocated = mSegments[segment].load()) {
+                mAllocator.deallocate(allocated->mData, segmentSize(segment));
+                delete allocated;
+            }
+        }
+    }
+
+    Alloc getAllocator() const { return mAllocator; }
+
+    /* ============================================================================================================  *
+     *                                     MODIFIERS                                                                 |
+     * ============================================================================================================  */
+
+    /*
+     * A claimed slot can't be given back, readers would never get past it. So elements whose constructor may throw
+     * are built aside first and only moved into their slot, which T's move constructor must not throw for.
+     */
+
+    /**
+     * Appends a copy of element. Safe to call from any number of threads at once.
+     * @return position of the new element. It becomes visible to readers once every earlier push is done too.
+     */
+    size_t pushBack(const T &element) {
+        if constexpr (std::is_nothrow_copy_constructible<T>::value) {
+            return construct(element);
+        } else {
+            return construct(T(element));
+        }
+    }
+
+    /**
+     * Builds the element in place from args, or aside and then moved in if that may throw.
+     * Safe to call from any number of threads at once.
+     * @return the new element, its address never changes.
+     */
+    template<typename... Args>
+    T &emplaceBack(Args &&... args) {
+        size_t position;
+        if constexpr (std::is_nothrow_constructible<T, Args &&...>::value) {
+            position = construct(std::forward<Args>(args)...);
+        } else {
+            position = construct(T(std::forward<Args>(args)...));
+        }
+        return *slot(position);
+    }
+
+    /**
+     * Destroys all elements, the segments are kept for reuse. Must not run concurrently with anything else.
+     */
+    void clear() {
+        size_t claimed = mClaimed.load();
+        for (size_t position = 0; position < claimed; position++) {
+            auto [segment, offset] = locate(position);
+            Segment *allocated = mSegments[segment].load();
+            std::destroy_at(allocated->mData + offset);
+            allocated->mReady[offset].store(false, std::memory_order_relaxed);
+        }
+        mClaimed.store(0);
+        mPublished.store(0);
+    }
+
+    /* ============================================================================================================  *
+     *                                     ELEMENT ACCESS                                                            |
+     * ============================================================================================================  */
+
+    /**
+     * @param position - must be below getSize() as seen by this thread.
+     */
+    T &operator[](size_t position) {
+        auto [segment, offset] = locate(position);
+        return mSegments[segment].load(std::memory_order_acquire)->mData[offset];
+    }
+
+    const T &operator[](size_t position) const {
+        auto [segment, offset] = locate(position);
+        return mSegments[segment].load(std::memory_order_acquire)->mData[offset];
+    }
+
+    T &at(size_t position) { return (*this)[position]; }
+
+    /* ============================================================================================================  *
+     *                                     CAPACITY                                                                  |
+     * ============================================================================================================  */
+
+    /**
+     * @return number of published elements: all of them are constructed and safe to read.
+     */
+    size_t getSize() const { return mPublished.load(std::memory_order_acquire); }
+
+    /**
+     * @return elements that fit into the segments allocated so far.
+     */
+    size_t getCapacity() const {
+        size_t capacity = 0;
+        for (size_t segment = 0; segment < kMaxSegments && mSegments[segment].load() != nullptr; segment++) {
+            capacity += segmentSize(segment);
+        }
+        return capacity;
+    }
+
+    /**
+     * Allocates the segments for at least capacity elements up front, so producers never have to.
+     */
+    void reserve(size_t capacity) {
+        for (size_t segment = 0; capacity > 0 && segment < kMaxSegments; segment++) {
+            segmentAt(segment);
+            capacity = capacity > segmentSize(segment) ? capacity - segmentSize(segment) : 0;
+        }
+    }
+
+    /* ============================================================================================================  *
+     *                                     FIND                                                                      |
+     * ============================================================================================================  */
+
+    /**
+     * Searches the published elements, segment by segment with the vectorized kernels.
+     * @return position of the requested element, npos if it isn't there.
+     */
+    size_t find(const T &element) const {
+        size_t found = npos;
+        forEachSegment([&found, &element](const T *data, size_t count, size_t first) {
+            size_t position = myFind(data, count, element);
+            if (position != npos) {
+                found = first + position;
+                return false;
+            }
+            return true;
+        });
+        return found;
+    }
+
+    /**
+     * @return how many published elements are equal to the given one.
+     */
+    size_t count(const T &element) const {
+        size_t matches = 0;
+        forEachSegment([&matches, &element](const T *data, size_t count, size_t) {
+            matches += myCount(data, count, element);
+            return true;
+        });
+        return matches;
+    }
+
+    bool contains(const T &element) const { return find(element) != npos; }
+
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+
+private:
+    class MyIterator {
+        const MyConcurrentVector<T, Alloc> *mVector;
+        size_t mPosition;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        MyIterator(const MyConcurrentVector<T, Alloc> *vector, size_t position)
+                : mVector(vector), mPosition(position) {}
+
+        MyIterator &operator++() noexcept {
+            mPosition++;
+            return *this;
+        }
+
+        MyIterator operator++(int) {
+            MyIterator iterator = *this;
+            ++(*this);
+            return iterator;
+        }
+
+        const T *operator->() const { return &(*mVector)[mPosition]; }
+
+        const T &operator*() const { return (*mVector)[mPosition]; }
+
+        bool operator==(const MyIterator &iteratorToCompareWith) const {
+            return mPosition == iteratorToCompareWith.mPosition;
+        }
+
+        bool operator!=(const MyIterator &iteratorToCompareWith) const {
+            return mPosition != iteratorToCompareWith.mPosition;
+        }
+    };
+
+public:
+    /*
+     * end() is taken once: iterating while producers push walks the elements published by then, the ones
+     * pushed later are simply not seen.
+     */
+
+    MyIterator begin() const { return MyIterator(this, 0); }
+
+    MyIterator end() const { return MyIterator(this, getSize()); }
+
+    /* ============================================================================================================  *
+     *                                     UTIL                                                                      |
+     * ============================================================================================================  */
+
+private:
+    static size_t segmentSize(size_t segment) { return size_t(1) << (segment + kFirstSegmentShift); }
+
+    /**
+     * Segment k starts at position 64 * (2^k - 1), so position + 64 has its highest bit at k + 6.
+     * @return segment and offset inside it of the given position.
+     */
+    static std::pair<size_t, size_t> locate(size_t position) {
+        size_t biased = position + (size_t(1) << kFirstSegmentShift);
+        size_t highestBit = sizeof(size_t) * 8 - 1 - static_cast<size_t>(__builtin_clzll(biased));
+        return {highestBit - kFirstSegmentShift, biased - (size_t(1) << highestBit)};
+    }
+
+    /**
+     * @return the given segment, allocating it if nobody has yet. Racing threads all allocate, one wins the
+     * compare-exchange and the others give their memory back.
+     */
+    Segment *segmentAt(size_t segment) {
+        Segment *existing = mSegments[segment].load(std::memory_order_acquire);
+        if (existing != nullptr) {
+            return existing;
+        }
+        size_t size = segmentSize(segment);
+        auto created = new Segment{mAllocator.allocate(size), std::unique_ptr<std::atomic<bool>[]>(
+                new std::atomic<bool>[size]())};
+        if (mSegments[segment].compare_exchange_strong(existing, created, std::memory_order_acq_rel)) {
+            return created;
+        }
+        mAllocator.deallocate(created->mData, size);
+        delete created;
+        return existing;
+    }
+
+    T *slot(size_t position) {
+        auto [segment, offset] = locate(position);
+        return segmentAt(segment)->mData + offset;
+    }
+
+    /**
+     * Claims the next slot, builds the element in it and publishes it.
+     */
+    template<typename... Args>
+    size_t construct(Args &&... args) {
+        static_assert(std::is_nothrow_constructible<T, Args &&...>::value,
+                      "MyConcurrentVector needs elements that can be moved without throwing");
+        size_t position = mClaimed.fetch_add(1);
+        new(slot(position)) T(std::forward<Args>(args)...);
+        publish(position);
+        return position;
+    }
+
+    /**
+     * Marks position as constructed and moves the published size over every ready slot, including those of
+     * other producers that finished while their predecessors were still busy.
+     */
+    void publish(size_t position) {
+        auto [segment, offset] = locate(position);
+        mSegments[segment].load(std::memory_order_acquire)->mReady[offset].store(true);
+
+        size_t published = mPublished.load();
+        while (published < mClaimed.load()) {
+            auto [publishedSegment, publishedOffset] = locate(published);
+            Segment *allocated = mSegments[publishedSegment].load();
+            if (allocated == nullptr || !allocated->mReady[publishedOffset].load()) {
+                return; // Its producer isn't done yet, it will carry on from there itself
+            }
+            // On failure published is reloaded, somebody else moved it forward
+            if (mPublished.compare_exchange_weak(published, published + 1)) {
+                published++;
+            }
+        }
+    }
+
+    /**
+     * Calls visit(const T *data, size_t count, size_t firstPosition) for the published part of every segment,
+     * until visit returns false.
+     */
+    template<typename Visit>
+    void forEachSegment(Visit visit) const {
+        size_t size = getSize();
+        size_t first = 0;
+        for (size_t segment = 0; first < size; segment++) {
+            size_t count = size - first < segmentSize(segment) ? size - first : segmentSize(segment);
+            if (!visit(mSegments[segment].load(std::memory_order_acquire)->mData, count, first)) {
+                return;
+            }
+            first += count;
+        }
+    }
+
+public:
+
+    void print() const {
+        size_t size = getSize();
+        for (size_t i = 0; i < size; i++) {
+            std::cout << (*this)[i] << "; ";
+        }
+        std::cout << std::endl;
+    }
+};
+
+#endif //VECTOR_MYCONCURRENTVECTOR_H
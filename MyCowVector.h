@@ -0,0 +1,272 @@
+//
+// Copy-on-write MyVector: copies share one buffer until somebody writes.
+//
+// Copying or snapshot() only bumps a reference count, O(1) whatever the size. Reads go straight to the shared
+// MyVector. The first mutating call on a copy that is still shared (pushBack, non-const operator[], sort, ...)
+// detaches it: it makes its own deep copy and every other holder keeps the old elements. A vector nobody else
+// shares is written in place, exactly like a plain MyVector.
+//
+// Non-const operator[], at(), emplaceBack() and write() hand out references into the buffer, which the holder may
+// keep writing through. From then on the buffer is ours alone: copies taken later get their own deep copy instead
+// of sharing it, until clear() or release() drops it.
+//
+//      MyCowVector<std::string> config = loadConfig();
+//      MyCowVector<std::string> mine = config.snapshot();   // no copy
+//      mine.pushBack("override");                           // copies once, config is untouched
+//
+// Different MyCowVector objects may be used from different threads even while they share a buffer, the same
+// object may not be written by one thread while others use it.
+//
+
+#ifndef VECTOR_MYCOWVECTOR_H
+#define VECTOR_MYCOWVECTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include "MyVector.h"
+
+template<typename T, typename Alloc = MyHeapAllocator<T>, typename Growth = MyDoublingGrowth>
+class MyCowVector {
+
+public:
+    using Vector = MyVector<T, Alloc, Growth>;
+
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+private:
+    std::shared_ptr<Vector> mShared; /// Elements shared by every snapshot, nullptr while empty
+    bool mLeaked = false; /// A mutable reference into mShared was handed out, copies can't share it any more
+
+public:
+    MyCowVector() = default;
+
+    /**
+     * Shares the elements of anotherVector, O(1), unless it has handed out mutable references into them.
+     */
+    MyCowVector(const MyCowVector<T, Alloc, Growth> &anotherVector) : mShared(anotherVector.shareable()) {}
+
+    MyCowVector(MyCowVector<T, Alloc, Growth> &&anotherVector) noexcept
+            : mShared(std::move(anotherVector.mShared)), mLeaked(anotherVector.mLeaked) {
+        anotherVector.mLeaked = false;
+    }
+
+    MyCowVector<T, Alloc, Growth> &operator=(const MyCowVector<T, Alloc, Growth> &anotherVector) {
+        if (this != &anotherVector) {
+            mShared = anotherVector.shareable();
+            mLeaked = false;
+        }
+        return *this;
+    }
+
+    MyCowVector<T, Alloc, Growth> &operator=(MyCowVector<T, Alloc, Growth> &&anotherVector) noexcept {
+        if (this != &anotherVector) {
+            mShared = std::move(anotherVector.mShared);
+            mLeaked = anotherVector.mLeaked;
+            anotherVector.mLeaked = false;
+        }
+        return *this;
+    }
+
+    /**
+     * Takes over the buffer of vector, no element is copied.
+     */
+    explicit MyCowVector(Vector &&vector) : mShared(std::make_shared<Vector>(std::move(vector))) {}
+
+    MyCowVector(std::initializer_list<T> initializerList) : mShared(std::make_shared<Vector>(initializerList)) {}
+
+    /**
+     * @return a copy sharing our elements, O(1). Same as the copy constructor, only more explicit at call sites.
+     * After a mutable reference was handed out the copy is a deep one, see above.
+     */
+    MyCowVector<T, Alloc, Growth> snapshot() const { return *this; }
+
+    /**
+     * @return true if another copy still uses the same elements, i.e. the next write will copy them.
+     */
+    bool isShared() const { return mShared != nullptr && mShared.use_count() > 1; }
+
+    /**
+     * @return the elements as a plain MyVector: moved out if nobody else shares them, copied otherwise.
+     * This vector is left empty.
+     */
+    Vector release() {
+        mLeaked = false;
+        if (mShared == nullptr) {
+            return Vector();
+        }
+        std::shared_ptr<Vector> shared = std::move(mShared);
+        if (shared.use_count() > 1) {
+            return Vector(*shared);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return Vector(std::move(*shared));
+    }
+
+    /* ============================================================================================================  *
+     *                                     READ                                                                      |
+     * ============================================================================================================  */
+
+    /**
+     * Read access to the shared MyVector, never copies. Don't hold on to it across a write.
+     */
+    const Vector &read() const { return mShared != nullptr ? *mShared : empty(); }
+
+    const T &operator[](size_t position) const { return read()[position]; }
+
+    size_t getSize() const { return read().getSize(); }
+
+    size_t find(const T &element) const { return read().find(element); }
+
+    size_t count(const T &element) const { return read().count(element); }
+
+    bool contains(const T &element) const { return read().contains(element); }
+
+    /* ============================================================================================================  *
+     *                                     WRITE                                                                     |
+     * ============================================================================================================  */
+
+    /*
+     * Everything below detaches first, see detach().
+     */
+
+    /**
+     * Write access: makes our own copy of the elements first if anybody else shares them. The elements stay ours
+     * alone afterwards, later copies won't share them, so writes through the result never reach a snapshot.
+     */
+    Vector &write() {
+        mLeaked = true;
+        return detach();
+    }
+
+    /**
+     * Mutable references keep the buffer unshared like write(), later snapshots copy it.
+     */
+    T &operator[](size_t position) { return write()[position]; }
+
+    T &at(size_t position) { return write()[position]; }
+
+    void pushBack(const T &element) { detach().pushBack(element); }
+
+    template<typename... Args>
+    T &emplaceBack(Args &&... args) { return write().emplaceBack(std::forward<Args>(args)...); }
+
+    void popBack() { detach().popBack(); }
+
+    /**
+     * Drops our reference instead of destroying elements other snapshots may still use.
+     */
+    void clear() {
+        mShared.reset();
+        mLeaked = false;
+    }
+
+    void resize(size_t newSize) { detach().resize(newSize); }
+
+    void reserve(size_t capacity) { detach().reserve(capacity); }
+
+    size_t erase(size_t begin, size_t end) { return detach().erase(begin, end); }
+
+    template<typename Compare>
+    void sort(Compare compare) { detach().sort(compare); }
+
+    void sort() { detach().sort(); }
+
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+
+private:
+    class MyIterator {
+        const Vector *mVector;
+        size_t mPosition;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        MyIterator(const Vector *vector, size_t position) : mVector(vector), mPosition(position) {}
+
+        MyIterator &operator++() noexcept {
+            mPosition++;
+            return *this;
+        }
+
+        MyIterator operator++(int) {
+            MyIterator iterator = *this;
+            ++(*this);
+            return iterator;
+        }
+
+        MyIterator &operator--() {
+            mPosition--;
+            return *this;
+        }
+
+        MyIterator operator--(int) {
+            MyIterator iterator = *this;
+            --(*this);
+            return iterator;
+        }
+
+        const T *operator->() const { return &(*mVector)[mPosition]; }
+
+        const T &operator*() const { return (*mVector)[mPosition]; }
+
+        bool operator==(const MyIterator &iteratorToCompareWith) const {
+            return mPosition == iteratorToCompareWith.mPosition;
+        }
+
+        bool operator!=(const MyIterator &iteratorToCompareWith) const {
+            return mPosition != iteratorToCompareWith.mPosition;
+        }
+    };
+
+public:
+    /*
+     * Iteration only reads, so it never detaches. Use write() to modify elements while walking them.
+     */
+
+    MyIterator begin() const { return MyIterator(&read(), 0); }
+
+    MyIterator end() const { return MyIterator(&read(), getSize()); }
+
+    /* ============================================================================================================  *
+     *                                     UTIL                                                                      |
+     * ============================================================================================================  */
+
+private:
+    /**
+     * Makes our own copy of the elements first if anybody else shares them.
+     */
+    Vector &detach() {
+        if (mShared == nullptr) {
+            mShared = std::make_shared<Vector>();
+        } else if (mShared.use_count() > 1) {
+            mShared = std::make_shared<Vector>(*mShared);
+        } else {
+            // The last other holder may have just let go, its reads must be done before we write
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *mShared;
+    }
+
+    /**
+     * What a copy of us gets: our elements, or a deep copy of them once references into them are out.
+     */
+    std::shared_ptr<Vector> shareable() const {
+        return mLeaked && mShared != nullptr ? std::make_shared<Vector>(*mShared) : mShared;
+    }
+
+    static const Vector &empty() {
+        static const Vector emptyVector;
+        return emptyVector;
+    }
+};
+
+#endif //VECTOR_MYCOWVECTOR_H
@@ -0,0 +1,296 @@
+//
+// Search kernels used by MyVector, MySmallVector and MyVectorView: find, count and contains over a plain array,
+// plus the popcount behind MyVector<bool>::count().
+//
+// Arithmetic element types are compared 16 (SSE2) or 32 (AVX2) bytes at a time. The instruction set is picked at
+// runtime from what the CPU supports, so one binary runs everywhere; on other architectures, other compilers or
+// for any other element type a scalar loop is used. All results are size_t positions.
+//
+
+#ifndef VECTOR_MYFIND_H
+#define VECTOR_MYFIND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MY_FIND_X86 1
+#include <immintrin.h>
+#else
+#define MY_FIND_X86 0
+#endif
+
+/// Returned by find functions when nothing was found
+static constexpr size_t kMyNotFound = static_cast<size_t>(-1);
+
+/**
+ * Instruction sets the kernels can use, the best one available is detected once.
+ */
+enum class MySimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+inline MySimdLevel mySimdLevel() {
+#if MY_FIND_X86
+    static const MySimdLevel level = __builtin_cpu_supports("avx2") ? MySimdLevel::Avx2
+                                     : __builtin_cpu_supports("sse2") ? MySimdLevel::Sse2 : MySimdLevel::Scalar;
+    return level;
+#else
+    return MySimdLevel::Scalar;
+#endif
+}
+
+/* ============================================================================================================  *
+ *                                     SCALAR                                                                    |
+ * ============================================================================================================  */
+
+template<typename T>
+size_t myFindScalar(const T *data, size_t count, const T &value) {
+    for (size_t i = 0; i < count; i++) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return kMyNotFound;
+}
+
+template<typename T>
+size_t myCountScalar(const T *data, size_t count, const T &value) {
+    size_t matches = 0;
+    for (size_t i = 0; i < count; i++) {
+        matches += data[i] == value ? 1 : 0;
+    }
+    return matches;
+}
+
+/* ============================================================================================================  *
+ *                                     SSE2 / AVX2                                                               |
+ * ============================================================================================================  */
+
+#if MY_FIND_X86
+
+/**
+ * Integers are equal exactly when their bits are, so they are searched as unsigned lanes of the same width.
+ * Floating point keeps its own lanes: -0.0 == 0.0 and NaN != NaN must hold like with operator==.
+ */
+template<typename T>
+using MySimdLane = std::conditional_t<std::is_floating_point<T>::value, T,
+        std::conditional_t<sizeof(T) == 1, uint8_t,
+                std::conditional_t<sizeof(T) == 2, uint16_t,
+                        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>>;
+
+template<typename Lane>
+__attribute__((target("sse2"))) inline __m128i myCompareEqual128(__m128i block, Lane value) {
+    if constexpr (std::is_same<Lane, float>::value) {
+        return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(block), _mm_set1_ps(value)));
+    } else if constexpr (std::is_same<Lane, double>::value) {
+        return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(block), _mm_set1_pd(value)));
+    } else if constexpr (sizeof(Lane) == 1) {
+        return _mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast<char>(value)));
+    } else if constexpr (sizeof(Lane) == 2) {
+        return _mm_cmpeq_epi16(block, _mm_set1_epi16(static_cast<short>(value)));
+    } else if constexpr (sizeof(Lane) == 4) {
+        return _mm_cmpeq_epi32(block, _mm_set1_epi32(static_cast<int>(value)));
+    } else {
+        // SSE2 has no 64-bit compare: both 32-bit halves have to match
+        __m128i halves = _mm_cmpeq_epi32(block, _mm_set1_epi64x(static_cast<long long>(value)));
+        return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+}
+
+template<typename Lane>
+__attribute__((target("avx2"))) inline __m256i myCompareEqual256(__m256i block, Lane value) {
+    if constexpr (std::is_same<Lane, float>::value) {
+        return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(block), _mm256_set1_ps(value), _CMP_EQ_OQ));
+    } else if constexpr (std::is_same<Lane, double>::value) {
+        return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(block), _mm256_set1_pd(value), _CMP_EQ_OQ));
+    } else if constexpr (sizeof(Lane) == 1) {
+        return _mm256_cmpeq_epi8(block, _mm256_set1_epi8(static_cast<char>(value)));
+    } else if constexpr (sizeof(Lane) == 2) {
+        return _mm256_cmpeq_epi16(block, _mm256_set1_epi16(static_cast<short>(value)));
+    } else if constexpr (sizeof(Lane) == 4) {
+        return _mm256_cmpeq_epi32(block, _mm256_set1_epi32(static_cast<int>(value)));
+    } else {
+        return _mm256_cmpeq_epi64(block, _mm256_set1_epi64x(static_cast<long long>(value)));
+    }
+}
+
+/*
+ * Each kernel turns a compare result into a byte mask (movemask_epi8): every matching lane sets sizeof(Lane) bits,
+ * so the first match is at ctz(mask) / sizeof(Lane) and the number of matches is popcount(mask) / sizeof(Lane).
+ */
+
+template<typename Lane>
+__attribute__((target("sse2"))) size_t myFindSse2(const Lane *data, size_t count, Lane value) {
+    constexpr size_t kLanes = 16 / sizeof(Lane);
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(myCompareEqual128(block, value)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask)) / sizeof(Lane);
+        }
+    }
+    size_t tail = myFindScalar(data + i, count - i, value);
+    return tail == kMyNotFound ? kMyNotFound : i + tail;
+}
+
+template<typename Lane>
+__attribute__((target("sse2"))) size_t myCountSse2(const Lane *data, size_t count, Lane value) {
+    constexpr size_t kLanes = 16 / sizeof(Lane);
+    size_t matchingBits = 0;
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        matchingBits += static_cast<size_t>(__builtin_popcount(
+                static_cast<unsigned>(_mm_movemask_epi8(myCompareEqual128(block, value)))));
+    }
+    return matchingBits / sizeof(Lane) + myCountScalar(data + i, count - i, value);
+}
+
+template<typename Lane>
+__attribute__((target("avx2"))) size_t myFindAvx2(const Lane *data, size_t count, Lane value) {
+    constexpr size_t kLanes = 32 / sizeof(Lane);
+    size_t i = 0;
+    // Two vectors per iteration, their masks are only looked at separately once something matched
+    for (; i + 2 * kLanes <= count; i += 2 * kLanes) {
+        __m256i first = myCompareEqual256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), value);
+        __m256i second = myCompareEqual256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + kLanes)), value);
+        if (!_mm256_testz_si256(_mm256_or_si256(first, second), _mm256_or_si256(first, second))) {
+            auto mask = static_cast<unsigned>(_mm256_movemask_epi8(first));
+            if (mask != 0) {
+                return i + static_cast<size_t>(__builtin_ctz(mask)) / sizeof(Lane);
+            }
+            mask = static_cast<unsigned>(_mm256_movemask_epi8(second));
+            return i + kLanes + static_cast<size_t>(__builtin_ctz(mask)) / sizeof(Lane);
+        }
+    }
+    for (; i + kLanes <= count; i += kLanes) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(myCompareEqual256(block, value)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask)) / sizeof(Lane);
+        }
+    }
+    size_t tail = myFindScalar(data + i, count - i, value);
+    return tail == kMyNotFound ? kMyNotFound : i + tail;
+}
+
+template<typename Lane>
+__attribute__((target("avx2,popcnt"))) size_t myCountAvx2(const Lane *data, size_t count, Lane value) {
+    constexpr size_t kLanes = 32 / sizeof(Lane);
+    size_t matchingBits = 0;
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        matchingBits += static_cast<size_t>(__builtin_popcount(
+                static_cast<unsigned>(_mm256_movemask_epi8(myCompareEqual256(block, value)))));
+    }
+    return matchingBits / sizeof(Lane) + myCountScalar(data + i, count - i, value);
+}
+
+#endif
+
+/* ============================================================================================================  *
+ *                                     DISPATCH                                                                  |
+ * ============================================================================================================  */
+
+/// Element types the vector kernels can handle, everything else uses the scalar loop
+template<typename T>
+struct MyHasSimdFind : std::integral_constant<bool, MY_FIND_X86 && std::is_arithmetic<T>::value
+                                                   && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4
+                                                       || sizeof(T) == 8)
+                                                   && (!std::is_floating_point<T>::value
+                                                       || std::is_same<T, float>::value
+                                                       || std::is_same<T, double>::value)> {};
+
+/**
+ * @return position of the first element equal to value, or kMyNotFound.
+ */
+template<typename T>
+size_t myFind(const T *data, size_t count, const T &value) {
+#if MY_FIND_X86
+    if constexpr (MyHasSimdFind<T>::value) {
+        using Lane = MySimdLane<T>;
+        Lane lane;
+        std::memcpy(&lane, &value, sizeof(lane));
+        auto lanes = reinterpret_cast<const Lane *>(data);
+        switch (mySimdLevel()) {
+            case MySimdLevel::Avx2:
+                return myFindAvx2(lanes, count, lane);
+            case MySimdLevel::Sse2:
+                return myFindSse2(lanes, count, lane);
+            default:
+                break;
+        }
+    }
+#endif
+    return myFindScalar(data, count, value);
+}
+
+/**
+ * @return number of elements equal to value.
+ */
+template<typename T>
+size_t myCount(const T *data, size_t count, const T &value) {
+#if MY_FIND_X86
+    if constexpr (MyHasSimdFind<T>::value) {
+        using Lane = MySimdLane<T>;
+        Lane lane;
+        std::memcpy(&lane, &value, sizeof(lane));
+        auto lanes = reinterpret_cast<const Lane *>(data);
+        switch (mySimdLevel()) {
+            case MySimdLevel::Avx2:
+                return myCountAvx2(lanes, count, lane);
+            case MySimdLevel::Sse2:
+                return myCountSse2(lanes, count, lane);
+            default:
+                break;
+        }
+    }
+#endif
+    return myCountScalar(data, count, value);
+}
+
+/* ============================================================================================================  *
+ *                                     POPCOUNT                                                                  |
+ * ============================================================================================================  */
+
+inline size_t myPopCountScalar(const uint64_t *words, size_t count) {
+    size_t ones = 0;
+    for (size_t i = 0; i < count; i++) {
+        ones += static_cast<size_t>(__builtin_popcountll(words[i]));
+    }
+    return ones;
+}
+
+#if MY_FIND_X86
+/// Same loop, but one popcnt instruction per word instead of the bit-twiddling fallback
+__attribute__((target("popcnt"))) inline size_t myPopCountHardware(const uint64_t *words, size_t count) {
+    size_t ones = 0;
+    for (size_t i = 0; i < count; i++) {
+        ones += static_cast<size_t>(__builtin_popcountll(words[i]));
+    }
+    return ones;
+}
+#endif
+
+/**
+ * @return number of set bits in count words, used by the packed MyVector<bool>.
+ */
+inline size_t myPopCount(const uint64_t *words, size_t count) {
+#if MY_FIND_X86
+    static const bool hasPopCount = __builtin_cpu_supports("popcnt");
+    if (hasPopCount) {
+        return myPopCountHardware(words, count);
+    }
+#endif
+    return myPopCountScalar(words, count);
+}
+
+#endif //VECTOR_MYFIND_H
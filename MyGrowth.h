@@ -0,0 +1,57 @@
+//
+// Growth policies for MyVector<T, Alloc, Growth>: how much capacity to ask for once the current block is full.
+//
+// A policy is a type with one static function
+//
+//      size_t nextCapacity(size_t capacity, size_t required, size_t elementSize)
+//
+// that returns the new capacity (at least required) for a vector of the given capacity. Amortized O(1) pushBack
+// needs geometric growth, the factor trades wasted memory for the number of reallocations.
+//
+
+#ifndef VECTOR_MYGROWTH_H
+#define VECTOR_MYGROWTH_H
+
+#include <cstddef>
+
+/// Pages MyPageRoundedGrowth rounds to, the common size of a small page
+static constexpr size_t kMyPageSize = 4096;
+
+/**
+ * 2x: fewest reallocations, up to half of the block may be unused. The default.
+ */
+struct MyDoublingGrowth {
+    static size_t nextCapacity(size_t capacity, size_t required, size_t) {
+        return capacity * 2 > required ? capacity * 2 : required;
+    }
+};
+
+/**
+ * 1.5x: at most a third of the block is unused, and after a few steps the freed blocks add up to enough room for
+ * the next one, so a heap allocator can reuse them.
+ */
+struct MyOneAndHalfGrowth {
+    static size_t nextCapacity(size_t capacity, size_t required, size_t) {
+        size_t grown = capacity + capacity / 2;
+        return grown > required ? grown : required;
+    }
+};
+
+/**
+ * Grows like Base, then rounds the block up to whole pages so that no page is ever shared with another block and
+ * the slack at the end of the last page is used instead of wasted. Meant for large vectors, small ones stay as
+ * Base makes them until they cross one page.
+ */
+template<typename Base = MyDoublingGrowth>
+struct MyPageRoundedGrowth {
+    static size_t nextCapacity(size_t capacity, size_t required, size_t elementSize) {
+        size_t grown = Base::nextCapacity(capacity, required, elementSize);
+        if (elementSize == 0 || grown * elementSize < kMyPageSize) {
+            return grown;
+        }
+        size_t bytes = (grown * elementSize + kMyPageSize - 1) / kMyPageSize * kMyPageSize;
+        return bytes / elementSize;
+    }
+};
+
+#endif //VECTOR_MYGROWTH_H
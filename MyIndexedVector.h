@@ -0,0 +1,437 @@
+//
+// MyVector with a hash index over its elements: find, contains and count in O(1) instead of a linear scan.
+//
+// The index is an open-addressing table with linear probing, one 16-byte slot per distinct key: the position of
+// the first element with that key, how many elements share it, and 32 bits of its hash so most mismatches are
+// rejected without touching the element. The tag also tells where the slot belongs, so growing the table never
+// reads the elements. The keys themselves are not copied, they are read from the vector.
+//
+// Appending and removing the last element update the index in O(1). Operations that move elements around (sort,
+// erase, removeIf, deserialize) rebuild it in one pass. Elements are only handed out as const, writing one
+// through a reference would leave the index stale.
+//
+//      MyIndexedVector<int> ids;                                   // indexed by the element itself
+//      MyIndexedVector<Person, MyPersonName> people;               // MyPersonNameIndex, indexed by name
+//      people.pushBack(Person("Andriy", 19));
+//      people.find("Andriy");                                      // 0
+//
+
+#ifndef VECTOR_MYINDEXEDVECTOR_H
+#define VECTOR_MYINDEXEDVECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "MyVector.h"
+
+/**
+ * Default key of MyIndexedVector: the element itself.
+ */
+struct MyIdentityKey {
+    template<typename T>
+    const T &operator()(const T &element) const { return element; }
+};
+
+/**
+ * Key projection indexing people by name.
+ */
+struct MyPersonName {
+    std::string operator()(const Person &person) const { return person.getName(); }
+};
+
+template<typename T, typename KeyOf = MyIdentityKey,
+        typename Hash = std::hash<std::decay_t<std::invoke_result_t<KeyOf, const T &>>>,
+        typename KeyEqual = std::equal_to<std::decay_t<std::invoke_result_t<KeyOf, const T &>>>,
+        typename Alloc = MyHeapAllocator<T>, typename Growth = MyDoublingGrowth>
+class MyIndexedVector {
+
+public:
+    using Vector = MyVector<T, Alloc, Growth>;
+    using Key = std::decay_t<std::invoke_result_t<KeyOf, const T &>>;
+
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+private:
+    struct Slot {
+        size_t mPosition; /// First element with this key, kEmpty for a free slot
+        uint32_t mCount; /// Elements with this key
+        uint32_t mTag; /// Top 32 bits of the mixed hash, its own top bits give the home slot
+    };
+
+    static constexpr size_t kEmpty = ~size_t(0);
+    static constexpr size_t kMinSlots = 16;
+
+    Vector mVector;
+    std::unique_ptr<Slot[]> mSlots;
+    size_t mSlotCount = 0; /// Power of two, or 0 before the first element
+    size_t mShift = 32; /// 32 - log2(mSlotCount): the home slot of a tag is its top bits
+    size_t mUsed = 0; /// Slots holding a key, i.e. distinct keys
+    KeyOf mKeyOf;
+    Hash mHash;
+    KeyEqual mKeyEqual;
+
+public:
+    MyIndexedVector() = default;
+
+    /**
+     * Takes over the elements of vector and indexes them.
+     */
+    explicit MyIndexedVector(Vector &&vector) : mVector(std::move(vector)) { rebuild(); }
+
+    MyIndexedVector(std::initializer_list<T> initializerList) : mVector(initializerList) { rebuild(); }
+
+    MyIndexedVector(const MyIndexedVector &other) : mVector(other.mVector), mKeyOf(other.mKeyOf),
+                                                    mHash(other.mHash), mKeyEqual(other.mKeyEqual) {
+        rebuild();
+    }
+
+    MyIndexedVector(MyIndexedVector &&other) noexcept { swap(other); }
+
+    MyIndexedVector &operator=(MyIndexedVector other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(MyIndexedVector &other) noexcept {
+        std::swap(mVector, other.mVector);
+        std::swap(mSlots, other.mSlots);
+        std::swap(mSlotCount, other.mSlotCount);
+        std::swap(mShift, other.mShift);
+        std::swap(mUsed, other.mUsed);
+        std::swap(mKeyOf, other.mKeyOf);
+        std::swap(mHash, other.mHash);
+        std::swap(mKeyEqual, other.mKeyEqual);
+    }
+
+    /**
+     * @return the elements as a plain MyVector, this vector is left empty.
+     */
+    Vector release() {
+        Vector vector = std::move(mVector);
+        clear();
+        return vector;
+    }
+
+    /* ============================================================================================================  *
+     *                                     LOOKUP                                                                    |
+     * ============================================================================================================  */
+
+    /**
+     * @return position of the first element with this key, or npos. O(1) on average.
+     */
+    size_t find(const Key &key) const {
+        size_t slot = lookup(key);
+        return slot != kEmpty ? mSlots[slot].mPosition : npos;
+    }
+
+    /**
+     * @return number of elements with this key.
+     */
+    size_t count(const Key &key) const {
+        size_t slot = lookup(key);
+        return slot != kEmpty ? mSlots[slot].mCount : 0;
+    }
+
+    bool contains(const Key &key) const { return lookup(key) != kEmpty; }
+
+    /**
+     * @return number of distinct keys.
+     */
+    size_t getKeyCount() const { return mUsed; }
+
+    /* ============================================================================================================  *
+     *                                     READ                                                                      |
+     * ============================================================================================================  */
+
+    /**
+     * Read access to the underlying MyVector.
+     */
+    const Vector &read() const { return mVector; }
+
+    const T &operator[](size_t position) const { return mVector[position]; }
+
+    const T &at(size_t position) const { return mVector.at(position); }
+
+    size_t getSize() const { return mVector.getSize(); }
+
+    size_t getCapacity() const { return mVector.getCapacity(); }
+
+    typename Vector::const_iterator begin() const { return mVector.begin(); }
+
+    typename Vector::const_iterator end() const { return mVector.end(); }
+
+    /* ============================================================================================================  *
+     *                                     MODIFIERS                                                                 |
+     * ============================================================================================================  */
+
+    void pushBack(const T &element) {
+        mVector.pushBack(element);
+        indexLast();
+    }
+
+    template<typename... Args>
+    const T &emplaceBack(Args &&... args) {
+        const T &element = mVector.emplaceBack(std::forward<Args>(args)...);
+        indexLast();
+        return element;
+    }
+
+    /**
+     * Appends [first, last) to the vector, then indexes the new elements in one batch, which is quicker than
+     * pushBack per element once the index outgrows the cache.
+     */
+    template<typename Iterator>
+    void appendRange(Iterator first, Iterator last) {
+        size_t oldSize = mVector.getSize();
+        mVector.appendRange(first, last);
+        indexRange(oldSize, mVector.getSize());
+    }
+
+    void popBack() {
+        if (mVector.getSize() > 0) {
+            unindexLast();
+            mVector.popBack();
+        }
+    }
+
+    /**
+     * Removes all elements and keys. The capacity of the vector and the index stays the same.
+     */
+    void clear() {
+        mVector.clear();
+        for (size_t i = 0; i < mSlotCount; i++) {
+            mSlots[i].mPosition = kEmpty;
+        }
+        mUsed = 0;
+    }
+
+    /**
+     * Makes room for capacity elements, and for as many distinct keys.
+     */
+    void reserve(size_t capacity) {
+        mVector.reserve(capacity);
+        if (slotsFor(capacity) > mSlotCount) {
+            resizeIndex(slotsFor(capacity));
+        }
+    }
+
+    /*
+     * Everything below moves elements around and rebuilds the index in O(n).
+     */
+
+    size_t erase(size_t begin, size_t end) {
+        size_t position = mVector.erase(begin, end);
+        rebuild();
+        return position;
+    }
+
+    template<typename Predicate>
+    size_t removeIf(Predicate remove) {
+        size_t removed = mVector.removeIf(remove);
+        if (removed > 0) {
+            rebuild();
+        }
+        return removed;
+    }
+
+    template<typename Compare>
+    void sort(Compare compare) {
+        mVector.sort(compare);
+        rebuild();
+    }
+
+    void sort() {
+        mVector.sort();
+        rebuild();
+    }
+
+    bool serialize(const std::string &fileName, MyFileFormat format = MyFileFormat::Binary) {
+        return mVector.serialize(fileName, format);
+    }
+
+    /**
+     * Appends the elements of a file written by MyVector::serialize, see there. A file that turns out corrupted
+     * halfway may have appended some elements already; they are indexed like the rest.
+     */
+    bool deserialize(const std::string &fileName) {
+        size_t oldSize = mVector.getSize();
+        bool read = mVector.deserialize(fileName);
+        indexRange(oldSize, mVector.getSize());
+        return read;
+    }
+
+    /* ============================================================================================================  *
+     *                                     UTIL                                                                      |
+     * ============================================================================================================  */
+
+private:
+    /**
+     * Fibonacci hashing spreads the bits of the user hash: std::hash of an integer is the integer itself, which
+     * would put runs of round numbers into the same slots.
+     */
+    uint32_t tagOf(const Key &key) const {
+        return static_cast<uint32_t>((static_cast<uint64_t>(mHash(key)) * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    /**
+     * Where the probe for a tag starts. Computed from the tag alone, so moving slots around never reads elements.
+     */
+    size_t home(uint32_t tag) const { return static_cast<size_t>(tag >> mShift); }
+
+    /**
+     * Slots needed for keyCount keys at a load factor of at most 3/4.
+     */
+    static size_t slotsFor(size_t keyCount) {
+        size_t slots = kMinSlots;
+        while (slots / 4 * 3 < keyCount) {
+            slots *= 2;
+        }
+        return slots;
+    }
+
+    /**
+     * @return the slot holding key, or kEmpty.
+     */
+    size_t lookup(const Key &key) const {
+        if (mUsed == 0) {
+            return kEmpty;
+        }
+        uint32_t tag = tagOf(key);
+        for (size_t i = home(tag);; i = (i + 1) & (mSlotCount - 1)) {
+            const Slot &slot = mSlots[i];
+            if (slot.mPosition == kEmpty) {
+                return kEmpty;
+            }
+            if (slot.mTag == tag && mKeyEqual(mKeyOf(mVector[slot.mPosition]), key)) {
+                return i;
+            }
+        }
+    }
+
+    /**
+     * Adds the last element: one more of its key, or a new key starting at its position.
+     */
+    void indexLast() {
+        if ((mUsed + 1) > mSlotCount / 4 * 3) {
+            resizeIndex(mSlotCount == 0 ? kMinSlots : mSlotCount * 2);
+        }
+        size_t position = mVector.getSize() - 1;
+        insert(position, tagOf(mKeyOf(mVector[position])));
+    }
+
+    /**
+     * Indexes the elements in [first, last), which must follow the ones already indexed. The slot of each
+     * element is prefetched a few elements ahead, so the cache misses of a large table overlap.
+     */
+    void indexRange(size_t first, size_t last) {
+        constexpr size_t kAhead = 8;
+        if (slotsFor(mUsed + (last - first)) > mSlotCount) {
+            resizeIndex(slotsFor(mUsed + (last - first)));
+        }
+        uint32_t tags[kAhead];
+        for (size_t position = first; position < last && position < first + kAhead; position++) {
+            tags[position % kAhead] = tagOf(mKeyOf(mVector[position]));
+            __builtin_prefetch(&mSlots[home(tags[position % kAhead])], 1);
+        }
+        for (size_t position = first; position < last; position++) {
+            uint32_t tag = tags[position % kAhead];
+            if (position + kAhead < last) {
+                tags[position % kAhead] = tagOf(mKeyOf(mVector[position + kAhead]));
+                __builtin_prefetch(&mSlots[home(tags[position % kAhead])], 1);
+            }
+            insert(position, tag);
+        }
+    }
+
+    /**
+     * Adds the element at position under its tag. The key is only computed if another key has the same tag.
+     */
+    void insert(size_t position, uint32_t tag) {
+        for (size_t i = home(tag);; i = (i + 1) & (mSlotCount - 1)) {
+            Slot &slot = mSlots[i];
+            if (slot.mPosition == kEmpty) {
+                slot = Slot{position, 1, tag};
+                mUsed++;
+                return;
+            }
+            if (slot.mTag == tag && mKeyEqual(mKeyOf(mVector[slot.mPosition]), mKeyOf(mVector[position]))) {
+                slot.mCount++;
+                return;
+            }
+        }
+    }
+
+    /**
+     * Forgets the last element before it is popped. If it was the only one with its key the slot is freed, and
+     * the slots probing past it shift back so no lookup stops early (no tombstones).
+     */
+    void unindexLast() {
+        size_t i = lookup(mKeyOf(mVector[mVector.getSize() - 1]));
+        if (--mSlots[i].mCount > 0) {
+            return; // The first element with the key comes earlier and stays
+        }
+        mSlots[i].mPosition = kEmpty;
+        mUsed--;
+        size_t mask = mSlotCount - 1;
+        for (size_t j = (i + 1) & mask; mSlots[j].mPosition != kEmpty; j = (j + 1) & mask) {
+            size_t wanted = home(mSlots[j].mTag);
+            // Slot j may move into the hole at i only if its probe sequence passes i, i.e. i lies in [wanted, j)
+            if (((j - wanted) & mask) >= ((j - i) & mask)) {
+                mSlots[i] = mSlots[j];
+                mSlots[j].mPosition = kEmpty;
+                i = j;
+            }
+        }
+    }
+
+    /**
+     * Replaces the table by slotCount free slots.
+     */
+    void allocateSlots(size_t slotCount) {
+        mSlots.reset(new Slot[slotCount]);
+        mSlotCount = slotCount;
+        mShift = 32;
+        for (size_t slots = slotCount; slots > 1; slots >>= 1) {
+            mShift--;
+        }
+        for (size_t i = 0; i < slotCount; i++) {
+            mSlots[i].mPosition = kEmpty;
+        }
+    }
+
+    void resizeIndex(size_t slotCount) {
+        std::unique_ptr<Slot[]> oldSlots = std::move(mSlots);
+        size_t oldCount = mSlotCount;
+        allocateSlots(slotCount);
+        size_t mask = slotCount - 1;
+        for (size_t i = 0; i < oldCount; i++) {
+            const Slot &old = oldSlots[i];
+            if (old.mPosition == kEmpty) {
+                continue;
+            }
+            size_t j = home(old.mTag);
+            while (mSlots[j].mPosition != kEmpty) {
+                j = (j + 1) & mask;
+            }
+            mSlots[j] = old;
+        }
+    }
+
+    /**
+     * Indexes every element from scratch, in order, so each key points at its first element.
+     */
+    void rebuild() {
+        allocateSlots(slotsFor(mVector.getSize()));
+        mUsed = 0;
+        indexRange(0, mVector.getSize());
+    }
+};
+
+/// People indexed by name
+using MyPersonNameIndex = MyIndexedVector<Person, MyPersonName>;
+
+#endif //VECTOR_MYINDEXEDVECTOR_H
@@ -0,0 +1,154 @@
+//
+// Allocator for very large vectors, backed by anonymous mmap instead of the heap.
+//
+// Every block reserves a big range of virtual address space up front (64 GiB by default) but only the pages that
+// get touched cost memory. Growing within the reservation is free: tryExpand succeeds without moving a single
+// element, whatever T is. Past the reservation trivially relocatable elements are moved with mremap, which remaps
+// the pages instead of copying them, so there is never an old and a new copy alive at the same time.
+// With huge pages on the range is 2 MiB aligned and marked MADV_HUGEPAGE, so the kernel can back it with
+// transparent huge pages and a scan over the vector takes far fewer TLB misses.
+//
+//      MyLargeVector<double> samples;   // MyVector<double, MyMappedAllocator<double>, MyPageRoundedGrowth<>>
+//
+// Linux only (mremap, MADV_HUGEPAGE).
+//
+
+#ifndef VECTOR_MYMAPPEDALLOCATOR_H
+#define VECTOR_MYMAPPEDALLOCATOR_H
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "MyGrowth.h"
+#include "MyVector.h"
+
+template<typename T>
+class MyMappedAllocator {
+
+private:
+    template<typename U> friend class MyMappedAllocator;
+
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024; /// Transparent huge pages on x86-64 and most arm64
+
+    size_t mReserveBytes; /// Address space reserved for every block, in whole pages
+    bool mHugePages; /// Align blocks to huge pages and ask for them with madvise
+
+public:
+    using value_type = T;
+
+    static constexpr size_t kDefaultReserveBytes = size_t(64) * 1024 * 1024 * 1024;
+
+    /**
+     * @param reserveBytes - address space every block reserves, growth up to this size never moves the elements.
+     * Costs no memory by itself, only page tables for what is touched.
+     * @param hugePages - back the blocks with transparent huge pages when the kernel allows it.
+     */
+    explicit MyMappedAllocator(size_t reserveBytes = kDefaultReserveBytes, bool hugePages = true) noexcept
+            : mReserveBytes(pageRound(reserveBytes)), mHugePages(hugePages) {}
+
+    template<typename U>
+    MyMappedAllocator(const MyMappedAllocator<U> &anotherAllocator) noexcept
+            : mReserveBytes(anotherAllocator.mReserveBytes), mHugePages(anotherAllocator.mHugePages) {}
+
+    T *allocate(size_t capacity) {
+        size_t length = reservedBytes(capacity);
+        size_t alignment = mHugePages ? kHugePageSize : 0;
+        void *mapping = ::mmap(nullptr, length + alignment, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        // Over-mapped by one huge page, cut off what lies before the first aligned address and past the block
+        auto start = reinterpret_cast<uintptr_t>(mapping);
+        uintptr_t alignedStart = alignment == 0 ? start : (start + alignment - 1) / alignment * alignment;
+        if (alignedStart > start) {
+            ::munmap(mapping, alignedStart - start);
+        }
+        if (alignment > alignedStart - start) {
+            ::munmap(reinterpret_cast<void *>(alignedStart + length), alignment - (alignedStart - start));
+        }
+        adviseHugePages(reinterpret_cast<void *>(alignedStart), length);
+        return reinterpret_cast<T *>(alignedStart);
+    }
+
+    void deallocate(T *memBlock, size_t capacity) noexcept { ::munmap(memBlock, reservedBytes(capacity)); }
+
+    /**
+     * Growing within the reserved range needs nothing at all, the pages appear when they are first written.
+     */
+    bool tryExpand(T *, size_t oldCapacity, size_t newCapacity) noexcept {
+        return reservedBytes(newCapacity) == reservedBytes(oldCapacity);
+    }
+
+    /**
+     * Resizes the block of trivially relocatable elements: past the reservation with mremap, which moves page
+     * table entries and not bytes. Shrinking hands the pages past the new end back to the kernel.
+     */
+    T *reallocate(T *memBlock, size_t oldCapacity, size_t newCapacity) {
+        if (memBlock == nullptr) {
+            return allocate(newCapacity);
+        }
+        size_t oldLength = reservedBytes(oldCapacity);
+        size_t newLength = reservedBytes(newCapacity);
+        if (newLength != oldLength) {
+            void *mapping = ::mremap(memBlock, oldLength, newLength, MREMAP_MAYMOVE);
+            if (mapping == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            memBlock = static_cast<T *>(mapping);
+            adviseHugePages(mapping, newLength);
+        }
+        size_t oldUsed = pageRound(oldCapacity * sizeof(T));
+        size_t newUsed = pageRound(newCapacity * sizeof(T));
+        if (newUsed < oldUsed && newUsed < newLength) {
+            size_t end = oldUsed < newLength ? oldUsed : newLength;
+            ::madvise(reinterpret_cast<char *>(memBlock) + newUsed, end - newUsed, MADV_DONTNEED);
+        }
+        return memBlock;
+    }
+
+    size_t getReserveBytes() const noexcept { return mReserveBytes; }
+
+    /// Blocks can be freed by any allocator that reserves the same amount
+    template<typename U>
+    bool operator==(const MyMappedAllocator<U> &anotherAllocator) const noexcept {
+        return mReserveBytes == anotherAllocator.mReserveBytes;
+    }
+
+    template<typename U>
+    bool operator!=(const MyMappedAllocator<U> &anotherAllocator) const noexcept { return !(*this == anotherAllocator); }
+
+private:
+    static size_t pageSize() noexcept {
+        static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    static size_t pageRound(size_t bytes) noexcept { return (bytes + pageSize() - 1) / pageSize() * pageSize(); }
+
+    /**
+     * Length of the mapping behind a block of the given capacity: the reservation, or the block itself once it
+     * has outgrown the reservation.
+     */
+    size_t reservedBytes(size_t capacity) const noexcept {
+        size_t bytes = pageRound(capacity * sizeof(T));
+        return bytes > mReserveBytes ? bytes : mReserveBytes;
+    }
+
+    void adviseHugePages(void *mapping, size_t length) const noexcept {
+#ifdef MADV_HUGEPAGE
+        if (mHugePages) {
+            ::madvise(mapping, length, MADV_HUGEPAGE); // Only a hint, fine if THP is disabled
+        }
+#endif
+    }
+};
+
+/// MyVector for tens of GB: mmap-backed storage that grows in place, in whole pages
+template<typename T>
+using MyLargeVector = MyVector<T, MyMappedAllocator<T>, MyPageRoundedGrowth<>>;
+
+#endif //VECTOR_MYMAPPEDALLOCATOR_H
@@ -0,0 +1,257 @@
+//
+// On-disk format shared by MyVector and MySmallVector.
+//
+// Four layouts exist:
+//
+//      Binary (trivially copyable T): a 32 byte MyFileHeader followed by the raw bytes of all elements.
+//      MyVector<bool> writes the same header with kKindBits and the number of flags, then its packed 64-bit words.
+//      Text (everything else, and files written before the header existed): the number of elements, then for every
+//      element its length and the text produced by operator<<.
+//      Encoded: the header with a non-zero mCodec followed by compressed blocks, see MyCodecs.h.
+//      Chunked: the header with kChunkedVersion, independently readable checksummed blocks and an index of them at
+//      the end, see MyChunkedFile.h.
+//
+// Readers tell them apart by the magic at the start of the file, so old text files keep loading.
+//
+
+#ifndef VECTOR_MYSERIALIZATION_H
+#define VECTOR_MYSERIALIZATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * What serialize() should write.
+ */
+enum class MyFileFormat {
+    Binary, /// Header plus raw element bytes when T is trivially copyable, Text otherwise
+    Text /// Length-prefixed operator<< output for every element, the original format
+};
+
+/**
+ * Header of a binary vector file. Fixed 32 byte layout so element data right after it stays aligned.
+ */
+struct MyFileHeader {
+    static constexpr char kMagic[8] = {'M', 'Y', 'V', 'E', 'C', 'B', 'I', 'N'};
+    static constexpr uint16_t kVersion = 1;
+    static constexpr uint16_t kChunkedVersion = 2; /// Chunked layout, older readers reject it by the version
+
+    /// Values of mEndianness
+    static constexpr uint8_t kLittleEndian = 1;
+    static constexpr uint8_t kBigEndian = 2;
+
+    /// Values of mElementKind, a cheap way to catch reading ints as floats of the same size
+    static constexpr uint8_t kKindOther = 0;
+    static constexpr uint8_t kKindSigned = 1;
+    static constexpr uint8_t kKindUnsigned = 2;
+    static constexpr uint8_t kKindFloating = 3;
+    static constexpr uint8_t kKindBits = 4; /// Flags packed into 64-bit words, mElementCount counts flags
+
+    char mMagic[8]; /// Always kMagic
+    uint16_t mVersion; /// Format version, kVersion at the time of writing
+    uint8_t mEndianness; /// Byte order of the machine that wrote the file
+    uint8_t mCodec; /// How elements are encoded, 0 means raw bytes
+    uint32_t mElementSize; /// sizeof(T) of the writer
+    uint64_t mElementCount; /// Number of elements following the header
+    uint8_t mElementKind; /// Signed/unsigned/floating/other, see kKind*
+    uint8_t mReserved[7]; /// Zero, room for later versions
+
+    static uint8_t nativeEndianness() {
+        const uint16_t probe = 1;
+        uint8_t firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+        return firstByte == 1 ? kLittleEndian : kBigEndian;
+    }
+
+    template<typename T>
+    static constexpr uint8_t kindOf() {
+        if constexpr (std::is_floating_point<T>::value) {
+            return kKindFloating;
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            return kKindSigned;
+        } else if constexpr (std::is_integral<T>::value) {
+            return kKindUnsigned;
+        } else {
+            return kKindOther;
+        }
+    }
+
+    /**
+     * Header describing count elements of type T on this machine.
+     */
+    template<typename T>
+    static MyFileHeader describe(uint64_t count) {
+        MyFileHeader header{};
+        std::memcpy(header.mMagic, kMagic, sizeof(kMagic));
+        header.mVersion = kVersion;
+        header.mEndianness = nativeEndianness();
+        header.mCodec = 0;
+        header.mElementSize = sizeof(T);
+        header.mElementCount = count;
+        header.mElementKind = kindOf<T>();
+        return header;
+    }
+
+    /**
+     * Header describing count flags packed into (count + 63) / 64 words of 64 bits.
+     */
+    static MyFileHeader describeBits(uint64_t count) {
+        MyFileHeader header = describe<uint64_t>(count);
+        header.mElementKind = kKindBits;
+        return header;
+    }
+
+    bool hasMagic() const { return std::memcmp(mMagic, kMagic, sizeof(kMagic)) == 0; }
+
+    /**
+     * True if a reader of T on this machine can use the element bytes as they are.
+     */
+    template<typename T>
+    bool matches() const {
+        return hasMagic() && mVersion == kVersion && mCodec == 0 && mElementSize == sizeof(T)
+               && mElementKind == kindOf<T>() && mEndianness == nativeEndianness();
+    }
+
+    /**
+     * True if the file holds packed flags; their words may still be in the other byte order.
+     */
+    bool holdsBits() const {
+        return hasMagic() && mVersion == kVersion && mCodec == 0 && mElementSize == sizeof(uint64_t)
+               && mElementKind == kKindBits;
+    }
+
+    /**
+     * True if a reader of T on this machine can decode the elements, which were compressed with mCodec
+     * (see MyCodecs.h). Encoded files aren't byte swapped.
+     */
+    template<typename T>
+    bool matchesEncoded() const {
+        return hasMagic() && mVersion == kVersion && mCodec != 0 && mElementSize == sizeof(T)
+               && mElementKind == kindOf<T>() && mEndianness == nativeEndianness();
+    }
+
+    bool isChunked() const { return hasMagic() && mVersion == kChunkedVersion; }
+
+    /**
+     * True if a reader of T on this machine can read the blocks of a chunked file. They aren't byte swapped.
+     */
+    template<typename T>
+    bool matchesChunked() const {
+        return isChunked() && mElementSize == sizeof(T) && mElementKind == kindOf<T>()
+               && mEndianness == nativeEndianness();
+    }
+
+    /**
+     * True if the file only differs from matches() in byte order, which we can fix for arithmetic types.
+     */
+    template<typename T>
+    bool matchesSwapped() const {
+        return std::is_arithmetic<T>::value && hasMagic() && mVersion == kVersion && mCodec == 0
+               && mElementSize == sizeof(T) && mElementKind == kindOf<T>() && mEndianness != nativeEndianness();
+    }
+};
+
+static_assert(sizeof(MyFileHeader) == 32, "MyFileHeader layout must not depend on the compiler");
+
+/**
+ * Number of bytes between the read position and the end of the stream, used to reject headers that promise
+ * more elements than the file holds before anything gets allocated for them.
+ */
+inline uint64_t myRemainingBytes(std::istream &inStream) {
+    std::streampos position = inStream.tellg();
+    inStream.seekg(0, std::ios::end);
+    std::streampos end = inStream.tellg();
+    inStream.seekg(position);
+    return position < 0 || end < position ? 0 : static_cast<uint64_t>(end - position);
+}
+
+/**
+ * Reverses the bytes of every element, used to read files written on a machine of the other endianness.
+ */
+template<typename T>
+void myByteSwap(T *elements, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        auto bytes = reinterpret_cast<unsigned char *>(elements + i);
+        for (size_t low = 0, high = sizeof(T) - 1; low < high; low++, high--) {
+            unsigned char tmp = bytes[low];
+            bytes[low] = bytes[high];
+            bytes[high] = tmp;
+        }
+    }
+}
+
+/**
+ * Writes one element in the text layout: length of its operator<< output followed by that output.
+ */
+template<typename T>
+void myWriteTextElement(std::ostream &outStream, const T &element) {
+    std::stringstream stringStream; // stringStream representing the element
+    stringStream << element;
+    std::string data = stringStream.str();
+    size_t stringSize = data.size();
+
+    outStream.write((char *) &stringSize, sizeof(stringSize));
+    outStream.write(data.data(), sizeof(char) * stringSize);
+}
+
+/**
+ * Reads one element written by myWriteTextElement().
+ * @param data - scratch string, reused between calls to avoid an allocation per element.
+ * @return false if the stream ran out, the length prefix is larger than what is left or the text doesn't parse.
+ */
+template<typename T>
+bool myReadTextElement(std::istream &inStream, T &element, std::string &data) {
+    size_t strSize;
+    if (!inStream.read((char *) &strSize, sizeof(strSize))) {
+        return false;
+    }
+    // A corrupted prefix must not turn into a huge allocation. Lengths the scratch string already fits can't,
+    // so only those that would grow it pay for the seeks measuring the rest of the stream.
+    if (strSize > data.capacity() && strSize > myRemainingBytes(inStream)) {
+        return false;
+    }
+    data.resize(strSize);
+    if (strSize == 0) {
+        return true; // Written for an empty operator<< output, the element stays as it is
+    }
+    if (!inStream.read(&data[0], static_cast<std::streamsize>(strSize))) {
+        return false;
+    }
+    std::stringstream stringStream(data);
+    stringStream >> element;
+    return !stringStream.fail();
+}
+
+/**
+ * Reads the elements of a text layout file once its element count has been read, for every container.
+ * Every element takes at least its length prefix, so a count larger than that can only come from a corrupted file;
+ * otherwise reserve(count) gets to allocate exactly once instead of growing log2(n) times while appending.
+ * @param reserve - called with the number of elements about to be appended.
+ * @param append - called with every element read, which it may move from.
+ * @return false if the count can't fit in the stream or an element can't be read.
+ */
+template<typename T, typename Reserve, typename Append>
+bool myReadTextElements(std::istream &inStream, size_t numberOfElements, Reserve reserve, Append append) {
+    if (myRemainingBytes(inStream) / sizeof(size_t) < numberOfElements) {
+        return false;
+    }
+    reserve(numberOfElements);
+
+    std::string data; // String representing current object
+    for (size_t i = 0; i < numberOfElements; i++) {
+        T element{}; // Object we are reading from file
+        if (!myReadTextElement(inStream, element, data)) {
+            return false;
+        }
+        append(element);
+    }
+    return true;
+}
+
+#endif //VECTOR_MYSERIALIZATION_H
@@ -0,0 +1,557 @@
+//
+// Small-buffer-optimized sibling of MyVector.
+//
+// Keeps up to N elements inside the object itself, so short vectors never touch the heap. Once the N+1st element
+// arrives everything moves into an allocator block and from there on it grows just like MyVector.
+//
+
+#ifndef VECTOR_MYSMALLVECTOR_H
+#define VECTOR_MYSMALLVECTOR_H
+
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include "MyAllocators.h"
+#include "MyFind.h"
+#include "MySerialization.h"
+#include "MySort.h"
+
+/**
+ * @tparam T - type of the elements.
+ * @tparam N - how many elements fit inline before the first heap allocation.
+ * @tparam Alloc - where the memory comes from once we outgrow the inline buffer.
+ */
+template<typename T, size_t N, typename Alloc = MyHeapAllocator<T>>
+class MySmallVector {
+
+    static_assert(N > 0, "MySmallVector needs room for at least one inline element, use MyVector otherwise");
+    static_assert(std::is_same<typename Alloc::value_type, T>::value, "Alloc::value_type must be T");
+
+private:
+    T *mData; /// Points either at mInlineBuffer or at a heap block, only [0, mSize) holds constructed objects
+    size_t mSize = 0; /// Current getSize
+    size_t mCapacity = N; /// Current getCapacity, never less than N
+    Alloc mAllocator; /// Gives and takes back heap blocks
+    alignas(T) unsigned char mInlineBuffer[N * sizeof(T)]; /// Storage for the first N elements
+
+public:
+    using allocator_type = Alloc;
+
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+    /**
+     * Default constructor, elements will be stored inline until there are more than N of them.
+     */
+    MySmallVector() : mData(inlineData()) {}
+
+    explicit MySmallVector(const Alloc &allocator) : mData(inlineData()), mAllocator(allocator) {}
+
+    /**
+     * Enables to construct vector filled with elements using the initializer list
+     * @param initializerList - List of elements we want to push to our vector
+     * @param allocator
+     */
+    MySmallVector(std::initializer_list<T> initializerList, const Alloc &allocator = Alloc())
+            : mData(inlineData()), mAllocator(allocator) {
+        memAlloc(initializerList.size());
+        for (auto &element: initializerList)
+            pushBack(element);
+    }
+
+    /**
+     * Copy constructor, stays inline if the elements fit, otherwise makes one exact-size allocation.
+     */
+    MySmallVector(const MySmallVector<T, N, Alloc> &anotherVector)
+            : mData(inlineData()), mAllocator(anotherVector.mAllocator) {
+        memAlloc(anotherVector.mSize);
+        try {
+            std::uninitialized_copy(anotherVector.mData, anotherVector.mData + anotherVector.mSize, mData);
+        } catch (...) {
+            release(); // No destructor for us: uninitialized_copy undid its copies, the heap block is left to free
+            throw;
+        }
+        mSize = anotherVector.mSize;
+    }
+
+    /**
+     * Move constructor. A heap block is taken over in constant time, inline elements have to be moved
+     * one by one (there are at most N of them). anotherVector is left empty.
+     */
+    MySmallVector(MySmallVector<T, N, Alloc> &&anotherVector) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : mData(inlineData()), mAllocator(std::move(anotherVector.mAllocator)) {
+        stealFrom(anotherVector);
+    }
+
+    /**
+     * Copy assignment via copy-and-swap: if copying throws, this vector stays untouched.
+     */
+    MySmallVector<T, N, Alloc> &operator=(const MySmallVector<T, N, Alloc> &anotherVector) {
+        if (this != &anotherVector) {
+            MySmallVector<T, N, Alloc> copy(anotherVector);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    /**
+     * Move assignment, frees our own elements and takes over the elements of anotherVector.
+     * anotherVector is left empty.
+     */
+    MySmallVector<T, N, Alloc> &operator=(MySmallVector<T, N, Alloc> &&anotherVector)
+            noexcept(std::is_nothrow_move_constructible<T>::value
+                     && std::allocator_traits<Alloc>::is_always_equal::value) {
+        if (this != &anotherVector) {
+            release();
+            mData = inlineData();
+            mSize = 0;
+            mCapacity = N;
+            if (std::allocator_traits<Alloc>::is_always_equal::value || mAllocator == anotherVector.mAllocator) {
+                stealFrom(anotherVector);
+            } else {
+                memAlloc(anotherVector.mSize);
+                std::uninitialized_move(anotherVector.mData, anotherVector.mData + anotherVector.mSize, mData);
+                mSize = anotherVector.mSize;
+                anotherVector.clear();
+            }
+        }
+        return *this;
+    }
+
+    ~MySmallVector() { release(); }
+
+    Alloc getAllocator() const { return mAllocator; }
+
+    /**
+     * True while no heap memory is used.
+     */
+    bool isInline() const { return mData == inlineData(); }
+
+
+    /* ============================================================================================================  *
+     *                                     MODIFIERS                                                                 |
+     * ============================================================================================================  */
+
+    /**
+     * Increases the getSize by one, adds one element to the end.
+     * If getCapacity is too small it doubles it, the first overflow moves everything to the heap.
+     * @param element - thingy we need to add
+     */
+    void pushBack(const T &element) {
+        if (mCapacity <= mSize) {
+            growBack([&element](T *slot) { new(slot) T(element); });
+            return;
+        }
+        new(mData + mSize) T(element);
+        mSize++;
+    }
+
+    /**
+     * Builds the new element in place from the given constructor arguments.
+     * @param args - list of arguments of a variable getSize, thus variadic template is used.
+     * @return object we need.
+     */
+    template<typename... Args>
+    T &emplaceBack(Args &&... args) {
+        if (mCapacity <= mSize) {
+            growBack([&args...](T *slot) { new(slot) T(std::forward<Args>(args)...); });
+            return mData[mSize - 1];
+        }
+        T *element = new(mData + mSize) T(std::forward<Args>(args)...);
+        mSize++;
+        return *element;
+    }
+
+    /**
+     * Removes the last element of a vector, the getCapacity doesn't change.
+     */
+    void popBack() {
+        if (mSize > 0) {
+            mSize--;
+            std::destroy_at(mData + mSize);
+        }
+    }
+
+    /**
+     * Removes all elements from the vector.
+     * Capacity stays the same, getSize = 0.
+     */
+    void clear() {
+        std::destroy(mData, mData + mSize);
+        mSize = 0;
+    }
+
+    /**
+     * A request to reduce getCapacity() to getSize(), elements go back inline if they fit there.
+     */
+    void shrinkToFit() {
+        if (isInline() || mCapacity == mSize) {
+            return;
+        }
+        memAlloc(mSize);
+    }
+
+    /**
+     * If the given value of newSize is less than the getSize at present then extra elements are demolished.
+     * @param newSize
+     */
+    void resize(size_t newSize) {
+        if (newSize < mSize) {
+            std::destroy(mData + newSize, mData + mSize);
+            mSize = newSize;
+        }
+    }
+
+    /* ============================================================================================================  *
+     *                                     ELEMENT ACCESS                                                            |
+     * ============================================================================================================  */
+
+    T &operator[](size_t position) { return mData[position]; }
+
+    const T &operator[](size_t position) const { return mData[position]; }
+
+    T &at(size_t position) { return mData[position]; }
+
+    /* ============================================================================================================  *
+     *                                     CAPACITY                                                                  |
+     * ============================================================================================================  */
+
+    size_t getSize() { return mSize; } /// Returns private mSize
+
+    size_t getCapacity() { return mCapacity; } /// Returns private mCapacity
+
+    /* ============================================================================================================  *
+     *                                     SERIALIZATION                                                             |
+     * ============================================================================================================  */
+
+    /**
+     * Serializes the whole container into a binary file, in the same format as MyVector::serialize,
+     * so files are interchangeable between the two.
+     *
+     * @param fileName
+     * @param format - MyFileFormat::Text forces the text layout even for trivially copyable types.
+     * @return false if the file couldn't be written.
+     */
+    bool serialize(const std::string &fileName, MyFileFormat format = MyFileFormat::Binary) {
+        std::ofstream outFileStream(fileName, std::ios::binary);
+
+        if (outFileStream.good()) {
+            if constexpr (std::is_trivially_copyable<T>::value) {
+                if (format == MyFileFormat::Binary) {
+                    MyFileHeader header = MyFileHeader::describe<T>(mSize);
+                    outFileStream.write((char *) &header, sizeof(header));
+                    outFileStream.write((char *) mData, static_cast<std::streamsize>(mSize * sizeof(T)));
+                    outFileStream.close();
+                    return !outFileStream.fail();
+                }
+            }
+
+            outFileStream.write((char *) &mSize, sizeof(mSize));
+            for (size_t i = 0; i < mSize; i++) {
+                myWriteTextElement(outFileStream, mData[i]);
+            }
+            outFileStream.close();
+        }
+        return !outFileStream.fail();
+    }
+
+    /**
+     * Deserializes the container from a file written by serialize(), elements are appended.
+     *
+     * @param fileName
+     * @return false if the file couldn't be opened, is truncated or holds another element type.
+     */
+    bool deserialize(const std::string &fileName) {
+        std::ifstream inputFileStream(fileName, std::ios::binary);
+        if (!inputFileStream) {
+            return false;
+        }
+
+        MyFileHeader header{};
+        inputFileStream.read((char *) &header, sizeof(header.mMagic));
+        if (!inputFileStream) {
+            return false;
+        }
+
+        if (header.hasMagic()) {
+            inputFileStream.read((char *) &header + sizeof(header.mMagic), sizeof(header) - sizeof(header.mMagic));
+            if constexpr (std::is_trivially_copyable<T>::value) {
+                bool swapped = header.template matchesSwapped<T>();
+                if (!inputFileStream || !(header.template matches<T>() || swapped)
+                    || myRemainingBytes(inputFileStream) / sizeof(T) < header.mElementCount) {
+                    return false;
+                }
+                size_t numberOfElements = header.mElementCount;
+                if (mCapacity < mSize + numberOfElements) {
+                    memAlloc(mSize + numberOfElements);
+                }
+                inputFileStream.read((char *) (mData + mSize),
+                                     static_cast<std::streamsize>(numberOfElements * sizeof(T)));
+                if (!inputFileStream) {
+                    return false;
+                }
+                if (swapped) {
+                    myByteSwap(mData + mSize, numberOfElements);
+                }
+                mSize += numberOfElements;
+                return true;
+            } else {
+                return false;
+            }
+        }
+
+        size_t numberOfElements;
+        std::memcpy(&numberOfElements, header.mMagic, sizeof(numberOfElements));
+
+        return myReadTextElements<T>(inputFileStream, numberOfElements, [this](size_t count) {
+            if (mCapacity < mSize + count) {
+                memAlloc(mSize + count);
+            }
+        }, [this](T &element) { emplaceBack(std::move(element)); });
+    }
+
+    /* ============================================================================================================  *
+     *                                     FIND/SORT                                                                 |
+     * ============================================================================================================  */
+
+    /**
+     * Arithmetic elements are compared with SSE2/AVX2 when the CPU has them.
+     * @param element
+     * @return position of the requested element, npos if it isn't there.
+     */
+    size_t find(const T &element) const { return myFind(mData, mSize, element); }
+
+    /**
+     * @param begin start of a search zone.
+     * @param end end of a search zone.
+     * @param element
+     * @return position of the requested element, npos if it isn't there or the zone is invalid.
+     */
+    size_t find(size_t begin, size_t end, const T &element) const {
+        if (begin < end && end <= mSize) {
+            size_t position = myFind(mData + begin, end - begin, element);
+            return position == npos ? npos : begin + position;
+        }
+        return npos;
+    }
+
+    /**
+     * @param element
+     * @return how many elements are equal to the given one.
+     */
+    size_t count(const T &element) const { return myCount(mData, mSize, element); }
+
+    /**
+     * @param element
+     * @return true if at least one element is equal to the given one.
+     */
+    bool contains(const T &element) const { return find(element) != npos; }
+
+    /**
+     * Sorts elements by the given comparator, same ordering as MyVector::sort(Compare).
+     * @tparam Compare Class name of our comparator
+     * @param compare
+     */
+    template<typename Compare>
+    void sort(Compare compare) {
+        myIntroSort(mData, mData + mSize, compare);
+    }
+
+    /**
+     * Same ordering as MyVector::sort(): largest element first.
+     */
+    void sort() {
+        myIntroSort(mData, mData + mSize, [](const T &first, const T &second) { return second < first; });
+    }
+
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+
+private:
+    class MyIterator {
+        T *mIteratorPointer; // Pointer to current position of our iterator
+    public:
+
+        explicit MyIterator(T *ptr) { mIteratorPointer = ptr; }
+
+        MyIterator &operator++() noexcept {
+            mIteratorPointer++;
+            return *this;
+        }
+
+        MyIterator operator++(int) {
+            MyIterator iterator = *this;
+            ++(*this);
+            return iterator;
+        }
+
+        MyIterator &operator--() {
+            mIteratorPointer--;
+            return *this;
+        }
+
+        MyIterator operator--(int) {
+            MyIterator iterator = *this;
+            --(*this);
+            return iterator;
+        }
+
+        T *operator->() { return mIteratorPointer; }
+
+        T &operator*() { return *mIteratorPointer; }
+
+        bool operator==(const MyIterator &iteratorToCompareWith) const {
+            return mIteratorPointer == iteratorToCompareWith.mIteratorPointer;
+        }
+
+        bool operator!=(const MyIterator &iteratorToCompareWith) const {
+            return mIteratorPointer != iteratorToCompareWith.mIteratorPointer;
+        }
+    };
+
+public:
+    MyIterator begin() { return MyIterator(mData); }
+
+    MyIterator end() { return MyIterator(mData + mSize); }
+
+    /* ============================================================================================================  *
+     *                                     UTIL                                                                      |
+     * ============================================================================================================  */
+
+private:
+    T *inlineData() { return reinterpret_cast<T *>(mInlineBuffer); }
+
+    const T *inlineData() const { return reinterpret_cast<const T *>(mInlineBuffer); }
+
+    /**
+     * Moves storage to a block of the required getCapacity. Anything up to N lives in the inline buffer,
+     * so the heap is only touched when growing past it.
+     * @param requiredCapacity - new getCapacity, must not be smaller than getSize().
+     */
+    void memAlloc(size_t requiredCapacity) {
+        if (requiredCapacity <= N) {
+            if (!isInline()) {
+                relocateTo(inlineData(), N);
+            }
+            return;
+        }
+        if (requiredCapacity == mCapacity) {
+            return;
+        }
+
+        if constexpr (HasTryExpand<Alloc>::value) {
+            if (!isInline() && requiredCapacity > mCapacity
+                && mAllocator.tryExpand(mData, mCapacity, requiredCapacity)) {
+                mCapacity = requiredCapacity;
+                return;
+            }
+        }
+        if constexpr (IsTriviallyRelocatable<T>::value && HasReallocate<Alloc>::value) {
+            if (!isInline()) {
+                mData = mAllocator.reallocate(mData, mCapacity, requiredCapacity);
+                mCapacity = requiredCapacity;
+                return;
+            }
+        }
+        relocateTo(mAllocator.allocate(requiredCapacity), requiredCapacity);
+    }
+
+    /**
+     * Doubles a full block and appends the element construct(T *slot) builds. Its source may be one of our elements
+     * (v.pushBack(v[0])), so it is built before the old block goes away: trivially copyable elements are copied
+     * aside first, anything else is built straight in the new block.
+     */
+    template<typename Construct>
+    void growBack(Construct construct) {
+        size_t newCapacity = mCapacity * 2;
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            alignas(T) unsigned char element[sizeof(T)];
+            construct(reinterpret_cast<T *>(element));
+            memAlloc(newCapacity);
+            std::memcpy(static_cast<void *>(mData + mSize), element, sizeof(T));
+        } else {
+            T *newMemBlock = mAllocator.allocate(newCapacity);
+            try {
+                construct(newMemBlock + mSize);
+            } catch (...) {
+                mAllocator.deallocate(newMemBlock, newCapacity);
+                throw;
+            }
+            relocateTo(newMemBlock, newCapacity, 1);
+        }
+        mSize++;
+    }
+
+    /**
+     * Moves live elements into newMemBlock (inline buffer or a fresh heap block) and frees the old heap block.
+     * @param built - elements already constructed in newMemBlock right after the live ones, destroyed on failure.
+     */
+    void relocateTo(T *newMemBlock, size_t newCapacity, size_t built = 0) {
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            if (mSize > 0) {
+                std::memcpy(static_cast<void *>(newMemBlock), static_cast<const void *>(mData), mSize * sizeof(T));
+            }
+        } else {
+            try {
+                std::uninitialized_move(mData, mData + mSize, newMemBlock);
+            } catch (...) {
+                std::destroy(newMemBlock + mSize, newMemBlock + mSize + built);
+                if (newMemBlock != inlineData()) {
+                    mAllocator.deallocate(newMemBlock, newCapacity);
+                }
+                throw;
+            }
+            std::destroy(mData, mData + mSize);
+        }
+        if (!isInline()) {
+            mAllocator.deallocate(mData, mCapacity);
+        }
+        mData = newMemBlock;
+        mCapacity = newCapacity;
+    }
+
+    /**
+     * Takes the elements of anotherVector, we must be empty and inline. anotherVector ends up empty and inline.
+     */
+    void stealFrom(MySmallVector<T, N, Alloc> &anotherVector) {
+        if (anotherVector.isInline()) {
+            std::uninitialized_move(anotherVector.mData, anotherVector.mData + anotherVector.mSize, mData);
+            mSize = anotherVector.mSize;
+            anotherVector.clear();
+            return;
+        }
+        mData = anotherVector.mData;
+        mSize = anotherVector.mSize;
+        mCapacity = anotherVector.mCapacity;
+        anotherVector.mData = anotherVector.inlineData();
+        anotherVector.mSize = 0;
+        anotherVector.mCapacity = N;
+    }
+
+    /**
+     * Destroys every live element exactly once and frees the heap block if there is one.
+     */
+    void release() {
+        std::destroy(mData, mData + mSize);
+        if (!isInline()) {
+            mAllocator.deallocate(mData, mCapacity);
+        }
+    }
+
+public:
+
+    void print() {
+        for (size_t i = 0; i < mSize; i++) {
+            std::cout << mData[i] << "; ";
+        }
+        std::cout << std::endl;
+    }
+};
+
+#endif //VECTOR_MYSMALLVECTOR_H
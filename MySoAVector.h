@@ -0,0 +1,346 @@
+//
+// Structure-of-arrays container for record types like Person: every field is kept in its own MyVector column.
+//
+// A pass that reads one field (count people older than 30, sort by age) then streams through one dense column
+// instead of dragging whole records - names and all - through the cache. Columns of arithmetic fields get the
+// vectorized find/count kernels and radix sort.
+//
+// The record type is described by a list of fields, each a MyField naming the getter to read it with; the record
+// must be constructible from the field values in that order:
+//
+//      using PersonName = MyField<Person, std::string, &Person::getName>;
+//      using PersonAge = MyField<Person, int, &Person::getAge>;
+//
+//      MySoAVector<Person, PersonName, PersonAge> people;          // MyPersonSoAVector
+//      people.pushBack(Person("Andriy", 19));
+//      people.count<PersonAge>(19);
+//      people.sortBy<PersonAge>();
+//      Person first = people[0].toRecord();
+//
+
+#ifndef VECTOR_MYSOAVECTOR_H
+#define VECTOR_MYSOAVECTOR_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "MyFind.h"
+#include "MySort.h"
+#include "MyVector.h"
+
+/**
+ * One field of a record: its type and the getter that reads it.
+ */
+template<typename Record, typename FieldType, FieldType (Record::*Getter)() const>
+struct MyField {
+    using Type = FieldType;
+
+    static Type get(const Record &record) { return (record.*Getter)(); }
+};
+
+/// Index of Field in Fields..., a compile error if it isn't there
+template<typename Field, typename... Fields>
+struct MyFieldIndex;
+
+template<typename Field, typename... Fields>
+struct MyFieldIndex<Field, Field, Fields...> : std::integral_constant<size_t, 0> {};
+
+template<typename Field, typename Other, typename... Fields>
+struct MyFieldIndex<Field, Other, Fields...>
+        : std::integral_constant<size_t, 1 + MyFieldIndex<Field, Fields...>::value> {};
+
+template<typename Record, typename... Fields>
+class MySoAVector {
+
+    static_assert(sizeof...(Fields) > 0, "A record needs at least one field");
+
+private:
+    std::tuple<MyVector<typename Fields::Type>...> mColumns; /// One column per field, all of the same size
+    size_t mSize = 0; /// Rows, i.e. the size of every column
+
+    template<typename Field>
+    static constexpr size_t kIndexOf = MyFieldIndex<Field, Fields...>::value;
+
+public:
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+    /**
+     * Proxy for one row: reads and writes go straight to the columns.
+     */
+    template<typename Vector>
+    class MyRow {
+        Vector *mVector;
+        size_t mPosition;
+
+    public:
+        MyRow(Vector *vector, size_t position) : mVector(vector), mPosition(position) {}
+
+        /**
+         * @return the value of Field in this row, a reference into its column.
+         */
+        template<typename Field>
+        auto &get() const { return mVector->template column<Field>()[mPosition]; }
+
+        /**
+         * Builds a record out of the row, e.g. a Person.
+         */
+        Record toRecord() const { return Record(get<Fields>()...); }
+
+        /**
+         * Overwrites every field of the row with the fields of record.
+         */
+        const MyRow &operator=(const Record &record) const {
+            static_assert(!std::is_const<Vector>::value, "Row of a const vector");
+            ((get<Fields>() = Fields::get(record)), ...);
+            return *this;
+        }
+
+        size_t getPosition() const { return mPosition; }
+    };
+
+    using Row = MyRow<MySoAVector<Record, Fields...>>;
+    using ConstRow = MyRow<const MySoAVector<Record, Fields...>>;
+
+    MySoAVector() = default;
+
+    MySoAVector(std::initializer_list<Record> initializerList) {
+        reserve(initializerList.size());
+        for (auto &record: initializerList)
+            pushBack(record);
+    }
+
+    /* ============================================================================================================  *
+     *                                     MODIFIERS                                                                 |
+     * ============================================================================================================  */
+
+    /**
+     * Splits record into its fields and appends one to every column.
+     * If a field throws on the way, the columns that already grew are cut back, so the rows stay aligned.
+     */
+    void pushBack(const Record &record) {
+        try {
+            (column<Fields>().pushBack(Fields::get(record)), ...);
+        } catch (...) {
+            trimColumns();
+            throw;
+        }
+        mSize++;
+    }
+
+    /**
+     * Appends a row given field by field, in the order of Fields, without building a record first.
+     */
+    void emplaceBack(typename Fields::Type... values) {
+        try {
+            (column<Fields>().emplaceBack(std::move(values)), ...);
+        } catch (...) {
+            trimColumns();
+            throw;
+        }
+        mSize++;
+    }
+
+    void popBack() {
+        (column<Fields>().popBack(), ...);
+        mSize--;
+    }
+
+    void clear() {
+        (column<Fields>().clear(), ...);
+        mSize = 0;
+    }
+
+    /* ============================================================================================================  *
+     *                                     ELEMENT ACCESS                                                            |
+     * ============================================================================================================  */
+
+    Row operator[](size_t position) { return Row(this, position); }
+
+    ConstRow operator[](size_t position) const { return ConstRow(this, position); }
+
+    Row at(size_t position) { return Row(this, position); }
+
+    /**
+     * Direct access to one column, e.g. to hand the ages of everybody to a numeric routine.
+     */
+    template<typename Field>
+    MyVector<typename Field::Type> &column() { return std::get<kIndexOf<Field>>(mColumns); }
+
+    template<typename Field>
+    const MyVector<typename Field::Type> &column() const { return std::get<kIndexOf<Field>>(mColumns); }
+
+    /* ============================================================================================================  *
+     *                                     CAPACITY                                                                  |
+     * ============================================================================================================  */
+
+    size_t getSize() const { return mSize; }
+
+    void reserve(size_t capacity) { (column<Fields>().reserve(capacity), ...); }
+
+    /* ============================================================================================================  *
+     *                                     COLUMN SCANS                                                              |
+     * ============================================================================================================  */
+
+    /*
+     * Every scan walks a single column. Arithmetic columns are compared 16/32 bytes at a time (see MyFind.h).
+     */
+
+    /**
+     * @return first row whose Field equals value, npos if there is none.
+     */
+    template<typename Field>
+    size_t find(const typename Field::Type &value) const { return column<Field>().find(value); }
+
+    /**
+     * @return number of rows whose Field equals value.
+     */
+    template<typename Field>
+    size_t count(const typename Field::Type &value) const { return column<Field>().count(value); }
+
+    template<typename Field>
+    bool contains(const typename Field::Type &value) const { return find<Field>(value) != npos; }
+
+    /**
+     * @param predicate - bool(const Field::Type &).
+     * @return number of rows whose Field satisfies the predicate.
+     */
+    template<typename Field, typename Predicate>
+    size_t countIf(Predicate predicate) const {
+        const auto &values = column<Field>();
+        size_t matches = 0;
+        for (size_t i = 0; i < mSize; i++) {
+            matches += predicate(values[i]) ? 1 : 0;
+        }
+        return matches;
+    }
+
+    /* ============================================================================================================  *
+     *                                     SORT                                                                      |
+     * ============================================================================================================  */
+
+    /**
+     * Stable sort of the rows by Field using compare. The key column alone is sorted (as row indices), then every
+     * column is permuted once, so other fields are moved exactly once per row no matter how many comparisons ran.
+     * @param compare - bool(const Field::Type &, const Field::Type &), ascending with std::less by default.
+     */
+    template<typename Field, typename Compare = std::less<typename Field::Type>>
+    void sortBy(Compare compare = Compare()) {
+        size_t size = getSize();
+        if (size < 2) {
+            return;
+        }
+        const auto &keys = column<Field>();
+        std::unique_ptr<size_t[]> order(new size_t[size]);
+        for (size_t i = 0; i < size; i++) {
+            order[i] = i;
+        }
+        myIntroSort(order.get(), order.get() + size, [&keys, &compare](size_t first, size_t second) {
+            // Ties keep their original order, that makes the sort stable
+            if (compare(keys[first], keys[second])) {
+                return true;
+            }
+            return !compare(keys[second], keys[first]) && first < second;
+        });
+        permute(order.get());
+    }
+
+    /**
+     * Stable radix sort of the rows by an integral or floating point Field, O(n) in the key column.
+     */
+    template<typename Field>
+    void radixSortBy(bool descending = false) {
+        static_assert(IsRadixSortable<typename Field::Type>::value,
+                      "radixSortBy needs an integral or floating point field of 1-8 bytes");
+        size_t size = getSize();
+        if (size < 2) {
+            return;
+        }
+        const auto &keys = column<Field>();
+        std::unique_ptr<size_t[]> order(new size_t[size]);
+        for (size_t i = 0; i < size; i++) {
+            order[i] = i;
+        }
+        myRadixSortByKey(order.get(), order.get() + size, [&keys](size_t row) { return keys[row]; }, descending);
+        permute(order.get());
+    }
+
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+
+private:
+    class MyIterator {
+        MySoAVector<Record, Fields...> *mVector;
+        size_t mPosition;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Row;
+
+        MyIterator(MySoAVector<Record, Fields...> *vector, size_t position) : mVector(vector), mPosition(position) {}
+
+        MyIterator &operator++() noexcept {
+            mPosition++;
+            return *this;
+        }
+
+        MyIterator operator++(int) {
+            MyIterator iterator = *this;
+            ++(*this);
+            return iterator;
+        }
+
+        Row operator*() const { return Row(mVector, mPosition); }
+
+        bool operator==(const MyIterator &iteratorToCompareWith) const {
+            return mPosition == iteratorToCompareWith.mPosition;
+        }
+
+        bool operator!=(const MyIterator &iteratorToCompareWith) const {
+            return mPosition != iteratorToCompareWith.mPosition;
+        }
+    };
+
+public:
+    MyIterator begin() { return MyIterator(this, 0); }
+
+    MyIterator end() { return MyIterator(this, getSize()); }
+
+    /* ============================================================================================================  *
+     *                                     UTIL                                                                      |
+     * ============================================================================================================  */
+
+private:
+    /**
+     * Pops the row a failed append left in some columns, every column is mSize long again.
+     */
+    void trimColumns() noexcept {
+        ((column<Fields>().getSize() > mSize ? column<Fields>().popBack() : void()), ...);
+    }
+
+    /**
+     * Reorders every column so that row i becomes the row that was at order[i].
+     */
+    void permute(const size_t *order) {
+        size_t size = getSize();
+        std::unique_ptr<size_t[]> origin(new size_t[size]);
+        auto permuteColumn = [&](auto &values) {
+            std::copy(order, order + size, origin.get()); // myApplyPermutation consumes it
+            myApplyPermutation(&values[0], origin.get(), size);
+        };
+        (permuteColumn(column<Fields>()), ...);
+    }
+};
+
+/// Person split into a name column and an age column
+using MyPersonSoAVector = MySoAVector<Person, MyField<Person, std::string, &Person::getName>,
+        MyField<Person, int, &Person::getAge>>;
+
+#endif //VECTOR_MYSOAVECTOR_H
@@ -0,0 +1,460 @@
+//
+// Sorting kernels used by MyVector and MySmallVector. They all work on a plain [first, last) range of elements.
+//
+//      myIntroSort         - quicksort with median-of-three pivots, heapsort once recursion gets too deep,
+//                            insertion sort for short ranges. O(n log n) worst case, not stable.
+//      myRadixSort         - LSD radix sort for integral and floating point values, O(n * sizeof(T)).
+//      myRadixSortByKey    - the same, for records sorted by an integral/floating key; stable.
+//      myPartialSort       - the k smallest elements in order at the front, through a bounded heap, O(n log k).
+//      myPartialSortByKey  - the same (or a full stable sort) by any key, every key extracted only once.
+//      myNthElement        - introselect: one element in its sorted position, O(n) on average.
+//      myParallelMergeSort - splits the range between pool threads, introsorts every chunk and merges them back.
+//
+
+#ifndef VECTOR_MYSORT_H
+#define VECTOR_MYSORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "MyThreadPool.h"
+
+/* ============================================================================================================  *
+ *                                     INTROSORT                                                                 |
+ * ============================================================================================================  */
+
+/// Ranges shorter than this are finished with insertion sort
+static constexpr ptrdiff_t kMyInsertionSortThreshold = 16;
+
+template<typename T, typename Compare>
+void myInsertionSort(T *first, T *last, Compare &compare) {
+    if (first == last) {
+        return;
+    }
+    for (T *current = first + 1; current < last; current++) {
+        if (compare(*current, *first)) {
+            // Smaller than everything sorted so far, shift the whole prefix
+            T value = std::move(*current);
+            std::move_backward(first, current, current + 1);
+            *first = std::move(value);
+        } else {
+            // *first is a sentinel, no bounds check needed
+            T value = std::move(*current);
+            T *hole = current;
+            while (compare(value, *(hole - 1))) {
+                *hole = std::move(*(hole - 1));
+                hole--;
+            }
+            *hole = std::move(value);
+        }
+    }
+}
+
+template<typename T, typename Compare>
+void myHeapSort(T *first, T *last, Compare &compare) {
+    std::make_heap(first, last, compare);
+    std::sort_heap(first, last, compare);
+}
+
+/**
+ * Puts the median of first, middle and last - 1 into *first, to be used as the pivot.
+ */
+template<typename T, typename Compare>
+void myMedianOfThreeToFront(T *first, T *last, Compare &compare) {
+    T *a = first + 1, *b = first + (last - first) / 2, *c = last - 1;
+    T *median;
+    if (compare(*a, *b)) {
+        median = compare(*b, *c) ? b : (compare(*a, *c) ? c : a);
+    } else {
+        median = compare(*a, *c) ? a : (compare(*b, *c) ? c : b);
+    }
+    std::iter_swap(first, median);
+}
+
+/**
+ * Hoare partition of [first, last), at least 3 elements, around a median-of-three pivot.
+ * @return where the pivot ended up: nothing before it compares greater, nothing after it compares less.
+ */
+template<typename T, typename Compare>
+T *myHoarePartition(T *first, T *last, Compare &compare) {
+    myMedianOfThreeToFront(first, last, compare);
+    T *left = first + 1;
+    T *right = last - 1;
+    while (true) {
+        while (left < last && compare(*left, *first)) {
+            left++;
+        }
+        while (compare(*first, *right)) {
+            right--;
+        }
+        if (left >= right) {
+            break;
+        }
+        std::iter_swap(left, right);
+        left++;
+        right--;
+    }
+    std::iter_swap(first, right);
+    return right;
+}
+
+template<typename T, typename Compare>
+void myIntroSortLoop(T *first, T *last, size_t depthLimit, Compare &compare) {
+    while (last - first > kMyInsertionSortThreshold) {
+        if (depthLimit == 0) {
+            myHeapSort(first, last, compare);
+            return;
+        }
+        depthLimit--;
+        T *right = myHoarePartition(first, last, compare);
+
+        // Recurse into the smaller half, loop on the bigger one: stack depth stays O(log n)
+        if (right - first < last - (right + 1)) {
+            myIntroSortLoop(first, right, depthLimit, compare);
+            first = right + 1;
+        } else {
+            myIntroSortLoop(right + 1, last, depthLimit, compare);
+            last = right;
+        }
+    }
+    myInsertionSort(first, last, compare);
+}
+
+/**
+ * 2 * log2(count): partitioning deeper than this means bad pivots, time to switch to a heap.
+ */
+inline size_t myIntroDepthLimit(size_t count) {
+    size_t depthLimit = 0;
+    for (; count > 1; count >>= 1) {
+        depthLimit += 2;
+    }
+    return depthLimit;
+}
+
+/**
+ * Sorts [first, last) so that compare(later, earlier) is never true.
+ */
+template<typename T, typename Compare>
+void myIntroSort(T *first, T *last, Compare compare) {
+    myIntroSortLoop(first, last, myIntroDepthLimit(static_cast<size_t>(last - first)), compare);
+}
+
+/* ============================================================================================================  *
+ *                                     SELECTION                                                                 |
+ * ============================================================================================================  */
+
+/**
+ * Sorts the middle - first smallest elements of [first, last) into [first, middle), the others end up in
+ * [middle, last) in no particular order. A max-heap of the k best so far is kept in [first, middle) and every
+ * later element only has to beat its top: O(n log k) instead of sorting everything.
+ */
+template<typename T, typename Compare>
+void myPartialSort(T *first, T *middle, T *last, Compare compare) {
+    if (first == middle) {
+        return;
+    }
+    std::make_heap(first, middle, compare);
+    for (T *current = middle; current < last; current++) {
+        if (compare(*current, *first)) {
+            std::pop_heap(first, middle, compare);
+            std::iter_swap(middle - 1, current);
+            std::push_heap(first, middle, compare);
+        }
+    }
+    std::sort_heap(first, middle, compare);
+}
+
+/**
+ * Puts the element a full sort would put at nth there, with nothing greater before it and nothing less after it.
+ * Quickselect on the introsort partition, O(n) on average; a partial sort takes over if the pivots keep failing.
+ */
+template<typename T, typename Compare>
+void myNthElement(T *first, T *nth, T *last, Compare compare) {
+    if (nth >= last) {
+        return;
+    }
+    size_t depthLimit = myIntroDepthLimit(static_cast<size_t>(last - first));
+    while (last - first > kMyInsertionSortThreshold) {
+        if (depthLimit == 0) {
+            myPartialSort(first, nth + 1, last, compare);
+            return;
+        }
+        depthLimit--;
+        T *pivot = myHoarePartition(first, last, compare);
+        if (pivot == nth) {
+            return;
+        }
+        if (nth < pivot) {
+            last = pivot;
+        } else {
+            first = pivot + 1;
+        }
+    }
+    myInsertionSort(first, last, compare);
+}
+
+/**
+ * @return true if compare(later, earlier) is false for every neighbouring pair of [first, last).
+ */
+template<typename T, typename Compare>
+bool myIsSorted(const T *first, const T *last, Compare compare) {
+    for (const T *current = first; current + 1 < last; current++) {
+        if (compare(current[1], current[0])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================================================================================  *
+ *                                     RADIX SORT                                                                |
+ * ============================================================================================================  */
+
+/// Keys myRadixKey can map: integral and floating point values 1, 2, 4 or 8 bytes wide, so not long double
+template<typename Key>
+struct IsRadixSortable : std::integral_constant<bool, std::is_arithmetic<Key>::value
+        && (sizeof(Key) == 1 || sizeof(Key) == 2 || sizeof(Key) == 4 || sizeof(Key) == 8)> {};
+
+/**
+ * Maps a value to an unsigned integer of the same width whose natural order matches the order of the values:
+ * flips the sign bit of signed integers, and for floats flips all bits of negatives and the sign bit of positives.
+ */
+template<typename Key>
+auto myRadixKey(Key value) {
+    static_assert(std::is_arithmetic<Key>::value, "Radix sort needs integral or floating point keys");
+    using Bits = std::conditional_t<sizeof(Key) == 1, uint8_t,
+            std::conditional_t<sizeof(Key) == 2, uint16_t,
+                    std::conditional_t<sizeof(Key) == 4, uint32_t, uint64_t>>>;
+    static_assert(sizeof(Key) == sizeof(Bits), "Unsupported key width");
+
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    constexpr Bits signBit = Bits(Bits(1) << (sizeof(Bits) * 8 - 1));
+    if constexpr (std::is_floating_point<Key>::value) {
+        return Bits((bits & signBit) ? ~bits : (bits | signBit));
+    } else if constexpr (std::is_signed<Key>::value) {
+        return Bits(bits ^ signBit);
+    } else {
+        return bits;
+    }
+}
+
+/**
+ * LSD passes, one per key byte, ping-ponging between source and buffer. Passes where every key has the same byte
+ * are skipped. Stable.
+ * @param bitsOf - callable giving the unsigned key of an entry.
+ * @return whichever of the two buffers holds the result.
+ */
+template<typename Entry, typename BitsOf>
+Entry *myRadixPasses(Entry *source, Entry *buffer, size_t count, BitsOf bitsOf) {
+    using Bits = decltype(bitsOf(*source));
+    for (size_t shift = 0; shift < sizeof(Bits) * 8; shift += 8) {
+        size_t offsets[256] = {};
+        for (size_t i = 0; i < count; i++) {
+            offsets[(bitsOf(source[i]) >> shift) & 0xFF]++;
+        }
+        if (offsets[(bitsOf(source[0]) >> shift) & 0xFF] == count) {
+            continue;
+        }
+        size_t total = 0;
+        for (size_t &offset : offsets) {
+            size_t bucket = offset;
+            offset = total;
+            total += bucket;
+        }
+        for (size_t i = 0; i < count; i++) {
+            buffer[offsets[(bitsOf(source[i]) >> shift) & 0xFF]++] = source[i];
+        }
+        std::swap(source, buffer);
+    }
+    return source;
+}
+
+/**
+ * Sorts integral or floating point values, ascending or descending. NaNs end up after +inf (before -inf when
+ * descending).
+ */
+template<typename T>
+void myRadixSort(T *first, T *last, bool descending = false) {
+    size_t count = static_cast<size_t>(last - first);
+    if (count < 2) {
+        return;
+    }
+    using Bits = decltype(myRadixKey(*first));
+    constexpr Bits signBit = Bits(Bits(1) << (sizeof(Bits) * 8 - 1));
+
+    std::unique_ptr<Bits[]> keys(new Bits[count * 2]);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = descending ? Bits(~myRadixKey(first[i])) : myRadixKey(first[i]);
+    }
+    Bits *sorted = myRadixPasses(keys.get(), keys.get() + count, count, [](Bits key) { return key; });
+
+    // Keys are a bijection of the values, turn them back
+    for (size_t i = 0; i < count; i++) {
+        Bits bits = descending ? Bits(~sorted[i]) : sorted[i];
+        if constexpr (std::is_floating_point<T>::value) {
+            bits = (bits & signBit) ? Bits(bits ^ signBit) : Bits(~bits);
+        } else if constexpr (std::is_signed<T>::value) {
+            bits = Bits(bits ^ signBit);
+        }
+        std::memcpy(static_cast<void *>(first + i), &bits, sizeof(bits));
+    }
+}
+
+/**
+ * Moves elements so that first[i] becomes the element that was at first[origin[i]]. origin is consumed.
+ * Every element is moved once, plus one temporary per cycle.
+ */
+template<typename T>
+void myApplyPermutation(T *first, size_t *origin, size_t count) {
+    for (size_t start = 0; start < count; start++) {
+        if (origin[start] == start) {
+            continue;
+        }
+        T value = std::move(first[start]);
+        size_t hole = start;
+        while (origin[hole] != start) {
+            size_t next = origin[hole];
+            first[hole] = std::move(first[next]);
+            origin[hole] = hole;
+            hole = next;
+        }
+        first[hole] = std::move(value);
+        origin[hole] = hole;
+    }
+}
+
+/**
+ * Stable sort of records by an integral or floating point key: keys are extracted once, (key, index) pairs are
+ * radix sorted and the records are then moved into place in a single permutation pass.
+ * @param keyOf - callable returning the key of a record.
+ */
+template<typename T, typename KeyOf>
+void myRadixSortByKey(T *first, T *last, KeyOf keyOf, bool descending = false) {
+    size_t count = static_cast<size_t>(last - first);
+    if (count < 2) {
+        return;
+    }
+    using Bits = decltype(myRadixKey(keyOf(*first)));
+    using Entry = std::pair<Bits, size_t>;
+
+    std::unique_ptr<Entry[]> entries(new Entry[count * 2]);
+    for (size_t i = 0; i < count; i++) {
+        Bits key = myRadixKey(keyOf(first[i]));
+        entries[i] = Entry(descending ? Bits(~key) : key, i);
+    }
+    Entry *sorted = myRadixPasses(entries.get(), entries.get() + count, count,
+                                  [](const Entry &entry) { return entry.first; });
+
+    std::unique_ptr<size_t[]> origin(new size_t[count]);
+    for (size_t i = 0; i < count; i++) {
+        origin[i] = sorted[i].second;
+    }
+    myApplyPermutation(first, origin.get(), count);
+}
+
+/**
+ * Sorts the middle - first records with the smallest keys into [first, middle), stably, by any comparable key.
+ * Keys are extracted once instead of in every comparison: (key, index) pairs are partially sorted with the index as
+ * tie-break and the records moved into place in a single permutation pass. middle == last is a full stable sort.
+ * @param keyOf - callable returning the key of a record.
+ * @param compare - ordering of the keys.
+ */
+template<typename T, typename KeyOf, typename Compare>
+void myPartialSortByKey(T *first, T *middle, T *last, KeyOf keyOf, Compare compare) {
+    size_t count = static_cast<size_t>(last - first);
+    if (count < 2 || first == middle) {
+        return;
+    }
+    using Key = std::decay_t<decltype(keyOf(*first))>;
+    using Entry = std::pair<Key, size_t>;
+
+    std::unique_ptr<Entry[]> entries(new Entry[count]);
+    for (size_t i = 0; i < count; i++) {
+        entries[i] = Entry(keyOf(first[i]), i);
+    }
+    auto byKey = [&compare](const Entry &left, const Entry &right) {
+        if (compare(left.first, right.first)) {
+            return true;
+        }
+        return !compare(right.first, left.first) && left.second < right.second;
+    };
+    std::unique_ptr<size_t[]> origin(new size_t[count]);
+    if (middle == last) {
+        myIntroSort(entries.get(), entries.get() + count, byKey);
+        for (size_t i = 0; i < count; i++) {
+            origin[i] = entries[i].second;
+        }
+        myApplyPermutation(first, origin.get(), count);
+        return;
+    }
+
+    // Only the selected records and the ones they displace from the front move, the rest stay where they are
+    size_t k = static_cast<size_t>(middle - first);
+    myPartialSort(entries.get(), entries.get() + k, entries.get() + count, byKey);
+    std::unique_ptr<bool[]> selectedInFront(new bool[k]());
+    for (size_t i = 0; i < k; i++) {
+        if (entries[i].second < k) {
+            selectedInFront[entries[i].second] = true;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        origin[i] = i;
+    }
+    size_t displaced = 0;
+    for (size_t i = 0; i < k; i++) {
+        size_t from = entries[i].second;
+        origin[i] = from;
+        if (from >= k) {
+            while (selectedInFront[displaced]) {
+                displaced++;
+            }
+            origin[from] = displaced++;
+        }
+    }
+    myApplyPermutation(first, origin.get(), count);
+}
+
+/* ============================================================================================================  *
+ *                                     PARALLEL MERGE SORT                                                       |
+ * ============================================================================================================  */
+
+/**
+ * Splits [first, last) into one chunk per thread, introsorts the chunks on the policy's thread pool and then merges
+ * neighbouring runs pairwise, all merges of a round running concurrently, until one run is left.
+ */
+template<typename T, typename Compare>
+void myParallelMergeSort(T *first, T *last, Compare compare, const MyParallelPolicy &policy) {
+    size_t count = static_cast<size_t>(last - first);
+    size_t runs = policy.threadsFor(count);
+    if (runs <= 1) {
+        myIntroSort(first, last, compare);
+        return;
+    }
+
+    // Run i is [count * i / runs, count * (i + 1) / runs), the same split parallelFor uses for its chunks
+    myParallelChunks(count, runs, policy, [first, &compare](size_t, size_t begin, size_t end) {
+        myIntroSort(first + begin, first + end, compare);
+    });
+
+    for (size_t width = 1; width < runs; width *= 2) {
+        size_t merges = (runs + 2 * width - 1) / (2 * width);
+        myParallelChunks(merges, merges, policy, [first, &compare, count, runs, width](size_t, size_t from, size_t to) {
+            for (size_t merge = from; merge < to; merge++) {
+                size_t left = merge * 2 * width;
+                if (left + width >= runs) {
+                    continue; // Odd run out, nothing to merge it with this round
+                }
+                size_t right = left + 2 * width < runs ? left + 2 * width : runs;
+                std::inplace_merge(first + count * left / runs, first + count * (left + width) / runs,
+                                   first + count * right / runs, compare);
+            }
+        });
+    }
+}
+
+#endif //VECTOR_MYSORT_H
@@ -0,0 +1,273 @@
+//
+// Work-stealing thread pool behind the parallel algorithms of MyVector (forEach, transform, reduce, countIf, sort).
+//
+// Every worker owns a task deque: it pops its own tasks from the back and, when it runs dry, steals from the front
+// of the other deques. Threads that are not workers push to a shared deque. A thread waiting for a parallel loop
+// runs queued tasks itself instead of just blocking, so nested parallel loops can't deadlock and a pool with zero
+// workers simply runs everything on the caller.
+//
+
+#ifndef VECTOR_MYTHREADPOOL_H
+#define VECTOR_MYTHREADPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+class MyThreadPool;
+
+/**
+ * Asks an algorithm to spread the work over several threads.
+ */
+struct MyParallelPolicy {
+    unsigned mThreadCount = 0; /// 0 means std::thread::hardware_concurrency()
+    size_t mMinElementsPerThread = 32 * 1024; /// Below this many elements per thread it is not worth it
+    MyThreadPool *mPool = nullptr; /// nullptr means MyThreadPool::shared()
+
+    /**
+     * @return how many threads are worth using for count elements, 1 means run serially.
+     */
+    unsigned threadsFor(size_t count) const {
+        unsigned threads = mThreadCount != 0 ? mThreadCount : std::thread::hardware_concurrency();
+        size_t useful = mMinElementsPerThread == 0 ? count : count / mMinElementsPerThread;
+        if (useful < threads) {
+            threads = static_cast<unsigned>(useful);
+        }
+        return threads == 0 ? 1 : threads;
+    }
+};
+
+class MyThreadPool {
+
+private:
+    struct TaskQueue {
+        std::mutex mMutex;
+        std::deque<std::function<void()>> mTasks;
+    };
+
+    unsigned mWorkerCount; /// Number of worker threads
+    std::unique_ptr<TaskQueue[]> mQueues; /// One per worker, plus the last one for outside threads
+    std::unique_ptr<std::thread[]> mWorkers;
+    std::atomic<size_t> mPending{0}; /// Tasks sitting in some queue
+    std::mutex mSleepMutex; /// Guards sleeping workers
+    std::condition_variable mWakeUp; /// Signalled when a task is pushed or the pool stops
+    bool mStopping = false; /// Set once by the destructor
+
+    /// Which pool/queue the current thread works for, if any
+    static MyThreadPool *&currentPool() {
+        thread_local MyThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    static unsigned &currentIndex() {
+        thread_local unsigned index = 0;
+        return index;
+    }
+
+public:
+    /**
+     * @param workerCount - threads to start; the thread waiting for a parallel loop also works, so
+     * hardware_concurrency() - 1 workers keep every core busy.
+     */
+    explicit MyThreadPool(unsigned workerCount = defaultWorkerCount())
+            : mWorkerCount(workerCount), mQueues(new TaskQueue[workerCount + 1]),
+              mWorkers(new std::thread[workerCount]) {
+        for (unsigned i = 0; i < mWorkerCount; i++) {
+            mWorkers[i] = std::thread([this, i] { workerLoop(i); });
+        }
+    }
+
+    MyThreadPool(const MyThreadPool &) = delete;
+
+    MyThreadPool &operator=(const MyThreadPool &) = delete;
+
+    /**
+     * Finishes every queued task, then joins the workers.
+     */
+    ~MyThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mStopping = true;
+        }
+        mWakeUp.notify_all();
+        for (unsigned i = 0; i < mWorkerCount; i++) {
+            mWorkers[i].join();
+        }
+    }
+
+    /**
+     * Process-wide pool used when a MyParallelPolicy doesn't name one. Created on first use.
+     */
+    static MyThreadPool &shared() {
+        static MyThreadPool pool;
+        return pool;
+    }
+
+    static unsigned defaultWorkerCount() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    unsigned getWorkerCount() const { return mWorkerCount; }
+
+    /**
+     * Queues a task. Workers push to their own deque, everybody else to the shared one.
+     */
+    void submit(std::function<void()> task) {
+        TaskQueue &queue = mQueues[currentPool() == this ? currentIndex() : mWorkerCount];
+        {
+            // Counted before it becomes visible, so a thread that takes it never sees mPending go below zero
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mPending++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue.mMutex);
+            queue.mTasks.push_back(std::move(task));
+        }
+        mWakeUp.notify_one();
+    }
+
+    /**
+     * Runs one queued task on the calling thread: own tasks first (newest), then stolen ones (oldest).
+     * @return false if every queue was empty.
+     */
+    bool runPendingTask() {
+        unsigned queueCount = mWorkerCount + 1;
+        unsigned own = currentPool() == this ? currentIndex() : mWorkerCount;
+        std::function<void()> task;
+        for (unsigned offset = 0; offset < queueCount && !task; offset++) {
+            TaskQueue &queue = mQueues[(own + offset) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.mMutex);
+            if (queue.mTasks.empty()) {
+                continue;
+            }
+            if (offset == 0) {
+                task = std::move(queue.mTasks.back());
+                queue.mTasks.pop_back();
+            } else {
+                task = std::move(queue.mTasks.front());
+                queue.mTasks.pop_front();
+            }
+        }
+        if (!task) {
+            return false;
+        }
+        mPending--;
+        task();
+        return true;
+    }
+
+    /**
+     * Calls body(chunkIndex, begin, end) for chunkCount contiguous chunks of [0, count) and waits for all of them.
+     * The calling thread runs chunks too. The first exception thrown by a chunk is rethrown here.
+     */
+    template<typename Body>
+    void parallelFor(size_t count, size_t chunkCount, Body body) {
+        if (chunkCount > count) {
+            chunkCount = count;
+        }
+        if (chunkCount <= 1) {
+            if (count > 0) {
+                body(size_t(0), size_t(0), count);
+            }
+            return;
+        }
+
+        struct Completion {
+            std::atomic<size_t> mRemaining;
+            std::mutex mMutex;
+            std::condition_variable mDone;
+            std::exception_ptr mError;
+        } completion;
+        completion.mRemaining = chunkCount;
+
+        auto runChunk = [&completion, &body, count, chunkCount](size_t chunk) {
+            try {
+                body(chunk, count * chunk / chunkCount, count * (chunk + 1) / chunkCount);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(completion.mMutex);
+                if (!completion.mError) {
+                    completion.mError = std::current_exception();
+                }
+            }
+            std::lock_guard<std::mutex> lock(completion.mMutex);
+            if (--completion.mRemaining == 0) {
+                completion.mDone.notify_all();
+            }
+        };
+
+        for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+            submit([&runChunk, chunk] { runChunk(chunk); });
+        }
+        runChunk(0);
+
+        // Help out while our chunks are still queued, sleep once they are all being worked on
+        while (completion.mRemaining.load() != 0) {
+            if (!runPendingTask()) {
+                std::unique_lock<std::mutex> lock(completion.mMutex);
+                completion.mDone.wait_for(lock, std::chrono::milliseconds(1),
+                                          [&completion] { return completion.mRemaining.load() == 0; });
+            }
+        }
+        // The last chunk may still be inside its locked section, wait for it before completion goes away
+        std::lock_guard<std::mutex> lock(completion.mMutex);
+        if (completion.mError) {
+            std::rethrow_exception(completion.mError);
+        }
+    }
+
+private:
+    void workerLoop(unsigned index) {
+        currentPool() = this;
+        currentIndex() = index;
+        while (true) {
+            if (runPendingTask()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mWakeUp.wait(lock, [this] { return mPending.load() > 0 || mStopping; });
+            if (mStopping && mPending.load() == 0) {
+                return;
+            }
+        }
+    }
+};
+
+/**
+ * How many chunks [0, count) should be split into for the given policy: 1 (serial) when there isn't enough work,
+ * otherwise a few chunks per thread so stealing can even out the load.
+ */
+inline size_t myChunkCount(size_t count, const MyParallelPolicy &policy) {
+    static constexpr size_t kChunksPerThread = 4;
+    unsigned threads = policy.threadsFor(count);
+    if (threads <= 1) {
+        return count > 0 ? 1 : 0;
+    }
+    return threads * kChunksPerThread < count ? threads * kChunksPerThread : count;
+}
+
+/**
+ * Runs body(chunkIndex, begin, end) for chunkCount chunks of [0, count) on the policy's pool, or right here
+ * when there is a single chunk.
+ */
+template<typename Body>
+void myParallelChunks(size_t count, size_t chunkCount, const MyParallelPolicy &policy, Body body) {
+    if (chunkCount <= 1) {
+        if (count > 0) {
+            body(size_t(0), size_t(0), count);
+        }
+        return;
+    }
+    MyThreadPool &pool = policy.mPool != nullptr ? *policy.mPool : MyThreadPool::shared();
+    pool.parallelFor(count, chunkCount, body);
+}
+
+#endif //VECTOR_MYTHREADPOOL_H
@@ -1,529 +1,1496 @@
-//
-// Custom implementation of a vector without the use of STL containers.
-// Created by Andriy Bobchuk on 12/28/2021.
-//
-
-#ifndef VECTOR_MYVECTOR_H
-#define VECTOR_MYVECTOR_H
-
-#include <memory>
-#include <fstream>
-#include <sstream>
-#include <iostream>
-#include <iomanip>
-
-// Class to test if vector is working with custom objects
-class Person {
-private:
-    std::string mName;
-    int mAge;
-
-public:
-    Person() {};
-
-    Person(std::string newName, int newAge) {
-        mName = newName;
-        mAge = newAge;
-    }
-
-    std::string getName() { return this->mName; }
-
-    int getAge() { return this->mAge; }
-
-    // I will use the member function print() belonging to MyVector, thus I need this:
-    friend std::ostream &operator<<(std::ostream &os, const Person &person) {
-        os << "Name: " << person.mName << "\tAge: "  << person.mAge;
-        return os;
-    }
-
-    // Needed for the deserialization:
-    friend std::istream &operator>>(std::istream &is, Person &person) {
-        std::string tmp;
-        is >> tmp >> person.mName >> tmp >> person.mAge;
-        return is;
-    }
-
-//    // I will sort people by parameters
-//    bool operator<(const Person &personToCompareWith) const {
-//        return mAge < personToCompareWith.mAge;
-//    }
-//
-//    bool operator>(const Person &personToCompareWith) const {
-//        return mAge > personToCompareWith.mAge;
-//    }
-};
-
-template<typename T>
-class MyVector {
-
-private:
-    std::shared_ptr<T[]> mData = nullptr; /// main data storage
-    size_t mSize = 0; /// Current getSize
-    size_t mCapacity = 0; /// Current getCapacity
-
-public:
-    /**
-     * Default constructor, calls memory allocation function
-     */
-    MyVector() { memAlloc(0); }
-
-    /**
-     * Enables to construct vector filled with elements using the initializer list
-     * @param initializerList - List of elements we want to push to our vector
-     */
-    MyVector(std::initializer_list<T> initializerList) {
-        for (auto &element: initializerList)
-            pushBack(element);
-    }
-
-    // &
-    MyVector(MyVector<T> &myVector) {
-
-        /// Allocate a new block of memory with the same getCapacity:
-        std::shared_ptr<T[]> newMemBlock(new T[myVector.mCapacity]);
-
-        /// Move elements from old block to a new one:
-        for (size_t i = 0; i < myVector.mSize; i++) {
-            newMemBlock.get()[i] = myVector.mData.get()[i];
-        }
-
-        /// Reset mData field to store our new block of memory:
-        mData = newMemBlock;
-
-        /// Set a new getCapacity value
-        mCapacity = myVector.mCapacity;
-        mSize = myVector.mSize;
-
-//        this->mData = myVector.mData;
-//        this->mSize = myVector.mSize;
-//        this->mCapacity = myVector.mCapacity;
-    }
-
-    // &&
-    MyVector(MyVector<T> &&myVector) noexcept {
-        std::shared_ptr<T[]> newMemBlock(new T[myVector.mCapacity]);
-        for (size_t i = 0; i < myVector.mSize; i++) {
-            newMemBlock.get()[i] = std::move(myVector.mData.get()[i]);
-        }
-        mData = newMemBlock;
-        mCapacity = myVector.mCapacity;
-        mSize = myVector.mSize;
-    }
-
-    // &
-    MyVector<T> &operator=(const MyVector<T> &anotherVector) {
-        std::shared_ptr<T[]> newMemBlock(new T[anotherVector.mCapacity]);
-        for (size_t i = 0; i < anotherVector.mSize; i++) {
-            newMemBlock.get()[i] = anotherVector.mData.get()[i];
-        }
-        mData = newMemBlock;
-        mCapacity = anotherVector.mCapacity;
-        mSize = anotherVector.mSize;
-    }
-
-    // &&
-    MyVector<T> &operator=(MyVector<T> &&anotherVector) noexcept {
-        std::shared_ptr<T[]> newMemBlock(new T[anotherVector.mCapacity]);
-        for (size_t i = 0; i < anotherVector.mSize; i++) {
-            newMemBlock.get()[i] = std::move(anotherVector.mData.get()[i]);
-        }
-        mData = newMemBlock;
-        mCapacity = anotherVector.mCapacity;
-        mSize = anotherVector.mSize;
-    }
-
-    ~MyVector() {}
-
-
-    /* ============================================================================================================  *
-     *                                     MODIFIERS                                                                 |
-     * ============================================================================================================  */
-
-    /**
-     * Increases the getSize by one, adds one element to the end.
-     * If getCapacity is too small it doubles it.
-     * @param element - thingy we need to add
-     */
-    void pushBack(const T &element) {
-
-        // When not enough getCapacity we double it, but we cannot double zero
-        if (mCapacity == 0) {
-            memAlloc(1);
-        } else if (mCapacity <= mSize) {
-            memAlloc(mCapacity * 2);
-        }
-        mData.get()[mSize] = element;
-        mSize++;
-    };
-
-    /**
-     * EmplaceBack function takes not the constructor of the object as a parameter [When it comes to some complex
-     * types of objects like structs], it takes the list of arguments needed to build this object in our
-     * memory block IN PLACE.
-     *
-     * With that being said we are saving one move operation, which is not really demanding but still.
-     *
-     * @param args - list of arguments of a variable getSize, thus variadic template is used.
-     * @return object we need.
-     */
-    template<typename... Args>
-    T &emplaceBack(Args &&... args) {
-
-        /*
-         * Exactly the same code as push fun, only last line differs
-         */
-
-        // When not enough getCapacity we double it, but we cannot double zero
-        if (mCapacity == 0) {
-            memAlloc(1);
-        } else if (mCapacity <= mSize) {
-            memAlloc(mCapacity * 2);
-        }
-
-        // Instead of making mData[mSize] equal to object we forward all our
-        // arguments to the constructor:
-        mData.get()[mSize] = T(std::forward<Args>(args)...);;
-        mSize++;
-        return mData.get()[mSize];
-    };
-
-    /**
-     * Removes the last element of a vector.
-     * Like in a standard vector class, this function doesn't change the getCapacity, only the getSize.
-     */
-    void popBack() {
-        if (mSize > 0) {
-            mSize--;
-            mData.get()[mSize].~T();
-        }
-    };
-
-    /**
-     * Removes all elements from the vector.
-     * Capacity stays the same, getSize = 0.
-     */
-    void clear() {
-        for (size_t i = 0; i < mSize; i++) {
-            mData.get()[i].~T();
-        }
-        mSize = 0;
-    }
-
-    /**
-      * A request to reduce getCapacity() to getSize().
-      */
-    void shrinkToFit() {
-        for (size_t i = mSize; i < mCapacity; i++) {
-            mData.get()[i].~T();
-        }
-        mCapacity = mSize;
-    };
-
-    /**
-     * If the given value of newSize is less than the getSize at present then extra elements are demolished.
-     * If newSize is more than current getSize of container then upcoming elements are appended at the end of the vector.
-     * @param newSize
-     */
-    void resize(size_t newSize) {
-
-        if (newSize < mSize) {
-            for (size_t i = newSize; i < mSize; i++) {
-                mData.get()[i].~T();
-            }
-            mSize = newSize;
-        }
-    };
-
-    /* ============================================================================================================  *
-     *                                     ELEMENT ACCESS                                                            |
-     * ============================================================================================================  */
-
-    /**
-     * Allows us to access a certain element of a vector by its position in a container.
-     *
-     * @param position - index of the element we want to access.
-     * @return the actual object we asked for.
-     */
-    T &operator[](size_t position) { return mData.get()[position]; }
-
-    /**
-     * The compiler will pick the const overload only when being called on a const object, otherwise it will
-     * always prefer to use the non-const method.
-     *
-     * @param position - index of the vector's element we want to access.
-     * @return the actual object we asked for.
-     */
-    const T &operator[](size_t position) const { return mData.get()[position]; }
-
-    /**
-     * Same as operator[] allows to access a certain element of a vector by its position.
-     * @param position
-     * @return object at the given position.
-     */
-    T &at(size_t position) { return mData.get()[position]; }
-
-
-    /* ============================================================================================================  *
-     *                                     CAPACITY                                                                  |
-     * ============================================================================================================  */
-
-    size_t getSize() { return mSize; } /// Returns private mSize
-
-    size_t getCapacity() { return mCapacity; } /// Returns private mCapacity
-
-    /* ============================================================================================================  *
-     *                                     SERIALIZATION                                                             |
-     * ============================================================================================================  */
-
-    /**
-     * Serializes the whole container with all its elements into a binary file.
-     *
-     * @param fileName
-     */
-
-    void serialize(const std::string &fileName) {
-
-        // Opening the binary file by the name:
-        std::ofstream outFileStream(fileName, std::ios::binary);
-
-        if (outFileStream.good()) {
-
-            // Firstly, write the number of elements in our vector:
-            outFileStream.write((char *) &mSize, sizeof(mSize));
-
-            for (size_t i = 0; i < mSize; i++) {
-
-                std::stringstream stringStream; // stringStream representing each element
-                stringStream << mData.get()[i];
-                size_t stringSize = stringStream.str().size();
-
-                // Writing the length of generated string:
-                outFileStream.write((char *) &(stringSize), sizeof(stringSize));
-
-                // Writing this string:
-                outFileStream.write((char *) (stringStream.str().data()), sizeof(char) * stringSize);
-            }
-            outFileStream.close();
-        }
-    }
-
-
-    /**
-     * Deserializes the container from a binary file.
-     *
-     * @param fileName
-     */
-    void deserialize(const std::string &fileName) {
-        std::ifstream inputFileStream(fileName, std::ios::binary);
-        if (inputFileStream) {
-
-            size_t numberOfElements;
-            inputFileStream.read((char *) &numberOfElements, sizeof(numberOfElements));
-
-            for (size_t i = 0; i < numberOfElements; i++) {
-
-                std::stringstream stringStream;
-                T element; // Object we are reading from file
-
-                std::string data; // String representing current object
-
-                size_t strSize;
-                inputFileStream.read((char *) &strSize, sizeof(strSize)); // Read length of this string
-
-                for (size_t j = 0; j < strSize; j++) {
-                    data += inputFileStream.get(); // from inputFileStream to string
-                }
-
-                stringStream << data; // String to stringStream
-                stringStream >> element; // Get element from stringStream
-                pushBack(element); // Add it to vector
-
-            }
-
-            inputFileStream.close();
-        }
-    }
-
-
-
-    /* ============================================================================================================  *
-     *                                     FIND/SORT                                                                 |
-     * ============================================================================================================  */
-
-    /**
-     * @param element
-     * @return position of the requested element.
-     */
-    int find(const T &element) {
-
-        for (int i = 0; i < mSize; i++) {
-            if (mData.get()[i] == element) {
-                return i;
-            }
-        }
-        return -1;
-    }
-
-    /**
-     * @param begin start of a search zone.
-     * @param end end of a search zone.
-     * @param element
-     * @return position of the requested element.
-     */
-    int find(int begin, int end, const T &element) {
-
-        if (begin >= 0 && begin < end && end <= mSize) {
-            for (int i = begin; i < end; i++) {
-                if (mData.get()[i] == element) {
-                    return i;
-                }
-            }
-        }
-        return -1;
-    }
-
-    /**
-     * Sorts vector of complex structures by the given comparator
-     * @tparam Compare Class name of our comparator
-     * @param compare
-     */
-    template<typename Compare>
-    void sort(Compare compare) {
-
-        for (int i = 0; i < mSize - 1; i++) {
-            for (int j = 0; j < mSize - i - 1; j++) {
-                if (!compare(mData.get()[j], mData.get()[j + 1])) {
-                    swap(mData.get()[j], mData.get()[j + 1]);
-                }
-            }
-        }
-    }
-
-    /**
-     * Simple sort function, uses bubble  sort.
-     */
-    void sort() {
-
-        for (int i = 0; i < mSize - 1; i++) {
-            for (int j = 0; j < mSize - i - 1; j++) {
-                if (mData.get()[j] < mData.get()[j + 1]) {
-                    swap(mData.get()[j], mData.get()[j + 1]);
-                }
-            }
-        }
-    }
-
-    /* ============================================================================================================  *
-     *                                     ITERATORS                                                                 |
-     * ============================================================================================================  */
-
-private:
-    class MyIterator {
-        T *mIteratorPointer; // Pointer to current position of our iterator
-    public:
-
-        explicit MyIterator(T *ptr) { mIteratorPointer = ptr; }
-
-        // Pre increment:
-        MyIterator &operator++() noexcept {
-            mIteratorPointer++;
-            return *this;
-        }
-
-        // Post increment:
-        MyIterator operator++(int) {
-            MyIterator iterator = *this;
-            ++(*this);
-            return iterator;
-        }
-
-        MyIterator &operator--() {
-            mIteratorPointer--;
-            return *this;
-        }
-
-        MyIterator operator--(int) {
-            MyIterator iterator = *this;
-            --(*this);
-            return iterator;
-        }
-
-        T *operator->() { return mIteratorPointer; }
-
-        T &operator*() { return *mIteratorPointer; }
-
-        bool operator==(const MyIterator &iteratorToCompareWith) const {
-            return mIteratorPointer == iteratorToCompareWith.mIteratorPointer;
-        }
-
-        bool operator!=(const MyIterator &iteratorToCompareWith) const {
-            return mIteratorPointer != iteratorToCompareWith.mIteratorPointer;
-        }
-    };
-
-
-public:
-    MyIterator begin() {
-        return MyIterator(mData.get()); // Points at the 0th obj of the collection
-    }
-
-    MyIterator end() {
-        return MyIterator(mData.get() + mSize); // Points right past the last byte of memory we own
-    }
-
-    /* ============================================================================================================  *
-     *                                     UTIL                                                                      |
-     * ============================================================================================================  */
-
-private:
-    /**
-    * Memory allocation function, algorithm:
-     *
-    *      1. Allocate a new memory block with a required getCapacity.
-    *      2. Copy elements from old block to a new one.
-    *      3. Reload mData block.
-    *      4. Set a new getCapacity value.
-    * @param requiredCapacity - new getCapacity.
-    */
-    void memAlloc(size_t requiredCapacity) {
-        /// Allocate a new block of memory with a new getCapacity:
-        std::shared_ptr<T[]> newMemBlock(new T[requiredCapacity]);
-
-        /// Move elements from old block to a new one:
-        for (size_t i = 0; i < mSize; i++) {
-            newMemBlock.get()[i] = std::move(mData.get()[i]);
-        }
-
-        /// Reset mData field to store our new block of memory:
-        mData = newMemBlock;
-
-        /// Set a new getCapacity value
-        mCapacity = requiredCapacity;
-        //std::cout << requiredCapacity << " memory cells allocated\n";
-    }
-
-    void swap(T &x, T &y) {
-        T temp = x;
-        x = y;
-        y = temp;
-    }
-
-public:
-
-
-    void print() {
-        try {
-            for (size_t i = 0; i < mSize; i++) {
-                std::cout << mData.get()[i] << "; ";
-            }
-            std::cout << std::endl;
-        } catch (std::exception e) {
-            std::cout << "Ooops " << e.what() << std::endl;
-        }
-    }
-
-
-};
-
-#endif //VECTOR_MYVECTOR_H
-
+//
+// Custom implementation of a vector without the use of STL containers.
+// Created by Andriy Bobchuk on 12/28/2021.
+//
+
+#ifndef VECTOR_MYVECTOR_H
+#define VECTOR_MYVECTOR_H
+
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <future>
+#include <optional>
+#include "MyAllocators.h"
+#include "MyAsyncFile.h"
+#include "MyChunkedFile.h"
+#include "MyCodecs.h"
+#include "MyCompact.h"
+#include "MyFind.h"
+#include "MyGrowth.h"
+#include "MySerialization.h"
+#include "MySort.h"
+#include "MyVectorStats.h"
+
+// Class to test if vector is working with custom objects
+class Person {
+private:
+    std::string mName;
+    int mAge;
+
+public:
+    Person() {};
+
+    Person(std::string newName, int newAge) {
+        mName = newName;
+        mAge = newAge;
+    }
+
+    std::string getName() const { return this->mName; }
+
+    int getAge() const { return this->mAge; }
+
+    // I will use the member function print() belonging to MyVector, thus I need this:
+    friend std::ostream &operator<<(std::ostream &os, const Person &person) {
+        os << "Name: " << person.mName << "\tAge: "  << person.mAge;
+        return os;
+    }
+
+    // Needed for the deserialization:
+    friend std::istream &operator>>(std::istream &is, Person &person) {
+        std::string tmp;
+        is >> tmp >> person.mName >> tmp >> person.mAge;
+        return is;
+    }
+
+//    // I will sort people by parameters
+//    bool operator<(const Person &personToCompareWith) const {
+//        return mAge < personToCompareWith.mAge;
+//    }
+//
+//    bool operator>(const Person &personToCompareWith) const {
+//        return mAge > personToCompareWith.mAge;
+//    }
+};
+
+/// Ranges whose length is known before walking them can be inserted with a single allocation
+template<typename Iterator, typename = void>
+struct MyIsForwardIterator : std::false_type {};
+
+template<typename Iterator>
+struct MyIsForwardIterator<Iterator, std::void_t<typename std::iterator_traits<Iterator>::iterator_category>>
+        : std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category> {};
+
+/**
+ * @tparam T - type of the elements.
+ * @tparam Alloc - where the memory comes from: MyHeapAllocator (default), MyArenaAllocator, MyPoolAllocator
+ * or anything shaped like a std allocator.
+ * @tparam Growth - how the getCapacity grows once it is too small: MyDoublingGrowth (default), MyOneAndHalfGrowth,
+ * MyPageRoundedGrowth<...>, see MyGrowth.h.
+ */
+template<typename T, typename Alloc = MyHeapAllocator<T>, typename Growth = MyDoublingGrowth>
+class MyVector {
+
+    static_assert(std::is_same<typename Alloc::value_type, T>::value, "Alloc::value_type must be T");
+
+private:
+    T *mData = nullptr; /// main data storage, raw memory where only [0, mSize) holds constructed objects
+    size_t mSize = 0; /// Current getSize
+    size_t mCapacity = 0; /// Current getCapacity
+    Alloc mAllocator; /// Gives and takes back memory blocks
+#if MY_VECTOR_STATS
+    mutable MyVectorCounters mStats; /// What this vector allocated and how long its operations took
+#endif
+
+    /// sort() switches from introsort to radix sort for arithmetic elements at this size
+    static constexpr size_t kRadixSortThreshold = 256;
+
+public:
+    using allocator_type = Alloc;
+
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+    /**
+     * Default constructor, no memory is allocated until the first element arrives
+     */
+    MyVector() = default;
+
+    /**
+     * Creates an empty vector which will take its memory from the given allocator, e.g. an arena.
+     */
+    explicit MyVector(const Alloc &allocator) : mAllocator(allocator) {}
+
+    /**
+     * Enables to construct vector filled with elements using the initializer list
+     * @param initializerList - List of elements we want to push to our vector
+     * @param allocator
+     */
+    MyVector(std::initializer_list<T> initializerList, const Alloc &allocator = Alloc()) : mAllocator(allocator) {
+        appendRange(initializerList.begin(), initializerList.end());
+    }
+
+    /**
+     * Copy constructor, makes exactly one allocation that is just big enough for the elements of myVector.
+     * @param myVector - vector we are copying from.
+     */
+    MyVector(const MyVector<T, Alloc, Growth> &myVector) : MyVector(myVector, myVector.mAllocator) {}
+
+    /**
+     * Copies myVector into memory of the given allocator.
+     */
+    MyVector(const MyVector<T, Alloc, Growth> &myVector, const Alloc &allocator) : mAllocator(allocator) {
+
+        /// Allocate a new block of memory sized to the elements we actually hold:
+        T *newMemBlock = allocateBlock(myVector.mSize);
+
+        /// Copy-construct elements from old block into a new one:
+        copyConstruct(myVector.mData, myVector.mSize, newMemBlock);
+
+        /// Reset mData field to store our new block of memory:
+        mData = newMemBlock;
+
+        /// Set a new getCapacity value
+        mCapacity = myVector.mSize;
+        mSize = myVector.mSize;
+        recordAllocation(0, 0);
+    }
+
+    /**
+     * Move constructor, takes over the buffer of myVector in constant time without allocating.
+     * myVector is left empty and can be reused.
+     * @param myVector - vector we are stealing from.
+     */
+    MyVector(MyVector<T, Alloc, Growth> &&myVector) noexcept
+            : mData(myVector.mData), mSize(myVector.mSize), mCapacity(myVector.mCapacity),
+              mAllocator(std::move(myVector.mAllocator)) {
+        myVector.mData = nullptr;
+        myVector.mSize = 0;
+        myVector.mCapacity = 0;
+    }
+
+    /**
+     * Copy assignment via copy-and-swap: if copying throws, this vector stays untouched.
+     * The copy is made with our own allocator, so a vector never leaves its arena/pool.
+     */
+    MyVector<T, Alloc, Growth> &operator=(const MyVector<T, Alloc, Growth> &anotherVector) {
+        if (this != &anotherVector) {
+            MyVector<T, Alloc, Growth> copy(anotherVector, mAllocator);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    /**
+     * Move assignment, frees our own elements and takes over the buffer of anotherVector.
+     * anotherVector is left empty. If the two allocators don't share memory the buffer can't be taken over,
+     * then the elements are moved one by one into a block of our allocator instead.
+     */
+    MyVector<T, Alloc, Growth> &operator=(MyVector<T, Alloc, Growth> &&anotherVector)
+            noexcept(std::allocator_traits<Alloc>::is_always_equal::value) {
+        if (this != &anotherVector) {
+            if (!std::allocator_traits<Alloc>::is_always_equal::value && !(mAllocator == anotherVector.mAllocator)) {
+                MyVector<T, Alloc, Growth> moved(mAllocator);
+                moved.memAlloc(anotherVector.mSize);
+                std::uninitialized_move(anotherVector.mData, anotherVector.mData + anotherVector.mSize, moved.mData);
+                moved.mSize = anotherVector.mSize;
+                swap(moved);
+                anotherVector.clear();
+                return *this;
+            }
+            release();
+            mData = anotherVector.mData;
+            mSize = anotherVector.mSize;
+            mCapacity = anotherVector.mCapacity;
+            anotherVector.mData = nullptr;
+            anotherVector.mSize = 0;
+            anotherVector.mCapacity = 0;
+        }
+        return *this;
+    }
+
+    ~MyVector() { release(); }
+
+    /**
+     * Exchanges contents of two vectors, only pointers and counters are swapped.
+     * @param anotherVector
+     */
+    void swap(MyVector<T, Alloc, Growth> &anotherVector) noexcept {
+        std::swap(mData, anotherVector.mData);
+        std::swap(mSize, anotherVector.mSize);
+        std::swap(mCapacity, anotherVector.mCapacity);
+        std::swap(mAllocator, anotherVector.mAllocator);
+    }
+
+    friend void swap(MyVector<T, Alloc, Growth> &first, MyVector<T, Alloc, Growth> &second) noexcept { first.swap(second); }
+
+    Alloc getAllocator() const { return mAllocator; }
+
+
+    /* ============================================================================================================  *
+     *                                     MODIFIERS                                                                 |
+     * ============================================================================================================  */
+
+    /**
+     * Increases the getSize by one, adds one element to the end.
+     * If getCapacity is too small it grows it as the Growth policy says (doubles it by default).
+     * @param element - thingy we need to add
+     */
+    void pushBack(const T &element) {
+
+        // When not enough getCapacity we grow it, by default we double it (zero becomes one)
+        if (mCapacity <= mSize) {
+            growBack([&element](T *slot) { new(slot) T(element); });
+            return;
+        }
+        new(mData + mSize) T(element);
+        mSize++;
+    };
+
+    /**
+     * EmplaceBack function takes not the constructor of the object as a parameter [When it comes to some complex
+     * types of objects like structs], it takes the list of arguments needed to build this object in our
+     * memory block IN PLACE.
+     *
+     * With that being said we are saving one move operation, which is not really demanding but still.
+     *
+     * @param args - list of arguments of a variable getSize, thus variadic template is used.
+     * @return object we need.
+     */
+    template<typename... Args>
+    T &emplaceBack(Args &&... args) {
+
+        /*
+         * Exactly the same code as push fun, only last line differs
+         */
+
+        // When not enough getCapacity we grow it, by default we double it (zero becomes one)
+        if (mCapacity <= mSize) {
+            growBack([&args...](T *slot) { new(slot) T(std::forward<Args>(args)...); });
+            return mData[mSize - 1];
+        }
+
+        // Instead of making mData[mSize] equal to object we forward all our
+        // arguments to the constructor, building it right in the raw slot:
+        T *element = new(mData + mSize) T(std::forward<Args>(args)...);
+        mSize++;
+        return *element;
+    };
+
+    /**
+     * Removes the last element of a vector.
+     * Like in a standard vector class, this function doesn't change the getCapacity, only the getSize.
+     */
+    void popBack() {
+        if (mSize > 0) {
+            mSize--;
+            std::destroy_at(mData + mSize);
+        }
+    };
+
+    /**
+     * Removes all elements from the vector.
+     * Capacity stays the same, getSize = 0.
+     */
+    void clear() {
+        std::destroy(mData, mData + mSize);
+        mSize = 0;
+    }
+
+    /**
+      * A request to reduce getCapacity() to getSize().
+      * Slots past getSize() hold no objects, so the only thing to do is moving into a tighter block.
+      */
+    void shrinkToFit() {
+        if (mCapacity > mSize) {
+            memAlloc(mSize);
+        }
+    };
+
+    /**
+     * If the given value of newSize is less than the getSize at present then extra elements are demolished.
+     * If newSize is more than current getSize of container then value-initialized elements are appended at the end
+     * of the vector (zeroes for arithmetic types).
+     * @param newSize
+     */
+    void resize(size_t newSize) {
+        if (newSize <= mSize) {
+            std::destroy(mData + newSize, mData + mSize);
+            mSize = newSize;
+            return;
+        }
+        insertConstructed(mSize, newSize - mSize, [](T *first, size_t count) {
+            std::uninitialized_value_construct(first, first + count);
+        });
+    };
+
+    /**
+     * Same as resize(newSize), but the appended elements are copies of value.
+     * value may be an element of this vector.
+     */
+    void resize(size_t newSize, const T &value) {
+        if (newSize <= mSize) {
+            std::destroy(mData + newSize, mData + mSize);
+            mSize = newSize;
+            return;
+        }
+        insertConstructed(mSize, newSize - mSize, [&value](T *first, size_t count) {
+            std::uninitialized_fill(first, first + count, value);
+        });
+    }
+
+    /**
+     * Replaces the contents with count copies of value. At most one allocation, exactly count elements big.
+     * value may be an element of this vector.
+     */
+    void assign(size_t count, const T &value) {
+        if (count > mCapacity) {
+            MyVector<T, Alloc, Growth> filled(mAllocator);
+            filled.mData = filled.allocateBlock(count);
+            filled.mCapacity = count;
+            std::uninitialized_fill(filled.mData, filled.mData + count, value);
+            filled.mSize = count;
+            size_t oldCapacity = mCapacity;
+            swap(filled);
+            recordAllocation(oldCapacity, 0);
+            return;
+        }
+        size_t overwritten = count < mSize ? count : mSize;
+        std::fill(mData, mData + overwritten, value);
+        if (count > mSize) {
+            std::uninitialized_fill(mData + mSize, mData + count, value);
+        } else {
+            std::destroy(mData + count, mData + mSize);
+        }
+        mSize = count;
+    }
+
+    /**
+     * Appends copies of [first, last). When the length of the range is known up front (forward iterators, pointers)
+     * room is made once and the elements are copied in one go; the range may come from this very vector.
+     * Single-pass input ranges are pushed one by one.
+     */
+    template<typename Iterator>
+    void appendRange(Iterator first, Iterator last) {
+        insert(mSize, first, last);
+    }
+
+    /**
+     * Inserts copies of [first, last) before position, shifting the elements from position on to the right.
+     * At most one allocation. Except when appending, the range must not point into this vector.
+     * @param position - index in [0, getSize()].
+     * @return position of the first inserted element.
+     */
+    template<typename Iterator>
+    size_t insert(size_t position, Iterator first, Iterator last) {
+        if constexpr (MyIsForwardIterator<Iterator>::value) {
+            auto count = static_cast<size_t>(std::distance(first, last));
+            insertConstructed(position, count, [&first, &last](T *destination, size_t) {
+                std::uninitialized_copy(first, last, destination);
+            });
+        } else {
+            MyVector<T, Alloc, Growth> elements(mAllocator);
+            for (; first != last; ++first) {
+                elements.pushBack(*first);
+            }
+            insertConstructed(position, elements.mSize, [&elements](T *destination, size_t count) {
+                std::uninitialized_move(elements.mData, elements.mData + count, destination);
+            });
+        }
+        return position;
+    }
+
+    /**
+     * Removes the elements in [begin, end), the ones after them move left. Capacity stays the same.
+     * @return begin, now the position of the first element that followed the erased ones.
+     */
+    size_t erase(size_t begin, size_t end) {
+        if (end > mSize) {
+            end = mSize;
+        }
+        if (begin >= end) {
+            return begin;
+        }
+        std::move(mData + end, mData + mSize, mData + begin);
+        std::destroy(mData + mSize - (end - begin), mData + mSize);
+        mSize -= end - begin;
+        return begin;
+    }
+
+    /**
+     * Removes the element at position, the ones after it move left.
+     * @return position, now the position of the element that followed it.
+     */
+    size_t eraseAt(size_t position) { return erase(position, position + 1); }
+
+    /**
+     * Removes the element at position in O(1) by moving the last element into its place. The order of the
+     * remaining elements is not kept.
+     */
+    void unorderedErase(size_t position) {
+        if (position >= mSize) {
+            return;
+        }
+        if (position != mSize - 1) {
+            mData[position] = std::move(mData[mSize - 1]);
+        }
+        popBack();
+    }
+
+    /**
+     * Removes every element for which remove(element) is true, the others keep their order. Single pass, each
+     * survivor is moved at most once, see MyCompact.h. Capacity stays the same.
+     *
+     * @param remove - called once per element with a const T &.
+     * @return the number of elements removed.
+     */
+    template<typename Predicate>
+    size_t removeIf(Predicate remove) {
+        size_t newSize = myRemoveIf(mData, mSize, remove);
+        std::destroy(mData + newSize, mData + mSize);
+        size_t removed = mSize - newSize;
+        mSize = newSize;
+        return removed;
+    }
+
+    /* ============================================================================================================  *
+     *                                     ELEMENT ACCESS                                                            |
+     * ============================================================================================================  */
+
+    /**
+     * Allows us to access a certain element of a vector by its position in a container.
+     *
+     * @param position - index of the element we want to access.
+     * @return the actual object we asked for.
+     */
+    T &operator[](size_t position) { return mData[position]; }
+
+    /**
+     * The compiler will pick the const overload only when being called on a const object, otherwise it will
+     * always prefer to use the non-const method.
+     *
+     * @param position - index of the vector's element we want to access.
+     * @return the actual object we asked for.
+     */
+    const T &operator[](size_t position) const { return mData[position]; }
+
+    /**
+     * Same as operator[] allows to access a certain element of a vector by its position.
+     * @param position
+     * @return object at the given position.
+     */
+    T &at(size_t position) { return mData[position]; }
+
+    const T &at(size_t position) const { return mData[position]; }
+
+    /**
+     * @return the elements as a plain array, [data(), data() + getSize()). nullptr while nothing was allocated.
+     */
+    T *data() { return mData; }
+
+    const T *data() const { return mData; }
+
+
+    /* ============================================================================================================  *
+     *                                     CAPACITY                                                                  |
+     * ============================================================================================================  */
+
+    size_t getSize() const { return mSize; } /// Returns private mSize
+
+    size_t getCapacity() const { return mCapacity; } /// Returns private mCapacity
+
+    /**
+     * Makes room for at least capacity elements in one allocation, so that many pushBack() calls afterwards
+     * don't have to reallocate. Never shrinks.
+     */
+    void reserve(size_t capacity) {
+        if (capacity > mCapacity) {
+            memAlloc(capacity);
+        }
+    }
+
+    /* ============================================================================================================  *
+     *                                     SERIALIZATION                                                             |
+     * ============================================================================================================  */
+
+    /**
+     * Serializes the whole container with all its elements into a binary file.
+     *
+     * Trivially copyable elements are written as a MyFileHeader followed by the raw element bytes in one write.
+     * Other types (or MyFileFormat::Text) use the text layout: the number of elements and then, for every
+     * element, the length of its operator<< output followed by that output.
+     *
+     * @param fileName
+     * @param format - MyFileFormat::Text forces the text layout even for trivially copyable types.
+     * @return false if the file couldn't be written.
+     */
+    bool serialize(const std::string &fileName, MyFileFormat format = MyFileFormat::Binary) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Serialize);
+
+        // Opening the binary file by the name:
+        std::ofstream outFileStream(fileName, std::ios::binary);
+
+        if (outFileStream.good()) {
+            writeTo(outFileStream, format, MyCodec::Raw);
+            outFileStream.close();
+        }
+        return !outFileStream.fail();
+    }
+
+    /**
+     * Serializes the container compressed with the given codec (see MyCodecs.h): varint, delta + zigzag or
+     * frame-of-reference for integers, a dictionary for repeated strings or other hashable values.
+     * deserialize() recognizes the codec from the header.
+     * @return false if the codec can't encode T or the file couldn't be written.
+     */
+    bool serialize(const std::string &fileName, MyCodec codec) {
+        if (codec == MyCodec::Raw || !myCodecSupports<T>(codec)) {
+            return codec == MyCodec::Raw && serialize(fileName);
+        }
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Serialize);
+        std::ofstream outFileStream(fileName, std::ios::binary);
+        if (outFileStream.good()) {
+            writeTo(outFileStream, MyFileFormat::Binary, codec);
+            outFileStream.close();
+        }
+        return !outFileStream.fail();
+    }
+
+    /**
+     * Serializes the container as a chunked file (see MyChunkedFile.h): blocks of options.mBlockElements
+     * elements, each with a checksum, encoded in parallel, followed by an index of the blocks. deserialize()
+     * decodes such files in parallel too, and MyChunkedReader reads single elements or ranges out of them.
+     * @return false if the codec can't encode T or the file couldn't be written.
+     */
+    bool serialize(const std::string &fileName, const MyChunkedOptions &options) {
+        if (options.mCodec != MyCodec::Raw && !myCodecSupports<T>(options.mCodec)) {
+            return false;
+        }
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Serialize);
+        std::ofstream outFileStream(fileName, std::ios::binary);
+        if (outFileStream.good()) {
+            myWriteChunked(outFileStream, mData, mSize, options);
+            outFileStream.close();
+        }
+        return !outFileStream.fail();
+    }
+
+    /**
+     * Same file as serialize(), written in the background: one thread encodes the elements into one buffer while
+     * another writes the other buffer to disk (see MyAsyncFile.h). By default the file is written under a
+     * temporary name, fsync'ed and renamed into place, so readers never see half a file.
+     *
+     * The vector must not be modified or destroyed until the future is ready.
+     * @return future of the outcome: which step failed and with what errno, if any.
+     */
+    std::future<MyIoStatus> serializeAsync(const std::string &fileName,
+                                           const MyAsyncWriteOptions &options = MyAsyncWriteOptions()) const {
+        return std::async(std::launch::async, [this, fileName, options] {
+            [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Serialize);
+            if (options.mCodec != MyCodec::Raw && !myCodecSupports<T>(options.mCodec)) {
+                return MyIoStatus{MyIoError::Encode, EINVAL};
+            }
+            MyDoubleBufferedFile file;
+            MyIoStatus status = file.open(fileName, options);
+            if (!status) {
+                return status;
+            }
+            std::ostream outStream(&file);
+            writeTo(outStream, options.mFormat, options.mCodec);
+            bool encoded = static_cast<bool>(outStream.flush());
+            status = file.close(encoded);
+            return encoded || !status ? status : MyIoStatus{MyIoError::Write, EIO};
+        });
+    }
+
+    /**
+     * Deserializes the container from a binary file, elements are appended to the ones we already have.
+     *
+     * Binary files are loaded with a single allocation and a single read, text files reserve room for all their
+     * elements before parsing them. Chunked files are read and decoded a block per thread. Files whose header
+     * doesn't match T (different element size, kind or version) are rejected without touching the vector.
+     *
+     * @param fileName
+     * @param policy - threads decoding the blocks of a chunked file, the other layouts are read serially.
+     * @return false if the file couldn't be opened, is truncated, fails a checksum or holds another element type.
+     */
+    bool deserialize(const std::string &fileName, const MyParallelPolicy &policy = MyParallelPolicy()) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Serialize);
+        std::ifstream inputFileStream(fileName, std::ios::binary);
+        if (!inputFileStream) {
+            return false;
+        }
+
+        MyFileHeader header{};
+        inputFileStream.read((char *) &header, sizeof(header.mMagic));
+        if (!inputFileStream) {
+            return false;
+        }
+
+        if (header.hasMagic()) {
+            inputFileStream.read((char *) &header + sizeof(header.mMagic), sizeof(header) - sizeof(header.mMagic));
+            if (inputFileStream && header.isChunked()) {
+                return header.template matchesChunked<T>() && readChunked(fileName, policy);
+            }
+            if (header.mCodec != 0) {
+                return inputFileStream && header.template matchesEncoded<T>() && readEncoded(inputFileStream, header);
+            }
+            if constexpr (std::is_trivially_copyable<T>::value) {
+                bool swapped = header.template matchesSwapped<T>();
+                if (!inputFileStream || !(header.template matches<T>() || swapped)
+                    || myRemainingBytes(inputFileStream) / sizeof(T) < header.mElementCount) {
+                    return false;
+                }
+                size_t numberOfElements = header.mElementCount;
+                reserve(mSize + numberOfElements);
+                inputFileStream.read((char *) (mData + mSize),
+                                     static_cast<std::streamsize>(numberOfElements * sizeof(T)));
+                if (!inputFileStream) {
+                    return false;
+                }
+                if (swapped) {
+                    myByteSwap(mData + mSize, numberOfElements);
+                }
+                mSize += numberOfElements;
+                return true;
+            } else {
+                return false;
+            }
+        }
+
+        // No header: text layout, the 8 bytes we've just read are the number of elements.
+        size_t numberOfElements;
+        std::memcpy(&numberOfElements, header.mMagic, sizeof(numberOfElements));
+
+        return myReadTextElements<T>(inputFileStream, numberOfElements,
+                                     [this](size_t count) { reserve(mSize + count); },
+                                     [this](T &element) { emplaceBack(std::move(element)); });
+    }
+
+
+
+    /* ============================================================================================================  *
+     *                                     FIND/SORT                                                                 |
+     * ============================================================================================================  */
+
+    /**
+     * Arithmetic elements are compared with SSE2/AVX2 when the CPU has them.
+     * @param element
+     * @return position of the requested element, npos if it isn't there.
+     */
+    size_t find(const T &element) const {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Find);
+        return myFind(mData, mSize, element);
+    }
+
+    /**
+     * @param begin start of a search zone.
+     * @param end end of a search zone.
+     * @param element
+     * @return position of the requested element, npos if it isn't there or the zone is invalid.
+     */
+    size_t find(size_t begin, size_t end, const T &element) const {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Find);
+        if (begin < end && end <= mSize) {
+            size_t position = myFind(mData + begin, end - begin, element);
+            return position == npos ? npos : begin + position;
+        }
+        return npos;
+    }
+
+    /**
+     * @param element
+     * @return how many elements are equal to the given one.
+     */
+    size_t count(const T &element) const {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Find);
+        return myCount(mData, mSize, element);
+    }
+
+    /**
+     * @param element
+     * @return true if at least one element is equal to the given one.
+     */
+    bool contains(const T &element) const { return find(element) != npos; }
+
+    /**
+     * Sorts vector of complex structures by the given comparator, in O(n log n) (introsort).
+     * Afterwards compare(later, earlier) is false for every pair; equal elements may change their order.
+     * @tparam Compare Class name of our comparator
+     * @param compare
+     */
+    template<typename Compare>
+    void sort(Compare compare) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        myIntroSort(mData, mData + mSize, compare);
+    }
+
+    /**
+     * Same as sort(compare), but large inputs are split between threads which sort their chunks and then merge.
+     * @param policy - thread count and how many elements a thread needs before it is worth starting.
+     */
+    template<typename Compare>
+    void sort(Compare compare, const MyParallelPolicy &policy) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        myParallelMergeSort(mData, mData + mSize, compare, policy);
+    }
+
+    /**
+     * Simple sort function: largest element first, using operator< of the elements.
+     * Integral and floating point elements are radix sorted once there are enough of them (long double isn't).
+     */
+    void sort() {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        if constexpr (IsRadixSortable<T>::value) {
+            if (mSize >= kRadixSortThreshold) {
+                myRadixSort(mData, mData + mSize, true);
+                return;
+            }
+        }
+        myIntroSort(mData, mData + mSize, [](const T &first, const T &second) { return second < first; });
+    }
+
+    /**
+     * LSD radix sort of integral or floating point elements, O(n) for a fixed element width.
+     * @param descending - largest first when true.
+     */
+    void radixSort(bool descending = false) {
+        static_assert(IsRadixSortable<T>::value, "radixSort() needs integral or floating point elements of 1-8 bytes");
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        myRadixSort(mData, mData + mSize, descending);
+    }
+
+    /**
+     * Stable radix sort of records by an integral or floating point key, e.g. people by age:
+     *      people.radixSort([](const Person &person) { return person.getAge(); });
+     * Every key is extracted once, then the records are moved into place in one pass.
+     * @param keyOf - callable returning the key of an element.
+     * @param descending - largest key first when true.
+     */
+    template<typename KeyOf>
+    void radixSort(KeyOf keyOf, bool descending = false) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        myRadixSortByKey(mData, mData + mSize, keyOf, descending);
+    }
+
+    /**
+     * Stable sort by any comparable projection of the elements, e.g. people by name:
+     *      people.sortBy([](const Person &person) { return person.getName(); });
+     * Unlike sort(compare) every key is extracted once, not twice per comparison: (key, position) pairs are sorted
+     * and the elements moved into place in one pass. Worth it when the key is computed or returned by value.
+     * Integral and floating point keys in ascending or descending order go through radixSort(keyOf) instead.
+     * @param keyOf - callable returning the key of an element.
+     * @param compare - ordering of the keys, ascending by default.
+     */
+    template<typename KeyOf, typename Compare = std::less<>>
+    void sortBy(KeyOf keyOf, Compare compare = Compare()) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        using Key = std::decay_t<decltype(keyOf(std::declval<const T &>()))>;
+        if constexpr (IsRadixSortable<Key>::value && std::is_same<Compare, std::less<>>::value) {
+            myRadixSortByKey(mData, mData + mSize, keyOf, false);
+        } else if constexpr (IsRadixSortable<Key>::value && std::is_same<Compare, std::greater<>>::value) {
+            myRadixSortByKey(mData, mData + mSize, keyOf, true);
+        } else {
+            myPartialSortByKey(mData, mData + mSize, mData + mSize, keyOf, compare);
+        }
+    }
+
+    /**
+     * Sorts only the first k elements of what sort(compare) would give, through a heap of k elements: O(n log k).
+     * The remaining elements follow in no particular order.
+     * @param k - how many elements to sort to the front, all of them if larger than the size.
+     */
+    template<typename Compare>
+    void partialSort(size_t k, Compare compare) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        myPartialSort(mData, mData + std::min(k, mSize), mData + mSize, compare);
+    }
+
+    /**
+     * Ranking query: the k elements with the largest keys go to the front, largest first, ties in their original
+     * order; the rest follow in no particular order. Keys are extracted once, selection costs O(n log k).
+     *      people.topK(100, [](const Person &person) { return person.getAge(); });
+     * @param keyOf - callable returning the key of an element.
+     * @param compare - ordering of the keys; the k greatest in this order are taken.
+     */
+    template<typename KeyOf, typename Compare = std::less<>>
+    void topK(size_t k, KeyOf keyOf, Compare compare = Compare()) {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        auto greater = [&compare](const auto &first, const auto &second) { return compare(second, first); };
+        myPartialSortByKey(mData, mData + std::min(k, mSize), mData + mSize, keyOf, greater);
+    }
+
+    /**
+     * Puts at position n the element sort(compare) would put there; nothing before it compares greater and nothing
+     * after it compares less. O(n) on average, e.g. the median without sorting.
+     * @param n - position to fix, nothing happens if it is past the end.
+     */
+    template<typename Compare>
+    void nthElement(size_t n, Compare compare) {
+        if (n >= mSize) {
+            return;
+        }
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Sort);
+        myNthElement(mData, mData + n, mData + mSize, compare);
+    }
+
+    /**
+     * @return true if compare(later, earlier) is false for every pair, i.e. sort(compare) would not change the order.
+     */
+    template<typename Compare>
+    bool isSorted(Compare compare) const { return myIsSorted(mData, mData + mSize, compare); }
+
+    /**
+     * @return true if the elements are in the order sort() leaves them: largest first.
+     */
+    bool isSorted() const {
+        return isSorted([](const T &first, const T &second) { return second < first; });
+    }
+
+    /**
+     * Binary search in a vector sorted by compare.
+     * @return position of the first element not ordered before value, getSize() if there is none.
+     */
+    template<typename Compare>
+    size_t lowerBound(const T &value, Compare compare) const {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Find);
+        return static_cast<size_t>(std::lower_bound(mData, mData + mSize, value, compare) - mData);
+    }
+
+    /**
+     * Same as lowerBound(value, compare) for a vector sorted with sortBy(keyOf, compare), looking for a key.
+     */
+    template<typename Key, typename KeyOf, typename Compare = std::less<>>
+    size_t lowerBoundBy(const Key &key, KeyOf keyOf, Compare compare = Compare()) const {
+        [[maybe_unused]] auto timer = startTimer(MyVectorOperation::Find);
+        auto before = [&keyOf, &compare](const T &element, const Key &value) { return compare(keyOf(element), value); };
+        return static_cast<size_t>(std::lower_bound(mData, mData + mSize, key, before) - mData);
+    }
+
+    /**
+     * Binary search in a vector sorted by compare, O(log n) instead of find()'s scan.
+     * @return position of the first element equivalent to value, npos if there is none.
+     */
+    template<typename Compare>
+    size_t binarySearch(const T &value, Compare compare) const {
+        size_t position = lowerBound(value, compare);
+        return position < mSize && !compare(value, mData[position]) ? position : npos;
+    }
+
+    /**
+     * Same as binarySearch(value, compare) for a vector sorted with sortBy(keyOf, compare), looking for a key.
+     */
+    template<typename Key, typename KeyOf, typename Compare = std::less<>>
+    size_t binarySearchBy(const Key &key, KeyOf keyOf, Compare compare = Compare()) const {
+        size_t position = lowerBoundBy(key, keyOf, compare);
+        return position < mSize && !compare(key, keyOf(mData[position])) ? position : npos;
+    }
+
+    /* ============================================================================================================  *
+     *                                     PARALLEL ALGORITHMS                                                       |
+     * ============================================================================================================  */
+
+    /*
+     * The buffer is split into contiguous chunks that run on a work-stealing thread pool (see MyThreadPool.h).
+     * Inputs too small for the policy run serially on the calling thread. The callables are invoked concurrently
+     * from several threads, so they must not share unsynchronized state. The first exception thrown is rethrown
+     * once all chunks are done.
+     */
+
+    /**
+     * Calls function(element) for every element, in no particular order.
+     * @param function - may modify the element it gets.
+     * @param policy - thread count, pool and how many elements a thread needs before it is worth using.
+     */
+    template<typename Function>
+    void forEach(Function function, const MyParallelPolicy &policy = MyParallelPolicy()) {
+        T *data = mData;
+        myParallelChunks(mSize, myChunkCount(mSize, policy), policy,
+                         [data, &function](size_t, size_t begin, size_t end) {
+                             for (size_t i = begin; i < end; i++) {
+                                 function(data[i]);
+                             }
+                         });
+    }
+
+    /**
+     * Replaces every element with function(element).
+     */
+    template<typename Function>
+    void transform(Function function, const MyParallelPolicy &policy = MyParallelPolicy()) {
+        T *data = mData;
+        myParallelChunks(mSize, myChunkCount(mSize, policy), policy,
+                         [data, &function](size_t, size_t begin, size_t end) {
+                             for (size_t i = begin; i < end; i++) {
+                                 data[i] = function(data[i]);
+                             }
+                         });
+    }
+
+    /**
+     * Folds all elements into init with operation, e.g. a sum:
+     *      numbers.reduce(0L, [](long sum, long number) { return sum + number; });
+     * Every chunk is folded on its own and the chunk results are then combined left to right, so operation must be
+     * associative but need not be commutative.
+     * @param init - starting value, used once.
+     * @param operation - T(const T &, const T &).
+     */
+    template<typename BinaryOperation>
+    T reduce(T init, BinaryOperation operation, const MyParallelPolicy &policy = MyParallelPolicy()) {
+        size_t chunkCount = myChunkCount(mSize, policy);
+        std::unique_ptr<std::optional<T>[]> partials(new std::optional<T>[chunkCount]);
+        const T *data = mData;
+        myParallelChunks(mSize, chunkCount, policy,
+                         [data, &operation, &partials](size_t chunk, size_t begin, size_t end) {
+                             T partial = data[begin];
+                             for (size_t i = begin + 1; i < end; i++) {
+                                 partial = operation(partial, data[i]);
+                             }
+                             partials[chunk] = std::move(partial);
+                         });
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            if (partials[chunk]) {
+                init = operation(init, *partials[chunk]);
+            }
+        }
+        return init;
+    }
+
+    /**
+     * @param predicate - bool(const T &).
+     * @return how many elements satisfy the predicate.
+     */
+    template<typename Predicate>
+    size_t countIf(Predicate predicate, const MyParallelPolicy &policy = MyParallelPolicy()) {
+        size_t chunkCount = myChunkCount(mSize, policy);
+        std::unique_ptr<size_t[]> counts(new size_t[chunkCount]());
+        const T *data = mData;
+        myParallelChunks(mSize, chunkCount, policy,
+                         [data, &predicate, &counts](size_t chunk, size_t begin, size_t end) {
+                             size_t matches = 0;
+                             for (size_t i = begin; i < end; i++) {
+                                 matches += predicate(data[i]) ? 1 : 0;
+                             }
+                             counts[chunk] = matches;
+                         });
+        size_t total = 0;
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            total += counts[chunk];
+        }
+        return total;
+    }
+
+#if MY_VECTOR_STATS
+    /* ============================================================================================================  *
+     *                                     STATS                                                                     |
+     * ============================================================================================================  */
+
+    /**
+     * Counters of this vector since it was created (copies start from zero), see MyVectorStats.h.
+     * mWastedBytes is the capacity currently holding no element.
+     */
+    MyVectorStats getStats() const {
+        MyVectorStats stats = mStats.snapshot();
+        stats.mWastedBytes = (mCapacity - mSize) * sizeof(T);
+        return stats;
+    }
+#endif
+
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+
+private:
+    /**
+     * Contiguous iterator: a thin wrapper around a pointer with the full random-access interface, so the std
+     * algorithms (sort, lower_bound, the parallel ones) take it and compile it down to pointer loops.
+     * @tparam Const - iterates over const T, what the const begin()/end() and cbegin()/cend() return.
+     */
+    template<bool Const>
+    class MyIterator {
+        using Pointer = typename std::conditional<Const, const T *, T *>::type;
+        using Reference = typename std::conditional<Const, const T &, T &>::type;
+
+        Pointer mIteratorPointer = nullptr; // Pointer to current position of our iterator
+    public:
+        // Lets the std algorithms (and appendRange/insert) know what they are dealing with:
+        using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus > 201703L
+        using iterator_concept = std::contiguous_iterator_tag;
+#endif
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Pointer;
+        using reference = Reference;
+
+        MyIterator() = default;
+
+        explicit MyIterator(Pointer ptr) { mIteratorPointer = ptr; }
+
+        // Every iterator converts to a const one:
+        template<bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+        MyIterator(const MyIterator<OtherConst> &iterator) : mIteratorPointer(iterator.operator->()) {}
+
+        // Pre increment:
+        MyIterator &operator++() noexcept {
+            mIteratorPointer++;
+            return *this;
+        }
+
+        // Post increment:
+        MyIterator operator++(int) {
+            MyIterator iterator = *this;
+            ++(*this);
+            return iterator;
+        }
+
+        MyIterator &operator--() {
+            mIteratorPointer--;
+            return *this;
+        }
+
+        MyIterator operator--(int) {
+            MyIterator iterator = *this;
+            --(*this);
+            return iterator;
+        }
+
+        MyIterator &operator+=(difference_type offset) {
+            mIteratorPointer += offset;
+            return *this;
+        }
+
+        MyIterator &operator-=(difference_type offset) {
+            mIteratorPointer -= offset;
+            return *this;
+        }
+
+        friend MyIterator operator+(MyIterator iterator, difference_type offset) { return iterator += offset; }
+
+        friend MyIterator operator+(difference_type offset, MyIterator iterator) { return iterator += offset; }
+
+        friend MyIterator operator-(MyIterator iterator, difference_type offset) { return iterator -= offset; }
+
+        friend difference_type operator-(const MyIterator &first, const MyIterator &second) {
+            return first.mIteratorPointer - second.mIteratorPointer;
+        }
+
+        Pointer operator->() const { return mIteratorPointer; }
+
+        Reference operator*() const { return *mIteratorPointer; }
+
+        Reference operator[](difference_type offset) const { return mIteratorPointer[offset]; }
+
+        friend bool operator==(const MyIterator &first, const MyIterator &second) {
+            return first.mIteratorPointer == second.mIteratorPointer;
+        }
+
+        friend bool operator!=(const MyIterator &first, const MyIterator &second) {
+            return first.mIteratorPointer != second.mIteratorPointer;
+        }
+
+        friend bool operator<(const MyIterator &first, const MyIterator &second) {
+            return first.mIteratorPointer < second.mIteratorPointer;
+        }
+
+        friend bool operator>(const MyIterator &first, const MyIterator &second) { return second < first; }
+
+        friend bool operator<=(const MyIterator &first, const MyIterator &second) { return !(second < first); }
+
+        friend bool operator>=(const MyIterator &first, const MyIterator &second) { return !(first < second); }
+    };
+
+
+public:
+    using iterator = MyIterator<false>;
+    using const_iterator = MyIterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    iterator begin() {
+        return iterator(mData); // Points at the 0th obj of the collection
+    }
+
+    iterator end() {
+        return iterator(mData + mSize); // Points right past the last byte of memory we own
+    }
+
+    const_iterator begin() const { return const_iterator(mData); }
+
+    const_iterator end() const { return const_iterator(mData + mSize); }
+
+    const_iterator cbegin() const { return begin(); }
+
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    const_reverse_iterator crbegin() const { return rbegin(); }
+
+    const_reverse_iterator crend() const { return rend(); }
+
+    /* ============================================================================================================  *
+     *                                     UTIL                                                                      |
+     * ============================================================================================================  */
+
+private:
+    /**
+    * Memory allocation function, algorithm:
+     *
+    *      1. Allocate a new raw memory block with a required getCapacity (nothing is constructed in it).
+    *      2. Move-construct live elements from old block into a new one and destroy the originals.
+    *      3. Release the old block and reload mData.
+    *      4. Set a new getCapacity value.
+     *
+     * For trivially relocatable T steps 1-3 collapse into a single allocator reallocate() (realloc for the default
+     * heap allocator), and arena/pool allocators can skip them altogether by growing the block in place.
+    * @param requiredCapacity - new getCapacity, must not be smaller than getSize().
+    */
+    void memAlloc(size_t requiredCapacity) {
+        size_t oldCapacity = mCapacity;
+        if (requiredCapacity == 0) {
+            release();
+            mData = nullptr;
+            mCapacity = 0;
+            return;
+        }
+
+        /// Arena/pool allocators may be able to grow the block right where it is:
+        if constexpr (HasTryExpand<Alloc>::value) {
+            if (mData != nullptr && requiredCapacity > mCapacity
+                && mAllocator.tryExpand(mData, mCapacity, requiredCapacity)) {
+                mCapacity = requiredCapacity;
+                recordAllocation(oldCapacity, 0);
+                return;
+            }
+        }
+
+        if constexpr (IsTriviallyRelocatable<T>::value && HasReallocate<Alloc>::value) {
+            /// Let the allocator grow the block (realloc for the default one), copying bytes only if it has to:
+            mData = mData == nullptr ? mAllocator.allocate(requiredCapacity)
+                                     : mAllocator.reallocate(mData, mCapacity, requiredCapacity);
+        } else {
+            /// Allocate a new block of memory with a new getCapacity:
+            T *newMemBlock = mAllocator.allocate(requiredCapacity);
+
+            /// Move elements from old block to a new one, the originals are destroyed right after:
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                if (mSize > 0) {
+                    std::memcpy(static_cast<void *>(newMemBlock), static_cast<const void *>(mData), mSize * sizeof(T));
+                }
+            } else {
+                try {
+                    std::uninitialized_move(mData, mData + mSize, newMemBlock);
+                } catch (...) {
+                    mAllocator.deallocate(newMemBlock, requiredCapacity);
+                    throw;
+                }
+                std::destroy(mData, mData + mSize);
+            }
+            if (mData != nullptr) {
+                mAllocator.deallocate(mData, mCapacity);
+            }
+
+            /// Reset mData field to store our new block of memory:
+            mData = newMemBlock;
+        }
+
+        /// Set a new getCapacity value
+        mCapacity = requiredCapacity;
+        recordAllocation(oldCapacity, mSize * sizeof(T));
+    }
+
+    /**
+     * Grows a full block by the Growth policy and appends the element construct(T *slot) builds. The source of the
+     * new element may be one of ours (v.pushBack(v[0])), so it is built before the old block goes away: trivially
+     * copyable elements are copied aside and the block reallocated, anything else is built in the new block first.
+     */
+    template<typename Construct>
+    void growBack(Construct construct) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            alignas(T) unsigned char element[sizeof(T)];
+            construct(reinterpret_cast<T *>(element));
+            memAlloc(grownCapacity(mSize + 1));
+            std::memcpy(static_cast<void *>(mData + mSize), element, sizeof(T));
+            mSize++;
+        } else {
+            insertConstructed(mSize, 1, [&construct](T *slot, size_t) { construct(slot); });
+        }
+    }
+
+    /**
+     * Opens a gap of count raw slots at position and lets construct(T *gap, size_t count) build the new elements
+     * in it; construct has to clean up after itself if it throws.
+     *
+     * If the elements don't fit and the allocator can't grow the block in place, one new block is allocated (grown
+     * by the Growth policy, so repeated inserts stay amortized O(1)), the gap is filled first - while the old
+     * elements are still in place, so they may be the source - and only then are the old elements moved around it.
+     * Otherwise the tail is shifted right in place: one memmove for trivially relocatable T.
+     */
+    template<typename Construct>
+    void insertConstructed(size_t position, size_t count, Construct construct) {
+        if (count == 0) {
+            return;
+        }
+        if (mSize + count > mCapacity) {
+            size_t newCapacity = grownCapacity(mSize + count);
+            if constexpr (HasTryExpand<Alloc>::value) {
+                if (mData != nullptr && mAllocator.tryExpand(mData, mCapacity, newCapacity)) {
+                    size_t oldCapacity = mCapacity;
+                    mCapacity = newCapacity;
+                    recordAllocation(oldCapacity, 0);
+                }
+            }
+        }
+        if (mSize + count > mCapacity) {
+            size_t newCapacity = grownCapacity(mSize + count);
+            T *newMemBlock = mAllocator.allocate(newCapacity);
+            try {
+                construct(newMemBlock + position, count);
+            } catch (...) {
+                mAllocator.deallocate(newMemBlock, newCapacity);
+                throw;
+            }
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                if (mSize > 0) {
+                    std::memcpy(static_cast<void *>(newMemBlock), static_cast<const void *>(mData),
+                                position * sizeof(T));
+                    std::memcpy(static_cast<void *>(newMemBlock + position + count),
+                                static_cast<const void *>(mData + position), (mSize - position) * sizeof(T));
+                }
+            } else {
+                try {
+                    std::uninitialized_move(mData, mData + position, newMemBlock);
+                    try {
+                        std::uninitialized_move(mData + position, mData + mSize, newMemBlock + position + count);
+                    } catch (...) {
+                        std::destroy(newMemBlock, newMemBlock + position);
+                        throw;
+                    }
+                } catch (...) {
+                    std::destroy(newMemBlock + position, newMemBlock + position + count);
+                    mAllocator.deallocate(newMemBlock, newCapacity);
+                    throw;
+                }
+                std::destroy(mData, mData + mSize);
+            }
+            if (mData != nullptr) {
+                mAllocator.deallocate(mData, mCapacity);
+            }
+            size_t oldCapacity = mCapacity;
+            mData = newMemBlock;
+            mCapacity = newCapacity;
+            recordAllocation(oldCapacity, mSize * sizeof(T));
+            mSize += count;
+            return;
+        }
+
+        size_t tail = mSize - position;
+        if (tail == 0) {
+            construct(mData + mSize, count);
+            mSize += count;
+        } else if constexpr (IsTriviallyRelocatable<T>::value) {
+            // Shift the tail as raw bytes, the gap is raw memory afterwards
+            std::memmove(static_cast<void *>(mData + position + count), static_cast<const void *>(mData + position),
+                         tail * sizeof(T));
+            try {
+                construct(mData + position, count);
+            } catch (...) {
+                std::memmove(static_cast<void *>(mData + position), static_cast<const void *>(mData + position + count),
+                             tail * sizeof(T));
+                throw;
+            }
+            mSize += count;
+        } else {
+            // Build the new elements aside (the only allocation), then rotate them into place with moves only
+            MyVector<T, Alloc, Growth> inserted(mAllocator);
+            inserted.mData = inserted.allocateBlock(count);
+            inserted.mCapacity = count;
+            construct(inserted.mData, count);
+            inserted.mSize = count;
+
+            std::uninitialized_move(inserted.mData, inserted.mData + count, mData + mSize);
+            mSize += count;
+            std::rotate(mData + position, mData + mSize - count, mData + mSize);
+        }
+    }
+
+    /**
+     * Writes the file contents of serialize(): binary or text layout, or the given codec.
+     */
+    void writeTo(std::ostream &outStream, MyFileFormat format, MyCodec codec) const {
+        if (codec != MyCodec::Raw) {
+            MyFileHeader header = MyFileHeader::describe<T>(mSize);
+            header.mCodec = static_cast<uint8_t>(codec);
+            outStream.write((char *) &header, sizeof(header));
+            myEncode(outStream, codec, mData, mSize);
+            return;
+        }
+
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (format == MyFileFormat::Binary) {
+                MyFileHeader header = MyFileHeader::describe<T>(mSize);
+                outStream.write((char *) &header, sizeof(header));
+                outStream.write((char *) mData, static_cast<std::streamsize>(mSize * sizeof(T)));
+                return;
+            }
+        }
+
+        // Firstly, write the number of elements in our vector:
+        outStream.write((char *) &mSize, sizeof(mSize));
+
+        for (size_t i = 0; i < mSize; i++) {
+            myWriteTextElement(outStream, mData[i]);
+        }
+    }
+
+    /**
+     * Appends the elements of an encoded file, the stream is right past its header.
+     */
+    bool readEncoded(std::istream &inStream, const MyFileHeader &header) {
+        // Every block takes at least its length prefix, a bigger count can only come from a corrupted file
+        uint64_t blocks = (header.mElementCount + kMyCodecBlockSize - 1) / kMyCodecBlockSize;
+        if (myRemainingBytes(inStream) / sizeof(uint32_t) < blocks) {
+            return false;
+        }
+        reserve(mSize + header.mElementCount);
+        return myDecode<T>(inStream, static_cast<MyCodec>(header.mCodec), header.mElementCount,
+                           [this](const T *elements, size_t count) { appendRange(elements, elements + count); });
+    }
+
+    /**
+     * Appends the elements of a chunked file. Raw blocks are read straight into our buffer, the others are decoded
+     * a few blocks per thread at a time and then moved over in order (myReadChunkedRange). Nothing is appended if
+     * any block fails.
+     */
+    bool readChunked(const std::string &fileName, const MyParallelPolicy &policy) {
+        MyChunkedFile file;
+        if (!file.open(fileName) || !file.getHeader().template matchesChunked<T>()) {
+            return false;
+        }
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (file.getCodec() == MyCodec::Raw) {
+                size_t blockCount = file.getBlockCount();
+                for (size_t block = 0; block < blockCount; block++) {
+                    if (file.getBlockBytes(block) != file.blockSize(block) * sizeof(T)) {
+                        return false;
+                    }
+                }
+                reserve(mSize + file.getElementCount());
+                size_t chunkCount = myChunkCount(file.getElementCount(), policy);
+                std::atomic<bool> ok{true};
+                myParallelChunks(blockCount, chunkCount < blockCount ? chunkCount : blockCount, policy,
+                                 [&](size_t, size_t begin, size_t end) {
+                                     for (size_t block = begin; block < end && ok; block++) {
+                                         T *destination = mData + mSize + file.blockFirst(block);
+                                         if (!file.readBlock(block, (char *) destination)) {
+                                             ok = false;
+                                         }
+                                     }
+                                 });
+                if (ok) {
+                    mSize += file.getElementCount();
+                }
+                return ok;
+            }
+        }
+        return myReadChunkedRange<T>(file, 0, file.getElementCount(), *this, policy);
+    }
+
+    /**
+     * @return getCapacity to grow to so that at least required elements fit, as the Growth policy says.
+     */
+    size_t grownCapacity(size_t required) const { return Growth::nextCapacity(mCapacity, required, sizeof(T)); }
+
+    /**
+     * Gets uninitialized memory for the given number of elements.
+     */
+    T *allocateBlock(size_t capacity) { return capacity == 0 ? nullptr : mAllocator.allocate(capacity); }
+
+    /**
+     * Copy-constructs count elements into raw memory, giving the block back if one of the copies throws.
+     */
+    void copyConstruct(const T *source, size_t count, T *memBlock) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (count > 0) {
+                std::memcpy(static_cast<void *>(memBlock), static_cast<const void *>(source), count * sizeof(T));
+            }
+        } else {
+            try {
+                std::uninitialized_copy(source, source + count, memBlock);
+            } catch (...) {
+                if (memBlock != nullptr) {
+                    mAllocator.deallocate(memBlock, count);
+                }
+                throw;
+            }
+        }
+    }
+
+    /**
+     * Destroys every live element exactly once and frees the storage.
+     */
+    void release() {
+        std::destroy(mData, mData + mSize);
+        if (mData != nullptr) {
+            mAllocator.deallocate(mData, mCapacity);
+#if MY_VECTOR_STATS
+            myRecordRelease<T>(mStats, this, mSize, mCapacity);
+#endif
+        }
+    }
+
+    /**
+     * Counts a block change that left us with mCapacity elements, when built with MY_VECTOR_STATS.
+     * @param bytesMoved - element bytes relocated to get there.
+     */
+    void recordAllocation(size_t oldCapacity, size_t bytesMoved) const {
+#if MY_VECTOR_STATS
+        if (mCapacity > 0) {
+            myRecordAllocation<T>(mStats, this, mSize, oldCapacity, mCapacity, bytesMoved);
+        }
+#else
+        (void) oldCapacity;
+        (void) bytesMoved;
+#endif
+    }
+
+    /**
+     * @return an object measuring the given operation until it goes out of scope; an empty one without
+     * MY_VECTOR_STATS.
+     */
+    auto startTimer(MyVectorOperation operation) const {
+#if MY_VECTOR_STATS
+        return MyOperationTimer<T>(mStats, this, operation, mSize);
+#else
+        (void) operation;
+        return MyNoOperationTimer();
+#endif
+    }
+
+public:
+
+
+    void print() {
+        try {
+            for (size_t i = 0; i < mSize; i++) {
+                std::cout << mData[i] << "; ";
+            }
+            std::cout << std::endl;
+        } catch (std::exception e) {
+            std::cout << "Ooops " << e.what() << std::endl;
+        }
+    }
+
+
+};
+
+// Packed MyVector<bool> specialization
+#include "MyBoolVector.h"
+
+#endif //VECTOR_MYVECTOR_H
+
@@ -0,0 +1,181 @@
+//
+// Streaming reader for vector files written by MyVector::serialize.
+//
+// Walks the file in fixed-size batches through one reused buffer, so memory stays bounded by the batch size no matter
+// how large the file is. Both the binary and the text layout are supported.
+//
+// Pull style:                                          Callback style:
+//
+//      MyVectorReader<int> reader("ids.bin");              MyVectorReader<int> reader("ids.bin");
+//      while (reader.next()) {                             reader.forEachBatch([](const int *batch, size_t count) {
+//          use(reader.data(), reader.count());                 use(batch, count);
+//      }                                                   });
+//
+
+#ifndef VECTOR_MYVECTORREADER_H
+#define VECTOR_MYVECTORREADER_H
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include "MyAllocators.h"
+#include "MySerialization.h"
+#include "MyVector.h"
+
+template<typename T>
+class MyVectorReader {
+
+private:
+    /// Binary batches are read straight into raw memory, that is only allowed for trivially copyable elements
+    static constexpr bool kCanReadRaw = std::is_trivially_copyable<T>::value;
+
+    std::ifstream mInputFileStream; /// File we are walking through
+    size_t mBatchSize; /// Maximal number of elements per batch
+    size_t mTotal = 0; /// Number of elements the file holds
+    size_t mConsumed = 0; /// Elements handed out so far, including the current batch
+    bool mBinary = false; /// Which layout the file uses
+    bool mSwapBytes = false; /// Binary file written with the other byte order
+    bool mOpen = false; /// File opened and its header accepted
+
+    T *mRawBatch = nullptr; /// Binary layout: buffer for mBatchSize elements
+    size_t mRawCount = 0; /// Binary layout: elements in the current batch
+    MyVector<T> mBatch; /// Text layout: parsed elements of the current batch, cleared and refilled each time
+    std::string mScratch; /// Text layout: raw text of one element
+
+public:
+    /**
+     * Opens the file and reads its header, check isOpen() to see if it worked.
+     * @param fileName
+     * @param batchSize - number of elements per batch, the only thing that decides memory use.
+     */
+    explicit MyVectorReader(const std::string &fileName, size_t batchSize = 64 * 1024)
+            : mInputFileStream(fileName, std::ios::binary), mBatchSize(batchSize > 0 ? batchSize : 1) {
+        if (!mInputFileStream) {
+            return;
+        }
+
+        MyFileHeader header{};
+        mInputFileStream.read((char *) &header, sizeof(header.mMagic));
+        if (!mInputFileStream) {
+            return;
+        }
+
+        if (header.hasMagic()) {
+            mInputFileStream.read((char *) &header + sizeof(header.mMagic), sizeof(header) - sizeof(header.mMagic));
+            if constexpr (kCanReadRaw) {
+                mSwapBytes = header.template matchesSwapped<T>();
+                if (!mInputFileStream || !(header.template matches<T>() || mSwapBytes)) {
+                    return;
+                }
+                mBinary = true;
+                mTotal = header.mElementCount;
+                mRawBatch = MyHeapAllocator<T>().allocate(mBatchSize);
+            } else {
+                return;
+            }
+        } else {
+            std::memcpy(&mTotal, header.mMagic, sizeof(mTotal));
+        }
+        mOpen = true;
+    }
+
+    MyVectorReader(const MyVectorReader<T> &) = delete;
+
+    MyVectorReader<T> &operator=(const MyVectorReader<T> &) = delete;
+
+    ~MyVectorReader() {
+        if (mRawBatch != nullptr) {
+            MyHeapAllocator<T>().deallocate(mRawBatch, mBatchSize);
+        }
+    }
+
+    bool isOpen() const { return mOpen; }
+
+    /**
+     * @return number of elements in the whole file, known right after opening.
+     */
+    size_t getSize() const { return mTotal; }
+
+    /**
+     * Loads the next batch into the buffer, the previous batch is gone after this.
+     * @return false at the end of the file, or if the file turned out to be truncated/corrupted (see failed()).
+     */
+    bool next() {
+        if (!mOpen || mConsumed >= mTotal) {
+            return false;
+        }
+        size_t wanted = mTotal - mConsumed < mBatchSize ? mTotal - mConsumed : mBatchSize;
+
+        if constexpr (kCanReadRaw) {
+            if (mBinary) {
+                mInputFileStream.read((char *) mRawBatch, static_cast<std::streamsize>(wanted * sizeof(T)));
+                if (!mInputFileStream) {
+                    return stop();
+                }
+                if (mSwapBytes) {
+                    myByteSwap(mRawBatch, wanted);
+                }
+                mRawCount = wanted;
+                mConsumed += wanted;
+                return true;
+            }
+        }
+
+        mBatch.clear(); // Keeps the capacity, so after the first batch nothing is allocated for the buffer
+        for (size_t i = 0; i < wanted; i++) {
+            T element{}; // Object we are reading from file
+            if (!myReadTextElement(mInputFileStream, element, mScratch)) {
+                return stop();
+            }
+            mBatch.pushBack(element);
+        }
+        mConsumed += wanted;
+        return true;
+    }
+
+    /**
+     * @return first element of the current batch.
+     */
+    const T *data() {
+        if constexpr (kCanReadRaw) {
+            if (mBinary) {
+                return mRawBatch;
+            }
+        }
+        return mBatch.getSize() > 0 ? &mBatch[0] : nullptr;
+    }
+
+    /**
+     * @return number of elements in the current batch.
+     */
+    size_t count() { return mBinary ? mRawCount : mBatch.getSize(); }
+
+    /**
+     * True if reading stopped before getSize() elements were seen.
+     */
+    bool failed() const { return !mOpen || (mConsumed < mTotal && !mInputFileStream); }
+
+    /**
+     * Calls batchCallback(const T *batch, size_t count) for every remaining batch.
+     * @return false if the file couldn't be read to the end.
+     */
+    template<typename BatchCallback>
+    bool forEachBatch(BatchCallback batchCallback) {
+        while (next()) {
+            batchCallback(data(), count());
+        }
+        return !failed();
+    }
+
+private:
+    bool stop() {
+        mInputFileStream.setstate(std::ios::failbit);
+        mRawCount = 0;
+        mBatch.clear();
+        return false;
+    }
+};
+
+#endif //VECTOR_MYVECTORREADER_H
@@ -0,0 +1,313 @@
+//
+// Opt-in instrumentation of MyVector: what got allocated, how much was moved while growing, how much capacity was
+// never used, and how long sort, find and serialize took.
+//
+// Off by default and then free: MyVector has no extra member and every recording call compiles to nothing.
+// Build with -DMY_VECTOR_STATS=1 to turn it on, then
+//
+//      vector.getStats()                       - counters of one vector
+//      myTypeStats<int>().snapshot()           - all MyVector<int> together, whatever their allocator
+//      myDumpVectorStats(std::cout, MyStatsFormat::Json)
+//                                              - every element type seen so far, as text or JSON
+//      mySetVectorHooks(&myHooks)              - called on every event, e.g. to feed a metrics system
+//
+// Counters are relaxed atomics, so vectors may be used from several threads while being counted.
+//
+
+#ifndef VECTOR_MYVECTORSTATS_H
+#define VECTOR_MYVECTORSTATS_H
+
+#ifndef MY_VECTOR_STATS
+#define MY_VECTOR_STATS 0
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+/**
+ * Operations whose time is measured.
+ */
+enum class MyVectorOperation {
+    Sort, /// Every sort() and radixSort() overload
+    Find, /// find, count and contains
+    Serialize /// serialize and deserialize
+};
+
+/**
+ * What a hook is told about.
+ */
+enum class MyVectorEventKind {
+    Allocate, /// The vector got a new or bigger/smaller block
+    Release, /// The vector gave its block back
+    Operation /// A timed operation finished, see mOperation
+};
+
+struct MyVectorEvent {
+    MyVectorEventKind mKind;
+    MyVectorOperation mOperation; /// Only meaningful for MyVectorEventKind::Operation
+    const char *mTypeName; /// Element type, demangled where possible
+    const void *mVector; /// Which vector, only to tell them apart
+    size_t mElementSize; /// sizeof(T)
+    size_t mSize; /// Elements at the time of the event
+    size_t mOldCapacity; /// Capacity before an allocation
+    size_t mNewCapacity; /// Capacity after an allocation, 0 after a release
+    size_t mBytesMoved; /// Element bytes relocated by this allocation
+    uint64_t mNanoseconds; /// Duration of an operation
+};
+
+/**
+ * Receives every event while installed with mySetVectorHooks(). Called on the thread that caused the event.
+ */
+class MyVectorHooks {
+public:
+    virtual ~MyVectorHooks() = default;
+
+    virtual void onEvent(const MyVectorEvent &event) = 0;
+};
+
+inline std::atomic<MyVectorHooks *> &myVectorHooks() {
+    static std::atomic<MyVectorHooks *> hooks{nullptr};
+    return hooks;
+}
+
+/**
+ * Installs hooks, nullptr removes them. The hooks must stay alive until they are removed.
+ */
+inline void mySetVectorHooks(MyVectorHooks *hooks) { myVectorHooks().store(hooks); }
+
+enum class MyStatsFormat {
+    Text,
+    Json
+};
+
+/**
+ * Plain copy of the counters at one moment.
+ */
+struct MyVectorStats {
+    uint64_t mAllocations = 0; /// Blocks obtained, including growth in place
+    uint64_t mBytesAllocated = 0; /// Sum of the sizes of those blocks
+    uint64_t mBytesMoved = 0; /// Element bytes relocated because the block changed
+    uint64_t mPeakCapacity = 0; /// Largest capacity reached, in elements
+    uint64_t mWastedBytes = 0; /// Capacity that held no element: when blocks were released, or right now for one vector
+    uint64_t mSorts = 0;
+    uint64_t mSortNanoseconds = 0;
+    uint64_t mFinds = 0;
+    uint64_t mFindNanoseconds = 0;
+    uint64_t mSerializations = 0;
+    uint64_t mSerializeNanoseconds = 0;
+
+    void write(std::ostream &os, const std::string &name, MyStatsFormat format) const {
+        if (format == MyStatsFormat::Json) {
+            os << "{\"type\": \"" << name << "\", \"allocations\": " << mAllocations
+               << ", \"bytesAllocated\": " << mBytesAllocated << ", \"bytesMoved\": " << mBytesMoved
+               << ", \"peakCapacity\": " << mPeakCapacity << ", \"wastedBytes\": " << mWastedBytes
+               << ", \"sorts\": " << mSorts << ", \"sortNanoseconds\": " << mSortNanoseconds
+               << ", \"finds\": " << mFinds << ", \"findNanoseconds\": " << mFindNanoseconds
+               << ", \"serializations\": " << mSerializations
+               << ", \"serializeNanoseconds\": " << mSerializeNanoseconds << "}";
+        } else {
+            os << name << ": " << mAllocations << " allocations, " << mBytesAllocated << " bytes allocated, "
+               << mBytesMoved << " bytes moved, peak capacity " << mPeakCapacity << ", " << mWastedBytes
+               << " bytes wasted, " << mSorts << " sorts in " << mSortNanoseconds << " ns, " << mFinds
+               << " finds in " << mFindNanoseconds << " ns, " << mSerializations << " serializations in "
+               << mSerializeNanoseconds << " ns";
+        }
+    }
+};
+
+/**
+ * Live counters, of one vector or of all vectors of one element type.
+ */
+class MyVectorCounters {
+
+private:
+    std::atomic<uint64_t> mAllocations{0};
+    std::atomic<uint64_t> mBytesAllocated{0};
+    std::atomic<uint64_t> mBytesMoved{0};
+    std::atomic<uint64_t> mPeakCapacity{0};
+    std::atomic<uint64_t> mWastedBytes{0};
+    std::atomic<uint64_t> mOperations[3] = {}; /// Indexed by MyVectorOperation
+    std::atomic<uint64_t> mNanoseconds[3] = {};
+
+public:
+    MyVectorCounters() = default;
+
+    /// A copied vector starts counting from zero
+    MyVectorCounters(const MyVectorCounters &) {}
+
+    MyVectorCounters &operator=(const MyVectorCounters &) { return *this; }
+
+    void recordAllocation(size_t newCapacity, size_t elementSize, size_t bytesMoved) {
+        mAllocations.fetch_add(1, std::memory_order_relaxed);
+        mBytesAllocated.fetch_add(newCapacity * elementSize, std::memory_order_relaxed);
+        mBytesMoved.fetch_add(bytesMoved, std::memory_order_relaxed);
+        uint64_t peak = mPeakCapacity.load(std::memory_order_relaxed);
+        while (peak < newCapacity && !mPeakCapacity.compare_exchange_weak(peak, newCapacity,
+                                                                          std::memory_order_relaxed)) {}
+    }
+
+    void recordRelease(size_t wastedBytes) { mWastedBytes.fetch_add(wastedBytes, std::memory_order_relaxed); }
+
+    void recordOperation(MyVectorOperation operation, uint64_t nanoseconds) {
+        mOperations[static_cast<int>(operation)].fetch_add(1, std::memory_order_relaxed);
+        mNanoseconds[static_cast<int>(operation)].fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    MyVectorStats snapshot() const {
+        MyVectorStats stats;
+        stats.mAllocations = mAllocations.load(std::memory_order_relaxed);
+        stats.mBytesAllocated = mBytesAllocated.load(std::memory_order_relaxed);
+        stats.mBytesMoved = mBytesMoved.load(std::memory_order_relaxed);
+        stats.mPeakCapacity = mPeakCapacity.load(std::memory_order_relaxed);
+        stats.mWastedBytes = mWastedBytes.load(std::memory_order_relaxed);
+        stats.mSorts = mOperations[0].load(std::memory_order_relaxed);
+        stats.mSortNanoseconds = mNanoseconds[0].load(std::memory_order_relaxed);
+        stats.mFinds = mOperations[1].load(std::memory_order_relaxed);
+        stats.mFindNanoseconds = mNanoseconds[1].load(std::memory_order_relaxed);
+        stats.mSerializations = mOperations[2].load(std::memory_order_relaxed);
+        stats.mSerializeNanoseconds = mNanoseconds[2].load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+/* ============================================================================================================  *
+ *                                     PER TYPE                                                                  |
+ * ============================================================================================================  */
+
+/**
+ * Counters of one element type. They form a list that myDumpVectorStats walks, every type adds itself the first
+ * time one of its vectors records something.
+ */
+struct MyTypeStatsNode {
+    MyVectorCounters mCounters;
+    std::string mTypeName;
+    MyTypeStatsNode *mNext = nullptr;
+};
+
+inline std::atomic<MyTypeStatsNode *> &myTypeStatsHead() {
+    static std::atomic<MyTypeStatsNode *> head{nullptr};
+    return head;
+}
+
+template<typename T>
+const char *myTypeName() {
+    static const std::string name = [] {
+        const char *mangled = typeid(T).name();
+#if defined(__GNUG__)
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+        if (status == 0 && demangled != nullptr) {
+            std::string readable(demangled);
+            std::free(demangled);
+            return readable;
+        }
+#endif
+        return std::string(mangled);
+    }();
+    return name.c_str();
+}
+
+/**
+ * @return counters shared by all MyVector<T>.
+ */
+template<typename T>
+MyVectorCounters &myTypeStats() {
+    static MyTypeStatsNode *node = [] {
+        static MyTypeStatsNode typeNode;
+        typeNode.mTypeName = myTypeName<T>();
+        typeNode.mNext = myTypeStatsHead().load();
+        while (!myTypeStatsHead().compare_exchange_weak(typeNode.mNext, &typeNode)) {}
+        return &typeNode;
+    }();
+    return node->mCounters;
+}
+
+/**
+ * Writes the counters of every element type seen so far: one line per type as text, or a JSON array.
+ */
+inline void myDumpVectorStats(std::ostream &os, MyStatsFormat format = MyStatsFormat::Text) {
+    bool json = format == MyStatsFormat::Json;
+    os << (json ? "[" : "");
+    for (MyTypeStatsNode *node = myTypeStatsHead().load(); node != nullptr; node = node->mNext) {
+        node->mCounters.snapshot().write(os, node->mTypeName, format);
+        os << (json ? (node->mNext != nullptr ? ", " : "") : "\n");
+    }
+    os << (json ? "]\n" : "");
+}
+
+/* ============================================================================================================  *
+ *                                     RECORDING                                                                 |
+ * ============================================================================================================  */
+
+/*
+ * Called by MyVector: every event goes to the vector's own counters, the counters of its element type and the hooks.
+ */
+
+template<typename T>
+void myRecordAllocation(MyVectorCounters &counters, const void *vector, size_t size, size_t oldCapacity,
+                        size_t newCapacity, size_t bytesMoved) {
+    counters.recordAllocation(newCapacity, sizeof(T), bytesMoved);
+    myTypeStats<T>().recordAllocation(newCapacity, sizeof(T), bytesMoved);
+    if (MyVectorHooks *hooks = myVectorHooks().load()) {
+        hooks->onEvent({MyVectorEventKind::Allocate, MyVectorOperation::Sort, myTypeName<T>(), vector, sizeof(T),
+                        size, oldCapacity, newCapacity, bytesMoved, 0});
+    }
+}
+
+template<typename T>
+void myRecordRelease(MyVectorCounters &counters, const void *vector, size_t size, size_t capacity) {
+    counters.recordRelease((capacity - size) * sizeof(T));
+    myTypeStats<T>().recordRelease((capacity - size) * sizeof(T));
+    if (MyVectorHooks *hooks = myVectorHooks().load()) {
+        hooks->onEvent({MyVectorEventKind::Release, MyVectorOperation::Sort, myTypeName<T>(), vector, sizeof(T),
+                        size, capacity, 0, 0, 0});
+    }
+}
+
+/**
+ * Measures one operation from construction to destruction.
+ */
+template<typename T>
+class MyOperationTimer {
+
+private:
+    MyVectorCounters &mCounters;
+    const void *mVector;
+    MyVectorOperation mOperation;
+    size_t mSize;
+    std::chrono::steady_clock::time_point mStart;
+
+public:
+    MyOperationTimer(MyVectorCounters &counters, const void *vector, MyVectorOperation operation, size_t size)
+            : mCounters(counters), mVector(vector), mOperation(operation), mSize(size),
+              mStart(std::chrono::steady_clock::now()) {}
+
+    MyOperationTimer(const MyOperationTimer &) = delete;
+
+    MyOperationTimer &operator=(const MyOperationTimer &) = delete;
+
+    ~MyOperationTimer() {
+        auto nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - mStart).count());
+        mCounters.recordOperation(mOperation, nanoseconds);
+        myTypeStats<T>().recordOperation(mOperation, nanoseconds);
+        if (MyVectorHooks *hooks = myVectorHooks().load()) {
+            hooks->onEvent({MyVectorEventKind::Operation, mOperation, myTypeName<T>(), mVector, sizeof(T), mSize,
+                            0, 0, 0, nanoseconds});
+        }
+    }
+};
+
+/// What MyVector uses in place of a timer when stats are off
+struct MyNoOperationTimer {};
+
+#endif //VECTOR_MYVECTORSTATS_H
@@ -0,0 +1,168 @@
+//
+// Read-only view of a vector file written by MyVector::serialize, backed by mmap.
+//
+// Opening is O(1): nothing is read or copied up front, pages are faulted in on first touch and every process
+// mapping the same file shares them through the page cache. Only the binary layout (trivially copyable T) can
+// be viewed this way, text files have to go through MyVector::deserialize.
+//
+// POSIX only (mmap).
+//
+
+#ifndef VECTOR_MYVECTORVIEW_H
+#define VECTOR_MYVECTORVIEW_H
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MyFind.h"
+#include "MySerialization.h"
+
+template<typename T>
+class MyVectorView {
+
+    static_assert(std::is_trivially_copyable<T>::value, "Only binary vector files of trivially copyable T can be mapped");
+    static_assert(alignof(T) <= sizeof(MyFileHeader), "Elements right after the header must be properly aligned");
+
+private:
+    void *mMapping = nullptr; /// Start of the mapped file, the header lives here
+    size_t mMappingLength = 0; /// Bytes mapped
+    const T *mData = nullptr; /// First element, right after the header
+    size_t mSize = 0; /// Number of elements
+
+public:
+    static constexpr size_t npos = kMyNotFound; /// find() result when nothing was found
+
+    MyVectorView() = default;
+
+    /**
+     * Maps the given file, check isOpen() to see if it worked.
+     */
+    explicit MyVectorView(const std::string &fileName) { open(fileName); }
+
+    MyVectorView(const MyVectorView<T> &) = delete;
+
+    MyVectorView<T> &operator=(const MyVectorView<T> &) = delete;
+
+    MyVectorView(MyVectorView<T> &&anotherView) noexcept { swap(anotherView); }
+
+    MyVectorView<T> &operator=(MyVectorView<T> &&anotherView) noexcept {
+        if (this != &anotherView) {
+            close();
+            swap(anotherView);
+        }
+        return *this;
+    }
+
+    ~MyVectorView() { close(); }
+
+    /**
+     * Maps a file written by MyVector<T>::serialize. Any previously mapped file is closed first.
+     *
+     * @param fileName
+     * @return false if the file can't be mapped, isn't a binary vector file, holds another element type
+     * (size, kind, byte order) or is shorter than its header says. The view is left empty in that case.
+     */
+    bool open(const std::string &fileName) {
+        close();
+
+        int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+        if (fileDescriptor < 0) {
+            return false;
+        }
+
+        struct stat fileStatus{};
+        if (::fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size < (off_t) sizeof(MyFileHeader)) {
+            ::close(fileDescriptor);
+            return false;
+        }
+
+        size_t fileLength = static_cast<size_t>(fileStatus.st_size);
+        void *mapping = ::mmap(nullptr, fileLength, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+        ::close(fileDescriptor); // The mapping keeps the file alive on its own
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+
+        auto header = static_cast<const MyFileHeader *>(mapping);
+        size_t payloadLength = fileLength - sizeof(MyFileHeader);
+        if (!header->template matches<T>() || payloadLength / sizeof(T) < header->mElementCount) {
+            ::munmap(mapping, fileLength);
+            return false;
+        }
+
+        mMapping = mapping;
+        mMappingLength = fileLength;
+        mData = reinterpret_cast<const T *>(static_cast<const char *>(mapping) + sizeof(MyFileHeader));
+        mSize = static_cast<size_t>(header->mElementCount);
+        return true;
+    }
+
+    /**
+     * Unmaps the file, the view becomes empty.
+     */
+    void close() {
+        if (mMapping != nullptr) {
+            ::munmap(mMapping, mMappingLength);
+        }
+        mMapping = nullptr;
+        mMappingLength = 0;
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    bool isOpen() const { return mMapping != nullptr; }
+
+    void swap(MyVectorView<T> &anotherView) noexcept {
+        std::swap(mMapping, anotherView.mMapping);
+        std::swap(mMappingLength, anotherView.mMappingLength);
+        std::swap(mData, anotherView.mData);
+        std::swap(mSize, anotherView.mSize);
+    }
+
+    /* ============================================================================================================  *
+     *                                     ELEMENT ACCESS                                                            |
+     * ============================================================================================================  */
+
+    const T &operator[](size_t position) const { return mData[position]; }
+
+    const T &at(size_t position) const { return mData[position]; }
+
+    /* ============================================================================================================  *
+     *                                     CAPACITY                                                                  |
+     * ============================================================================================================  */
+
+    size_t getSize() const { return mSize; } /// Number of elements in the mapped file
+
+    /* ============================================================================================================  *
+     *                                     FIND                                                                      |
+     * ============================================================================================================  */
+
+    /**
+     * @param element
+     * @return position of the requested element or npos.
+     */
+    size_t find(const T &element) const { return myFind(mData, mSize, element); }
+
+    /**
+     * @param element
+     * @return how many elements are equal to the given one.
+     */
+    size_t count(const T &element) const { return myCount(mData, mSize, element); }
+
+    bool contains(const T &element) const { return find(element) != npos; }
+
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+
+    const T *begin() const { return mData; }
+
+    const T *end() const { return mData + mSize; }
+};
+
+#endif //VECTOR_MYVECTORVIEW_H
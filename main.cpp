@@ -2,8 +2,30 @@
 #include <string>
 #include <ostream>
 #include <istream>
+#include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
 #include "MyVector.h"
+#include "MyChunkedReader.h"
+#include "MyConcurrentVector.h"
+#include "MyCowVector.h"
+#include "MyIndexedVector.h"
+#include "MyMappedAllocator.h"
+#include "MySmallVector.h"
+#include "MySoAVector.h"
+#include "MyVectorView.h"
+#include "MyVectorReader.h"
 /*
  * TEST FILE.
  *
@@ -11,12 +33,83 @@
  */
 
 
+// Every operator new call in the program bumps this, so tests can prove how many allocations a call made.
+// Atomic because the concurrent tests allocate from several threads.
+static std::atomic<size_t> gAllocationCount{0};
+
+// The whole replaceable new/delete family goes through these two, so plain, array, sized and aligned forms are all
+// counted and all freed the same way. Kept out of line: GCC would otherwise inline free() next to a new-expression
+// and warn about a mismatched deallocation.
+__attribute__((noinline)) static void *countedAllocate(size_t size, size_t alignment = 0) noexcept {
+    gAllocationCount++;
+    size = size ? size : 1;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+__attribute__((noinline)) static void countedFree(void *memBlock) noexcept { std::free(memBlock); }
+
+static void *countedAllocateOrThrow(size_t size, size_t alignment = 0) {
+    if (void *memBlock = countedAllocate(size, alignment)) {
+        return memBlock;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size) { return countedAllocateOrThrow(size); }
+
+void *operator new[](size_t size) { return countedAllocateOrThrow(size); }
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size); }
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size); }
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *memBlock) noexcept { countedFree(memBlock); }
+
+void operator delete[](void *memBlock) noexcept { countedFree(memBlock); }
+
+void operator delete(void *memBlock, size_t) noexcept { countedFree(memBlock); }
+
+void operator delete[](void *memBlock, size_t) noexcept { countedFree(memBlock); }
+
+void operator delete(void *memBlock, std::align_val_t) noexcept { countedFree(memBlock); }
+
+void operator delete[](void *memBlock, std::align_val_t) noexcept { countedFree(memBlock); }
+
+void operator delete(void *memBlock, size_t, std::align_val_t) noexcept { countedFree(memBlock); }
+
+void operator delete[](void *memBlock, size_t, std::align_val_t) noexcept { countedFree(memBlock); }
+
+void operator delete(void *memBlock, const std::nothrow_t &) noexcept { countedFree(memBlock); }
+
+void operator delete[](void *memBlock, const std::nothrow_t &) noexcept { countedFree(memBlock); }
+
+void operator delete(void *memBlock, std::align_val_t, const std::nothrow_t &) noexcept { countedFree(memBlock); }
+
+void operator delete[](void *memBlock, std::align_val_t, const std::nothrow_t &) noexcept { countedFree(memBlock); }
+
+
 // Comparator that will compare people by their age.
 struct PersonAgeComparator {
-    bool operator()(Person firstPerson, Person secondPerson) {
-        if (firstPerson.getAge() == secondPerson.getAge()) {
-            return firstPerson.getAge() < secondPerson.getAge();
-        }
+    bool operator()(const Person &firstPerson, const Person &secondPerson) const {
         return firstPerson.getAge() < secondPerson.getAge();
     }
 };
@@ -43,97 +136,1321 @@ int main() {
     /* ============================================================================================================  *
      *                                     MODIFIERS                                                                 |
      * ============================================================================================================  */
-#if 0
-    myStringVector.pushBack("7");
-    myCharVector.pushBack('7');
-    myIntVector.pushBack(7);
-    myIntVector.print();
+    {
+        // Works on copies, the blocks below still need the original contents.
+        MyVector<int> ints(myIntVector);
+        MyVector<std::string> strings(myStringVector);
+        MyVector<char> chars(myCharVector);
+        MyVector<Person> people(myPeopleVector);
 
-    myPeopleVector.emplaceBack("Youssef", 19);
-    myPeopleVector.print();
+        strings.pushBack("7");
+        chars.pushBack('7');
+        ints.pushBack(7);
+        assert(ints.getSize() == 7 && ints[6] == 7 && strings[6] == "7" && chars[6] == '7');
 
-    myStringVector.popBack();
-    myCharVector.popBack();
-    myIntVector.popBack();
-    myIntVector.print();
+        Person &youssef = people.emplaceBack("Youssef", 19);
+        assert(people.getSize() == 3 && &youssef == &people[2] && people[2].getName() == "Youssef");
 
-    myStringVector.clear();
-    myCharVector.clear();
-    myIntVector.clear();
-    myIntVector.print();
-#endif
+        strings.popBack();
+        chars.popBack();
+        ints.popBack();
+        assert(ints.getSize() == 6 && strings.getSize() == 6 && chars.getSize() == 6 && ints[5] == 6);
+
+        size_t capacity = ints.getCapacity();
+        strings.clear();
+        chars.clear();
+        ints.clear();
+        assert(ints.getSize() == 0 && strings.getSize() == 0 && chars.getSize() == 0);
+        assert(ints.getCapacity() == capacity);
+        ints.popBack(); // Nothing to remove, nothing happens
+        assert(ints.getSize() == 0);
+
+        // Appending one of our own elements to a full block: it must be copied before the block is released.
+        MyVector<std::string> self;
+        self.pushBack(std::string(40, 'x'));
+        self.shrinkToFit();
+        self.pushBack(self[0]);
+        self.emplaceBack(self[1]);
+        assert(self.getSize() == 3 && self[1] == std::string(40, 'x') && self[2] == self[0]);
+        ints.pushBack(5);
+        ints.shrinkToFit();
+        ints.pushBack(ints[0]);
+        ints.emplaceBack(ints[1]);
+        assert(ints.getSize() == 3 && ints[1] == 5 && ints[2] == 5);
+        std::cout << "modifiers: OK" << std::endl;
+    }
+
+    {
+        // Removing: stable compaction, by index, swap-with-last.
+        MyVector<std::string> names = {"a", "b", "c", "d", "e", "f"};
+        assert(names.removeIf([](const std::string &name) { return name == "b" || name == "e"; }) == 2);
+        assert(names.getSize() == 4 && names[0] == "a" && names[1] == "c" && names[2] == "d" && names[3] == "f");
+        assert(names.removeIf([](const std::string &) { return false; }) == 0 && names.getSize() == 4);
+        assert(names.eraseAt(1) == 1 && names.getSize() == 3 && names[1] == "d");
+        names.unorderedErase(0);
+        assert(names.getSize() == 2 && names[0] == "f" && names[1] == "d");
+        names.unorderedErase(1);
+        names.unorderedErase(5); // Out of range, nothing happens
+        assert(names.getSize() == 1 && names[0] == "f");
+
+        // Every size and removal pattern around the 32-byte blocks of the vectorized kernel.
+        for (size_t size = 0; size < 40; size++) {
+            for (unsigned pattern = 0; pattern < 8; pattern++) {
+                MyVector<int> ints;
+                MyVector<double> doubles;
+                MyVector<short> shorts;
+                std::vector<int> expected;
+                for (size_t i = 0; i < size; i++) {
+                    ints.pushBack(static_cast<int>(i));
+                    doubles.pushBack(static_cast<double>(i));
+                    shorts.pushBack(static_cast<short>(i));
+                    if ((i * 7 + pattern) % 8 >= pattern) {
+                        expected.push_back(static_cast<int>(i));
+                    }
+                }
+                auto remove = [pattern](auto value) { return (static_cast<size_t>(value) * 7 + pattern) % 8 < pattern; };
+                assert(ints.removeIf(remove) == size - expected.size());
+                assert(doubles.removeIf(remove) == size - expected.size());
+                assert(shorts.removeIf(remove) == size - expected.size());
+                assert(ints.getSize() == expected.size() && doubles.getSize() == expected.size());
+                for (size_t i = 0; i < expected.size(); i++) {
+                    assert(ints[i] == expected[i] && doubles[i] == expected[i] && shorts[i] == expected[i]);
+                }
+            }
+        }
+
+        // Trivially copyable records take the branch-free loop.
+        struct Point {
+            int mX;
+            int mY;
+        };
+        MyVector<Point> points;
+        for (int i = 0; i < 100; i++) {
+            points.pushBack(Point{i, -i});
+        }
+        assert(points.removeIf([](const Point &point) { return point.mX % 3 != 0; }) == 66);
+        assert(points.getSize() == 34 && points[1].mX == 3 && points[33].mY == -99);
+        std::cout << "remove: OK" << std::endl;
+    }
 
     /* ============================================================================================================  *
      *                                     ELEMENT ACCESS                                                            |
      * ============================================================================================================  */
-#if 0
-    // Element access examples
-    std::cout << myIntVector[3];
-    std::cout << myIntVector.at(3);
-    std::cout << myStringVector[3];
-    std::cout << myStringVector.at(3);
-    std::cout << myCharVector[3];
-    std::cout << myCharVector.at(3);
-#endif
+    {
+        assert(myIntVector[3] == 4 && myIntVector.at(3) == 4);
+        assert(myStringVector[3] == "4" && myStringVector.at(3) == "4");
+        assert(myCharVector[3] == '4' && myCharVector.at(3) == '4');
+        myIntVector.at(3) = 40;
+        assert(myIntVector[3] == 40);
+        myIntVector[3] = 4;
+        const MyVector<int> &constInts = myIntVector;
+        assert(constInts[3] == 4);
+        std::cout << "element access: OK" << std::endl;
+    }
 
     /* ============================================================================================================  *
      *                                     CAPACITY                                                                  |
      * ============================================================================================================  */
-#if 0
-    std::cout << myIntVector.getSize();
-    std::cout << myIntVector.getCapacity();
-    std::cout << myStringVector.getSize();
-    std::cout << myStringVector.getCapacity();
-    std::cout << myCharVector.getSize();
-    std::cout << myCharVector.getCapacity();
-#endif
+    {
+        assert(myIntVector.getSize() == 6 && myIntVector.getCapacity() >= 6);
+        assert(myStringVector.getSize() == 6 && myStringVector.getCapacity() >= 6);
+        assert(myCharVector.getSize() == 6 && myCharVector.getCapacity() >= 6);
+        assert(myFloatVector.getSize() == 0 && myFloatVector.getCapacity() == 0);
+        assert(myDoubleVector.getSize() == 0 && myBoolVector.getSize() == 0);
+        std::cout << "capacity: OK" << std::endl;
+    }
+
+    {
+        // One allocation per bulk operation, no matter how many elements.
+        MyVector<std::string> names;
+        std::vector<std::string> source = {"a", "b", "c", "d"};
+        size_t allocationsBefore = gAllocationCount;
+        names.reserve(100);
+        assert(gAllocationCount == allocationsBefore + 1 && names.getCapacity() == 100);
+        names.appendRange(source.begin(), source.end());
+        names.appendRange(names.begin(), names.end()); // From itself
+        assert(gAllocationCount == allocationsBefore + 1 && names.getSize() == 8 && names[7] == "d");
+
+        // Inserting into a full vector grows it once; shifting in place when there is room.
+        names.shrinkToFit();
+        assert(names.getCapacity() == 8);
+        names.insert(1, source.begin() + 2, source.end());
+        assert(names.getSize() == 10 && names[0] == "a" && names[1] == "c" && names[2] == "d" && names[3] == "b");
+        names.insert(0, source.begin(), source.begin() + 1);
+        assert(names[0] == "a" && names[1] == "a" && names[2] == "c" && names[10] == "d");
+        assert(names.erase(1, 4) == 1 && names.getSize() == 8 && names[1] == "b" && names[7] == "d");
+        assert(names.erase(6, 100) == 6 && names.getSize() == 6 && names[5] == "b");
+
+        names.resize(8, "z");
+        assert(names.getSize() == 8 && names[7] == "z");
+        names.resize(2);
+        assert(names.getSize() == 2 && names[1] == "b");
+        names.shrinkToFit();
+        assert(names.getCapacity() == 2);
+        names.resize(0);
+        names.shrinkToFit();
+        assert(names.getCapacity() == 0);
+
+        // Single-pass ranges are fine too.
+        std::istringstream numbersText("1 2 3");
+        MyVector<int> ints;
+        ints.appendRange(std::istream_iterator<int>(numbersText), std::istream_iterator<int>());
+        ints.resize(5);
+        ints.insert(1, ints.begin(), ints.begin()); // Empty range, nothing happens
+        int middle[] = {7, 8};
+        ints.insert(1, middle, middle + 2);
+        assert(ints.getSize() == 7 && ints[0] == 1 && ints[1] == 7 && ints[2] == 8 && ints[3] == 2 && ints[6] == 0);
+
+        ints.assign(1000, ints[1]); // The value may live in the vector itself
+        assert(ints.getSize() == 1000 && ints.getCapacity() == 1000);
+        assert(ints[0] == 7 && ints[999] == 7);
+        ints.assign(3, 4);
+        assert(ints.getSize() == 3 && ints[2] == 4 && ints.getCapacity() == 1000);
+
+        MyVector<int> listed = {1, 2, 3};
+        assert(listed.getCapacity() == 3);
+        std::cout << "bulk: OK" << std::endl;
+    }
 
     /* ============================================================================================================  *
      *                                     SERIALIZATION                                                             |
      * ============================================================================================================  */
-#if 0
-    // The content of myIntVector is written to binary file
-    myIntVector.serialize("Serialized.bin");
+    {
+        // The content of myIntVector is written to binary file
+        assert(myIntVector.serialize("Serialized.bin"));
 
-    // Now the content of that file is deserialized to a new vector
-    MyVector<int> myNewIntVector;
-    myNewIntVector.deserialize("Serialized.bin");
+        // Now the content of that file is deserialized to a new vector
+        MyVector<int> myNewIntVector;
+        assert(myNewIntVector.deserialize("Serialized.bin"));
 
-    // The content of the two vectors is exactly the same
-    myIntVector.print();
-    myNewIntVector.print();
+        // The content of the two vectors is exactly the same
+        assert(myNewIntVector.getSize() == myIntVector.getSize());
+        for (size_t i = 0; i < myIntVector.getSize(); i++) {
+            assert(myNewIntVector[i] == myIntVector[i]);
+        }
 
-    // Serializing vector of custom objects
-    myPeopleVector.serialize("peopleFile");
-    MyVector<Person> myNewPeopleVector;
-    myNewPeopleVector.deserialize("peopleFile");
-    myNewPeopleVector.print();
+        // Serializing vector of custom objects
+        assert(myPeopleVector.serialize("peopleFile"));
+        MyVector<Person> myNewPeopleVector;
+        assert(myNewPeopleVector.deserialize("peopleFile"));
+        assert(myNewPeopleVector.getSize() == 2 && myNewPeopleVector[1].getName() == "Viktor");
+        assert(myNewPeopleVector[1].getAge() == 18);
 
-#endif
+        // A corrupted length prefix is refused instead of allocated.
+        {
+            std::fstream file("peopleFile", std::ios::binary | std::ios::in | std::ios::out);
+            size_t hugeLength = size_t(1) << 60;
+            file.seekp(sizeof(size_t));
+            file.write((const char *) &hugeLength, sizeof(hugeLength));
+        }
+        MyVector<Person> corruptedPeople;
+        assert(!corruptedPeople.deserialize("peopleFile"));
+        std::remove("Serialized.bin");
+        std::remove("peopleFile");
+    }
+
+    {
+        // Trivially copyable elements go through the binary header + raw bytes layout.
+        MyVector<double> doubles;
+        for (int i = 0; i < 1000; i++) {
+            doubles.pushBack(i * 0.5);
+        }
+        assert(doubles.serialize("Doubles.bin"));
+        MyVector<double> loadedDoubles;
+        assert(loadedDoubles.deserialize("Doubles.bin"));
+        assert(loadedDoubles.getSize() == 1000 && loadedDoubles.getCapacity() == 1000 && loadedDoubles[999] == 499.5);
+
+        // A file of doubles is not a file of ints, nor of int64 values of the same size.
+        MyVector<int> wrongSize;
+        MyVector<long long> wrongKind;
+        assert(!wrongSize.deserialize("Doubles.bin") && wrongSize.getSize() == 0);
+        assert(!wrongKind.deserialize("Doubles.bin") && wrongKind.getSize() == 0);
+
+        // The same file can be mapped instead of loaded.
+        MyVectorView<double> doublesView("Doubles.bin");
+        assert(doublesView.isOpen() && doublesView.getSize() == 1000 && doublesView[3] == 1.5);
+        assert(doublesView.find(250.0) == 500 && doublesView.find(-1.0) == MyVectorView<double>::npos);
+        double viewTotal = 0;
+        for (double element : doublesView) {
+            viewTotal += element;
+        }
+        assert(viewTotal == 249750.0);
+        assert(!MyVectorView<float>("Doubles.bin").isOpen() && !MyVectorView<long long>("Doubles.bin").isOpen());
+
+        // Or streamed through a bounded buffer.
+        MyVectorReader<double> doublesReader("Doubles.bin", 64);
+        size_t batches = 0, streamed = 0;
+        while (doublesReader.next()) {
+            assert(doublesReader.count() <= 64 && doublesReader.data()[0] == streamed * 0.5);
+            streamed += doublesReader.count();
+            batches++;
+        }
+        assert(!doublesReader.failed() && streamed == 1000 && batches == 16);
+        std::remove("Doubles.bin");
+
+        // The text layout is still there when asked for, and old text files still load.
+        MyVector<int> textInts = {1, 2, 3};
+        assert(textInts.serialize("TextInts.bin", MyFileFormat::Text));
+        MyVector<int> loadedTextInts;
+        assert(loadedTextInts.deserialize("TextInts.bin") && loadedTextInts.getSize() == 3 && loadedTextInts[2] == 3);
+        assert(!MyVectorView<int>("TextInts.bin").isOpen());
+        std::remove("TextInts.bin");
+
+        MyVector<Person> people = {Person("Andriy", 19), Person("Viktor", 18)};
+        assert(people.serialize("People.bin"));
+        MyVector<Person> loadedPeople;
+        assert(loadedPeople.deserialize("People.bin") && loadedPeople[1].getAge() == 18);
+        assert(loadedPeople.getCapacity() == 2);
+        int totalAge = 0;
+        MyVectorReader<Person> peopleReader("People.bin", 1);
+        assert(peopleReader.forEachBatch([&totalAge](const Person *batch, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                totalAge += batch[i].getAge();
+            }
+        }));
+        assert(totalAge == 37);
+        std::remove("People.bin");
+
+        // Codecs: every one round-trips, and each shrinks the data it is made for.
+        auto fileSize = [](const char *fileName) {
+            std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+            return static_cast<size_t>(file.tellg());
+        };
+        MyVector<int> sortedInts, nearInts, mixedInts;
+        MyVector<unsigned long long> hugeValues;
+        for (int i = 0; i < 10000; i++) {
+            sortedInts.pushBack(1000000 + i * 3);
+            nearInts.pushBack(5000 + (i * 7919) % 200);
+            mixedInts.pushBack(i % 2 == 0 ? -i : i * 1000);
+            hugeValues.pushBack(~0ULL - static_cast<unsigned long long>(i) * 0x100000001ULL);
+        }
+        const MyCodec codecs[] = {MyCodec::Varint, MyCodec::DeltaZigZag, MyCodec::FrameOfReference,
+                                  MyCodec::Dictionary};
+        for (MyCodec codec : codecs) {
+            for (MyVector<int> *ints : {&sortedInts, &nearInts, &mixedInts}) {
+                assert(ints->serialize("Codec.bin", codec));
+                MyVector<int> decoded = {42};
+                assert(decoded.deserialize("Codec.bin") && decoded.getSize() == 10001 && decoded[0] == 42);
+                for (size_t i = 0; i < ints->getSize(); i++) {
+                    assert(decoded[i + 1] == (*ints)[i]);
+                }
+                // Nobody else may take the compressed blocks for raw elements
+                assert(!MyVectorView<int>("Codec.bin").isOpen() && !MyVectorReader<int>("Codec.bin").next());
+                MyVector<unsigned> otherKind;
+                assert(!otherKind.deserialize("Codec.bin") && otherKind.getSize() == 0);
+            }
+            assert(hugeValues.serialize("Codec.bin", codec));
+            MyVector<unsigned long long> decodedHuge;
+            assert(decodedHuge.deserialize("Codec.bin") && decodedHuge.getSize() == 10000);
+            assert(decodedHuge[0] == hugeValues[0] && decodedHuge[9999] == hugeValues[9999]);
+        }
+        const size_t rawSize = sizeof(MyFileHeader) + 10000 * sizeof(int);
+        assert(sortedInts.serialize("Codec.bin", MyCodec::DeltaZigZag) && fileSize("Codec.bin") < rawSize / 8);
+        assert(nearInts.serialize("Codec.bin", MyCodec::FrameOfReference) && fileSize("Codec.bin") < rawSize / 3);
+        assert(nearInts.serialize("Codec.bin", MyCodec::Varint) && fileSize("Codec.bin") < rawSize * 2 / 3);
+
+        MyVector<std::string> colors;
+        const char *palette[] = {"red", "green", "blue", "cyan"};
+        for (int i = 0; i < 10000; i++) {
+            colors.pushBack(palette[(i * 31) % 4]);
+        }
+        assert(colors.serialize("Colors.bin") && colors.serialize("Codec.bin", MyCodec::Dictionary));
+        assert(fileSize("Codec.bin") * 20 < fileSize("Colors.bin"));
+        MyVector<std::string> decodedColors;
+        assert(decodedColors.deserialize("Codec.bin") && decodedColors.getSize() == 10000);
+        for (int i = 0; i < 10000; i++) {
+            assert(decodedColors[i] == colors[i]);
+        }
+        assert(!colors.serialize("Codec.bin", MyCodec::Varint) && !people.serialize("Codec.bin", MyCodec::Dictionary));
+
+        // Entries come back exactly, not through operator<< and operator>>.
+        MyVector<std::string> phrases = {"hello world", "a b", "", "hello world", " \n\t"};
+        MyVector<std::string> decodedPhrases;
+        assert(phrases.serialize("Codec.bin", MyCodec::Dictionary) && decodedPhrases.deserialize("Codec.bin"));
+        assert(decodedPhrases.getSize() == 5 && decodedPhrases[0] == "hello world" && decodedPhrases[1] == "a b");
+        assert(decodedPhrases[2].empty() && decodedPhrases[3] == "hello world" && decodedPhrases[4] == " \n\t");
+        MyVector<double> fractions = {0.1234567891, -0.0, 0.0, 0.1234567891, 1e300};
+        MyVector<double> decodedFractions;
+        assert(fractions.serialize("Codec.bin", MyCodec::Dictionary) && decodedFractions.deserialize("Codec.bin"));
+        assert(decodedFractions.getSize() == 5 && decodedFractions[0] == 0.1234567891 && decodedFractions[4] == 1e300);
+        assert(std::signbit(decodedFractions[1]) && !std::signbit(decodedFractions[2]));
+        MyVector<char> letters = {'a', 'b', 'a'};
+        MyVector<char> decodedLetters;
+        assert(letters.serialize("Codec.bin", MyCodec::Dictionary) && decodedLetters.deserialize("Codec.bin"));
+        assert(decodedLetters.getSize() == 3 && decodedLetters[2] == 'a');
+        MyVector<int> empty;
+        assert(empty.serialize("Codec.bin", MyCodec::DeltaZigZag) && empty.deserialize("Codec.bin"));
+        assert(empty.getSize() == 0);
+
+        // A truncated file is refused
+        assert(sortedInts.serialize("Codec.bin", MyCodec::FrameOfReference));
+        std::string bytes;
+        {
+            std::ifstream file("Codec.bin", std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream file("Codec.bin", std::ios::binary);
+            file.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 5));
+        }
+        MyVector<int> truncated;
+        assert(!truncated.deserialize("Codec.bin"));
+        std::remove("Codec.bin");
+        std::remove("Colors.bin");
+
+        // Asynchronous: small buffers so encoding and writing take turns many times.
+        MyAsyncWriteOptions smallBuffers;
+        smallBuffers.mBufferBytes = 4096;
+        std::future<MyIoStatus> written = sortedInts.serializeAsync("Async.bin", smallBuffers);
+        MyIoStatus status = written.get();
+        assert(status.ok() && status.mErrno == 0 && std::ifstream("Async.bin.tmp").fail());
+        MyVector<int> asyncInts;
+        assert(asyncInts.deserialize("Async.bin") && asyncInts.getSize() == 10000 && asyncInts[9999] == sortedInts[9999]);
+
+        smallBuffers.mCodec = MyCodec::Dictionary;
+        smallBuffers.mSync = false;
+        assert(colors.serializeAsync("Async.bin", smallBuffers).get());
+        MyVector<std::string> asyncColors;
+        assert(asyncColors.deserialize("Async.bin") && asyncColors.getSize() == 10000 && asyncColors[7] == colors[7]);
+
+        MyAsyncWriteOptions textInPlace;
+        textInPlace.mFormat = MyFileFormat::Text;
+        textInPlace.mAtomicRename = false;
+        assert(people.serializeAsync("Async.bin", textInPlace).get());
+        MyVector<Person> asyncPeople;
+        assert(asyncPeople.deserialize("Async.bin") && asyncPeople[0].getName() == "Andriy");
+
+        // Failures say where they happened, and a failed write leaves the old file alone
+        status = sortedInts.serializeAsync("no/such/directory/Async.bin").get();
+        assert(!status && status.mError == MyIoError::Open && status.mErrno == ENOENT);
+        smallBuffers.mCodec = MyCodec::Varint;
+        status = colors.serializeAsync("Async.bin", smallBuffers).get();
+        assert(status.mError == MyIoError::Encode);
+        MyVector<Person> unchanged;
+        assert(unchanged.deserialize("Async.bin") && unchanged.getSize() == 2);
+        std::remove("Async.bin");
+
+        // Chunked: blocks decoded on a pool, random access through the index, checksums catching corruption.
+        MyThreadPool chunkPool(3);
+        MyChunkedOptions chunked;
+        chunked.mBlockElements = 1000;
+        chunked.mPolicy = MyParallelPolicy{4, 1, &chunkPool};
+        assert(sortedInts.serialize("Chunked.bin", chunked));
+        assert(!MyVectorReader<int>("Chunked.bin").next() && !MyVectorView<int>("Chunked.bin").isOpen());
+        MyVector<int> chunkedInts = {-1};
+        assert(chunkedInts.deserialize("Chunked.bin", chunked.mPolicy) && chunkedInts.getSize() == 10001);
+        assert(chunkedInts[0] == -1 && chunkedInts[1] == sortedInts[0] && chunkedInts[10000] == sortedInts[9999]);
+        MyVector<long> otherType;
+        assert(!otherType.deserialize("Chunked.bin") && !MyChunkedReader<long>("Chunked.bin").isOpen());
+
+        chunked.mBlockElements = 777;
+        chunked.mCodec = MyCodec::Dictionary;
+        assert(colors.serialize("Chunked.bin", chunked) && fileSize("Chunked.bin") * 10 < 10000 * 5);
+        MyVector<std::string> chunkedColors;
+        assert(chunkedColors.deserialize("Chunked.bin", chunked.mPolicy) && chunkedColors.getSize() == 10000);
+        for (int i = 0; i < 10000; i++) {
+            assert(chunkedColors[i] == colors[i]);
+        }
+        assert(!people.serialize("Chunked.bin", chunked)); // No dictionary for Person
+
+        MyVector<Person> crowd;
+        for (int i = 0; i < 5000; i++) {
+            crowd.emplaceBack("Person" + std::to_string(i), i % 90);
+        }
+        chunked.mBlockElements = 128;
+        chunked.mCodec = MyCodec::Raw;
+        assert(crowd.serialize("Chunked.bin", chunked));
+        MyVector<Person> chunkedCrowd;
+        assert(chunkedCrowd.deserialize("Chunked.bin", chunked.mPolicy) && chunkedCrowd.getSize() == 5000);
+        assert(chunkedCrowd[4999].getName() == "Person4999" && chunkedCrowd[4999].getAge() == 4999 % 90);
+        {
+            MyChunkedReader<Person> reader("Chunked.bin");
+            Person person;
+            assert(reader.isOpen() && reader.getSize() == 5000 && reader.getBlockElements() == 128);
+            assert(reader.readAt(3000, person) && person.getName() == "Person3000");
+            assert(reader.readAt(3001, person) && person.getName() == "Person3001" && !reader.readAt(5000, person));
+            MyVector<Person> slice;
+            assert(reader.readRange(100, 1000, slice, chunked.mPolicy) && slice.getSize() == 900);
+            assert(slice[0].getName() == "Person100" && slice[899].getName() == "Person999");
+            assert(reader.readRange(4990, 5000, slice) && slice.getSize() == 910 && slice[909].getAge() == 4999 % 90);
+            assert(reader.readRange(7, 7, slice) && !reader.readRange(4990, 5001, slice) && slice.getSize() == 910);
+        }
+
+        // Flipping a byte of block 10 fails its checksum; the other blocks still read fine
+        {
+            std::fstream file("Chunked.bin", std::ios::binary | std::ios::in | std::ios::out);
+            MyChunkedBlock entry{};
+            MyChunkedTrailer trailer{};
+            file.seekg(-static_cast<std::streamoff>(sizeof(trailer)), std::ios::end);
+            file.read((char *) &trailer, sizeof(trailer));
+            file.seekg(static_cast<std::streamoff>(trailer.mIndexOffset + 10 * sizeof(entry)));
+            file.read((char *) &entry, sizeof(entry));
+            char byte;
+            file.seekg(static_cast<std::streamoff>(entry.mOffset + 20));
+            file.read(&byte, 1);
+            byte ^= 0x40;
+            file.seekp(static_cast<std::streamoff>(entry.mOffset + 20));
+            file.write(&byte, 1);
+        }
+        MyVector<Person> corrupted = {Person("Andriy", 19)};
+        assert(!corrupted.deserialize("Chunked.bin", chunked.mPolicy) && corrupted.getSize() == 1);
+        {
+            MyChunkedReader<Person> reader("Chunked.bin");
+            Person person;
+            assert(!reader.readAt(10 * 128 + 5, person) && reader.readAt(11 * 128, person));
+            assert(person.getName() == "Person1408");
+        }
+        assert(empty.serialize("Chunked.bin", MyChunkedOptions()) && empty.deserialize("Chunked.bin"));
+        assert(empty.getSize() == 0 && MyChunkedReader<int>("Chunked.bin").getSize() == 0);
+        std::remove("Chunked.bin");
+        std::cout << "serialization: OK" << std::endl;
+    }
     /* ============================================================================================================  *
      *                                     FIND/SORT                                                                 |
      * ============================================================================================================  */
-#if 0
-    std::cout << myStringVector.find("2");
-    std::cout << myStringVector.find(2, 6, "4");
+    {
+        assert(myStringVector.find("2") == 1);
+        assert(myStringVector.find(2, 6, "4") == 3);
 
-    // You can also pass custom comparators as arguments:
-    myPeopleVector.sort(PersonAgeComparator());
-    myPeopleVector.print();
-#endif
+        // You can also pass custom comparators as arguments:
+        MyVector<Person> people(myPeopleVector);
+        people.sort(PersonAgeComparator());
+        assert(people[0].getName() == "Viktor" && people[1].getName() == "Andriy");
+    }
+
+    {
+        MyVector<int> emptyInts;
+        emptyInts.sort(); // Used to underflow mSize - 1
+        emptyInts.sort(std::less<int>());
+
+        // Wider than any radix key, sorted by comparisons instead.
+        MyVector<long double> longDoubles = {3, 1, 2};
+        longDoubles.sort();
+        assert(longDoubles[0] == 3 && longDoubles[2] == 1);
+        for (int i = 0; i < 1000; i++) {
+            longDoubles.pushBack(static_cast<long double>((i * 7919) % 1000) / 3);
+        }
+        longDoubles.sort();
+        assert(longDoubles.isSorted() && longDoubles[0] == 333);
+
+        MyVector<int> ints;
+        std::vector<int> expected;
+        for (int i = 0; i < 5000; i++) {
+            int value = (i * 7919) % 1000 - 500;
+            ints.pushBack(value);
+            expected.push_back(value);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        MyVector<int> introSorted(ints), radixSorted(ints), parallelSorted(ints), descending(ints);
+        introSorted.sort(std::less<int>());
+        radixSorted.radixSort();
+        parallelSorted.sort(std::less<int>(), MyParallelPolicy{4, 100});
+        descending.sort();
+        for (size_t i = 0; i < expected.size(); i++) {
+            assert(introSorted[i] == expected[i] && radixSorted[i] == expected[i] && parallelSorted[i] == expected[i]);
+            assert(descending[i] == expected[expected.size() - 1 - i]);
+        }
+
+        // Records by an integral key: stable, so equal ages keep their order.
+        MyVector<Person> people = {Person("Andriy", 19), Person("Viktor", 18), Person("Youssef", 19)};
+        people.radixSort([](const Person &person) { return person.getAge(); });
+        assert(people[0].getName() == "Viktor" && people[1].getName() == "Andriy" && people[2].getName() == "Youssef");
+        people.sort(PersonAgeComparator(), MyParallelPolicy{2, 1});
+        assert(people[0].getAge() == 18 && people[2].getAge() == 19);
+        std::cout << "sort: OK" << std::endl;
+
+        // Projections: every key extracted once, stable, any comparable key type.
+        people = {Person("Youssef", 19), Person("Viktor", 18), Person("Andriy", 19), Person("Anna", 20)};
+        auto ageOf = [](const Person &person) { return person.getAge(); };
+        people.sortBy(ageOf);
+        assert(people[0].getName() == "Viktor" && people[1].getName() == "Youssef" && people[2].getName() == "Andriy");
+        assert(people.isSorted(PersonAgeComparator()) && people.binarySearchBy(19, ageOf) == 1);
+        assert(people.lowerBoundBy(21, ageOf) == 4 && people.binarySearchBy(17, ageOf) == MyVector<Person>::npos);
+        people.sortBy([](const Person &person) { return person.getName(); }, std::greater<>());
+        assert(people[0].getName() == "Youssef" && people[3].getName() == "Andriy");
+        people.topK(2, ageOf);
+        assert(people[0].getName() == "Anna" && people[1].getName() == "Youssef");
+        MyVector<long double> wideKeys = {2.5L, -1.0L, 7.0L};
+        wideKeys.sortBy([](long double value) { return value; }); // No radix key that wide, compared instead
+        assert(wideKeys[0] == -1.0L && wideKeys[2] == 7.0L);
+        MyVector<int> noInts;
+        noInts.nthElement(3, std::less<int>()); // Past the end of an empty vector, nothing happens
+        wideKeys.nthElement(10, std::less<long double>());
+        assert(wideKeys.isSorted(std::less<long double>()));
+
+        // Selection: partialSort/topK against a full sort, nthElement against the sorted position.
+        for (size_t k : {size_t(0), size_t(1), size_t(17), size_t(100), size_t(5000), size_t(6000)}) {
+            MyVector<int> partial(ints), top(ints), nth(ints);
+            partial.partialSort(k, std::less<int>());
+            top.topK(k, [](int value) { return value; });
+            for (size_t i = 0; i < std::min(k, expected.size()); i++) {
+                assert(partial[i] == expected[i] && top[i] == expected[expected.size() - 1 - i]);
+            }
+            top.sort(std::less<int>()); // Nothing lost in the shuffle
+            for (size_t i = 0; i < expected.size(); i++) {
+                assert(top[i] == expected[i]);
+            }
+            nth.nthElement(k, std::less<int>());
+            if (k < expected.size()) {
+                assert(nth[k] == expected[k]);
+                for (size_t i = 0; i < expected.size(); i++) {
+                    assert(i < k ? nth[i] <= nth[k] : nth[i] >= nth[k]);
+                }
+            }
+        }
+        MyVector<int> byKey(ints);
+        byKey.sortBy([](int value) { return -value; }, [](int first, int second) { return first > second; });
+        assert(byKey.isSorted(std::less<int>()) && byKey[0] == expected[0]);
+        assert(introSorted.isSorted(std::less<int>()) && descending.isSorted() && !ints.isSorted(std::less<int>()));
+        assert(introSorted.binarySearch(-500, std::less<int>()) == 0);
+        assert(introSorted[introSorted.lowerBound(0, std::less<int>())] == 0);
+        assert(introSorted.binarySearch(500, std::less<int>()) == MyVector<int>::npos);
+        std::cout << "partial sort: OK" << std::endl;
+
+        // find/count/contains, vectorized for arithmetic elements.
+        assert(ints.find(ints[4321]) <= 4321 && ints.find(12345) == MyVector<int>::npos);
+        assert(ints.contains(-500) && !ints.contains(500));
+        assert(ints.count(0) == 5 && ints.find(10, 20, ints[15]) <= 15 && ints.find(20, 10, 0) == MyVector<int>::npos);
+        MyVector<double> signedZeros = {1.0, -0.0, 2.0};
+        assert(signedZeros.find(0.0) == 1 && signedZeros.count(2.0) == 1);
+        MyVector<std::string> strings = {"1", "2", "3", "2"};
+        assert(strings.find("2") == 1 && strings.count("2") == 2 && strings.find(2, 4, "2") == 3);
+        std::cout << "find: OK" << std::endl;
+    }
     /* ============================================================================================================  *
-     *                                     ITERATORS                                                                 |
+     *                                     COPY/MOVE                                                                 |
+     * ============================================================================================================  */
+    {
+        // Short strings stay in the SSO buffer, so the only allocations counted here are MyVector's own blocks.
+        MyVector<std::string> source;
+        for (int i = 0; i < 100; i++) {
+            source.pushBack(std::to_string(i));
+        }
+        std::string *sourceBlock = &source[0];
+
+        // Moving steals the block: no allocation, and the source ends up empty.
+        size_t allocationsBefore = gAllocationCount;
+        MyVector<std::string> moved(std::move(source));
+        assert(gAllocationCount == allocationsBefore);
+        assert(&moved[0] == sourceBlock);
+        assert(source.getSize() == 0 && source.getCapacity() == 0);
+
+        MyVector<std::string> moveAssigned = {"x"};
+        allocationsBefore = gAllocationCount;
+        moveAssigned = std::move(moved);
+        assert(gAllocationCount == allocationsBefore);
+        assert(&moveAssigned[0] == sourceBlock && moveAssigned.getSize() == 100);
+        assert(moved.getSize() == 0);
+
+        // Copying makes one allocation, sized exactly to the elements.
+        allocationsBefore = gAllocationCount;
+        MyVector<std::string> copied(moveAssigned);
+        assert(gAllocationCount == allocationsBefore + 1);
+        assert(copied.getCapacity() == copied.getSize() && copied[99] == "99");
+
+        allocationsBefore = gAllocationCount;
+        source = copied;
+        assert(gAllocationCount == allocationsBefore + 1);
+        assert(source.getSize() == 100 && source[42] == "42");
+
+        // Swapping only exchanges pointers.
+        allocationsBefore = gAllocationCount;
+        swap(source, moved);
+        assert(gAllocationCount == allocationsBefore);
+        assert(source.getSize() == 0 && moved.getSize() == 100);
+        std::cout << "copy/move: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     ALLOCATORS                                                                |
+     * ============================================================================================================  */
+    {
+        // One arena per "request": vectors grow inside it and everything is dropped at once.
+        MyArenaResource arena;
+        for (int request = 0; request < 3; request++) {
+            MyVector<int, MyArenaAllocator<int>> ids{MyArenaAllocator<int>(arena)};
+            MyVector<std::string, MyArenaAllocator<std::string>> names{MyArenaAllocator<std::string>(arena)};
+            for (int i = 0; i < 1000; i++) {
+                ids.pushBack(i);
+                names.emplaceBack(std::to_string(i));
+            }
+            assert(ids.getSize() == 1000 && ids[999] == 999 && names[500] == "500");
+
+            // Copies stay in the same arena.
+            MyVector<int, MyArenaAllocator<int>> idsCopy(ids);
+            assert(&idsCopy.getAllocator().getArena() == &arena && idsCopy[10] == 10);
+        }
+        arena.release();
+
+        // The pool hands a freed block back to the next vector of the same size class.
+        const int *firstBlock = nullptr;
+        for (int round = 0; round < 2; round++) {
+            MyVector<int, MyPoolAllocator<int>> pooled;
+            for (int i = 0; i < 100; i++) {
+                pooled.pushBack(i);
+            }
+            if (round == 0) {
+                firstBlock = &pooled[0];
+            } else {
+                assert(&pooled[0] == firstBlock);
+            }
+        }
+
+        MyVector<Person, MyPoolAllocator<Person>> pooledPeople = {Person("Andriy", 19), Person("Viktor", 18)};
+        MyVector<Person, MyPoolAllocator<Person>> movedPeople;
+        movedPeople = std::move(pooledPeople);
+        assert(movedPeople.getSize() == 2 && movedPeople[1].getName() == "Viktor");
+
+        // Growth policies only change how much getCapacity is added at a time.
+        MyVector<int, MyHeapAllocator<int>, MyOneAndHalfGrowth> slowGrowing;
+        MyVector<char, MyHeapAllocator<char>, MyPageRoundedGrowth<>> pageGrowing;
+        for (int i = 0; i < 5000; i++) {
+            slowGrowing.pushBack(i);
+            pageGrowing.pushBack('a');
+        }
+        assert(slowGrowing.getCapacity() < 5000 * 3 / 2 + 2 && slowGrowing[4999] == 4999);
+        assert(pageGrowing.getCapacity() % kMyPageSize == 0);
+
+        // Mapped storage grows inside its reservation without the elements ever moving.
+        MyLargeVector<int> large{MyMappedAllocator<int>(1024 * 1024)};
+        large.pushBack(0);
+        const int *mappedBlock = &large[0];
+        for (int i = 1; i < 200000; i++) {
+            large.pushBack(i);
+        }
+        assert(&large[0] == mappedBlock && large[199999] == 199999);
+        // Past the reservation the block is remapped, the contents come along.
+        for (int i = 200000; i < 600000; i++) {
+            large.pushBack(i);
+        }
+        large.resize(1000000, 7);
+        assert(large[0] == 0 && large[599999] == 599999 && large[999999] == 7);
+        large.resize(10);
+        large.shrinkToFit();
+        assert(large.getCapacity() == 10 && large[9] == 9);
+
+        MyVector<std::string, MyMappedAllocator<std::string>> mappedStrings{MyMappedAllocator<std::string>(1 << 20, false)};
+        mappedStrings.assign(1000, "not trivially relocatable");
+        const std::string *firstString = &mappedStrings[0];
+        mappedStrings.appendRange(mappedStrings.begin(), mappedStrings.end());
+        assert(&mappedStrings[0] == firstString && mappedStrings.getSize() == 2000);
+        std::cout << "allocators: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     SMALL VECTOR                                                              |
+     * ============================================================================================================  */
+    {
+        // Up to N elements nothing is allocated.
+        size_t allocationsBefore = gAllocationCount;
+        MySmallVector<std::string, 4> smallStrings;
+        for (int i = 0; i < 4; i++) {
+            smallStrings.pushBack(std::to_string(i));
+        }
+        assert(gAllocationCount == allocationsBefore && smallStrings.isInline());
+
+        // The fifth element spills everything to the heap.
+        smallStrings.emplaceBack("4");
+        assert(!smallStrings.isInline() && smallStrings.getSize() == 5 && smallStrings[0] == "0");
+
+        MySmallVector<std::string, 4> movedStrings(std::move(smallStrings));
+        assert(movedStrings.getSize() == 5 && smallStrings.getSize() == 0 && smallStrings.isInline());
+        movedStrings.popBack();
+        movedStrings.shrinkToFit();
+        assert(movedStrings.isInline() && movedStrings[3] == "3");
+
+        MySmallVector<int, 8> smallInts = {3, 1, 2};
+        smallInts.sort();
+        assert(smallInts[0] == 3 && smallInts[2] == 1 && smallInts.find(2) == 1);
+        int total = 0;
+        for (auto &element : smallInts) {
+            total += element;
+        }
+        assert(total == 6);
+
+        // A copy that throws halfway frees the heap block it had taken.
+        struct ThrowingCopy {
+            int *mCopiesLeft;
+            explicit ThrowingCopy(int *copiesLeft) : mCopiesLeft(copiesLeft) {}
+            ThrowingCopy(const ThrowingCopy &another) : mCopiesLeft(another.mCopiesLeft) {
+                if ((*mCopiesLeft)-- == 0) {
+                    throw std::runtime_error("copy");
+                }
+            }
+        };
+        int copiesLeft = 100;
+        MySmallVector<ThrowingCopy, 2> throwing;
+        for (int i = 0; i < 6; i++) {
+            throwing.emplaceBack(&copiesLeft);
+        }
+        copiesLeft = 3;
+        bool copyThrew = false;
+        try {
+            MySmallVector<ThrowingCopy, 2> copy(throwing);
+        } catch (const std::runtime_error &) {
+            copyThrew = true;
+        }
+        assert(copyThrew);
+
+        // Appending one of our own elements while spilling to the heap.
+        MySmallVector<std::string, 1> selfStrings;
+        selfStrings.pushBack(std::string(40, 'x'));
+        selfStrings.pushBack(selfStrings[0]);
+        selfStrings.emplaceBack(selfStrings[1]);
+        assert(selfStrings.getSize() == 3 && selfStrings[2] == std::string(40, 'x'));
+
+        // Files are interchangeable with MyVector.
+        smallInts.serialize("SmallSerialized.bin");
+        MyVector<int> fromSmall;
+        fromSmall.deserialize("SmallSerialized.bin");
+        assert(fromSmall.getSize() == 3 && fromSmall[1] == 2);
+        std::remove("SmallSerialized.bin");
+        std::cout << "small vector: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     PARALLEL ALGORITHMS                                                       |
+     * ============================================================================================================  */
+    {
+        // A pool of our own, so the chunks really run on other threads even on a single core machine.
+        MyThreadPool pool(3);
+        MyParallelPolicy policy{4, 1, &pool};
+
+        MyVector<long> numbers;
+        for (long i = 1; i <= 10000; i++) {
+            numbers.pushBack(i);
+        }
+        numbers.transform([](long number) { return number * 2; }, policy);
+        numbers.forEach([](long &number) { number += 1; }, policy);
+        assert(numbers[0] == 3 && numbers[9999] == 20001);
+        assert(numbers.reduce(0L, [](long sum, long number) { return sum + number; }, policy) == 100020000L);
+        assert(numbers.countIf([](long number) { return number % 3 == 0; }, policy) == 3334);
+
+        // Not commutative: chunk results have to be combined in order.
+        MyVector<std::string> letters;
+        for (int i = 0; i < 26; i++) {
+            letters.pushBack(std::string(1, char('a' + i)));
+        }
+        std::string alphabet = letters.reduce(">", [](const std::string &left, const std::string &right) {
+            return left + right;
+        }, policy);
+        assert(alphabet == ">abcdefghijklmnopqrstuvwxyz");
+
+        // Too little work for the default policy: runs serially, on this thread.
+        std::thread::id caller = std::this_thread::get_id();
+        MyVector<int> few = {1, 2, 3};
+        few.forEach([caller](int &) { assert(std::this_thread::get_id() == caller); });
+        assert(few.reduce(10, [](int sum, int number) { return sum + number; }) == 16);
+        assert(MyVector<int>().reduce(7, [](int sum, int number) { return sum + number; }, policy) == 7);
+
+        bool thrown = false;
+        try {
+            numbers.forEach([](long number) {
+                if (number == 15001) {
+                    throw std::runtime_error("bad element");
+                }
+            }, policy);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        assert(thrown);
+        std::cout << "parallel: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     CONCURRENT VECTOR                                                         |
+     * ============================================================================================================  */
+    {
+        MyConcurrentVector<long> results;
+        long &first = results.emplaceBack(-1);
+
+        // Producers push while a reader keeps walking whatever has been published so far.
+        const long kProducers = 4, kPerProducer = 20000;
+        std::atomic<bool> producing{true};
+        std::thread reader([&results, &producing] {
+            size_t lastSize = 0;
+            while (producing.load()) {
+                size_t size = results.getSize();
+                assert(size >= lastSize);
+                for (size_t i = 0; i < size; i++) {
+                    assert(results[i] == -1 || (results[i] >= 0 && results[i] < kProducers * kPerProducer));
+                }
+                lastSize = size;
+            }
+        });
+        MyVector<std::thread> producers;
+        for (long producer = 0; producer < kProducers; producer++) {
+            producers.emplaceBack([&results, producer] {
+                for (long i = 0; i < kPerProducer; i++) {
+                    results.pushBack(producer * kPerProducer + i);
+                }
+            });
+        }
+        for (auto &producer : producers) {
+            producer.join();
+        }
+        producing.store(false);
+        reader.join();
+
+        // Every value exactly once, and the very first element never moved.
+        assert(results.getSize() == kProducers * kPerProducer + 1 && &results[0] == &first && first == -1);
+        MyVector<bool> seen;
+        seen.resize(kProducers * kPerProducer, false);
+        long total = 0;
+        for (long value : results) {
+            if (value >= 0) {
+                assert(!seen[value]);
+                seen[value] = true;
+                total += value;
+            }
+        }
+        assert(total == kProducers * kPerProducer * (kProducers * kPerProducer - 1) / 2);
+        assert(results.find(12345) != MyConcurrentVector<long>::npos && results.count(-1) == 1);
+        assert(!results.contains(kProducers * kPerProducer) && results.getCapacity() >= results.getSize());
+
+        results.clear();
+        results.reserve(1000);
+        MyConcurrentVector<std::string> names = {"a", "b"};
+        names.pushBack("c");
+        assert(results.getSize() == 0 && results.getCapacity() >= 1000 && names.getSize() == 3 && names[2] == "c");
+
+        // A constructor that throws does so before a slot is claimed, later pushes still get published.
+        struct Fragile {
+            int mValue;
+            explicit Fragile(int value) : mValue(value) {
+                if (value < 0) {
+                    throw std::runtime_error("negative");
+                }
+            }
+            Fragile(const Fragile &another) : Fragile(another.mValue) {}
+            Fragile(Fragile &&another) noexcept : mValue(another.mValue) {}
+        };
+        MyConcurrentVector<Fragile> fragile;
+        fragile.emplaceBack(1);
+        int throws = 0;
+        try {
+            fragile.emplaceBack(-1);
+        } catch (const std::runtime_error &) {
+            throws++;
+        }
+        Fragile broken(2);
+        broken.mValue = -2;
+        try {
+            fragile.pushBack(broken);
+        } catch (const std::runtime_error &) {
+            throws++;
+        }
+        fragile.pushBack(Fragile(3));
+        assert(throws == 2 && fragile.getSize() == 2 && fragile[1].mValue == 3);
+        fragile.clear();
+        std::cout << "concurrent vector: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     STRUCTURE OF ARRAYS                                                       |
+     * ============================================================================================================  */
+    {
+        using PersonName = MyField<Person, std::string, &Person::getName>;
+        using PersonAge = MyField<Person, int, &Person::getAge>;
+
+        MyPersonSoAVector people = {Person("Andriy", 19), Person("Viktor", 18), Person("Olena", 21)};
+        people.pushBack(Person("Taras", 19));
+        people.emplaceBack("Iryna", 18);
+        assert(people.getSize() == 5 && people.column<PersonAge>().getSize() == 5);
+        assert(people[1].get<PersonName>() == "Viktor" && people[4].get<PersonAge>() == 18);
+
+        // Column scans
+        assert(people.find<PersonAge>(21) == 2 && people.count<PersonAge>(19) == 2);
+        assert(people.contains<PersonName>("Taras") && !people.contains<PersonAge>(99));
+        assert(people.countIf<PersonAge>([](int age) { return age > 18; }) == 3);
+
+        // Rows write through to the columns
+        people[0].get<PersonAge>() = 20;
+        people[3] = Person("Taras", 22);
+        assert(people.column<PersonAge>()[0] == 20 && people[3].toRecord().getAge() == 22);
+
+        // Sorting by one column moves the others along, ties keep their order
+        people.sortBy<PersonAge>();
+        const char *byAge[] = {"Viktor", "Iryna", "Andriy", "Olena", "Taras"};
+        for (size_t i = 0; i < people.getSize(); i++) {
+            assert(people[i].get<PersonName>() == byAge[i]);
+        }
+        people.sortBy<PersonName>(std::greater<std::string>());
+        assert(people[0].get<PersonName>() == "Viktor" && people[0].get<PersonAge>() == 18);
+        people.radixSortBy<PersonAge>(true);
+        assert(people[0].toRecord().getName() == "Taras" && people[3].get<PersonName>() == "Viktor");
+
+        // Against MyVector<Person> sorted the usual way
+        MyVector<Person> records;
+        MyPersonSoAVector columns;
+        for (int i = 0; i < 1000; i++) {
+            records.emplaceBack(std::to_string(i), (i * 37) % 100);
+            columns.emplaceBack(std::to_string(i), (i * 37) % 100);
+        }
+        records.radixSort([](const Person &person) { return person.getAge(); });
+        columns.sortBy<PersonAge>();
+        size_t row = 0;
+        for (auto person : columns) {
+            assert(person.toRecord().getName() == records[row].getName());
+            assert(person.get<PersonAge>() == records[row++].getAge());
+        }
+        assert(row == 1000);
+
+        columns.popBack();
+        assert(columns.getSize() == 999);
+        columns.clear();
+        assert(columns.getSize() == 0 && columns.column<PersonName>().getSize() == 0);
+
+        // A field that throws halfway through a row leaves no column a row ahead of the others.
+        struct Badge {
+            int *mCopiesLeft;
+            explicit Badge(int *copiesLeft) : mCopiesLeft(copiesLeft) {}
+            Badge(const Badge &another) : mCopiesLeft(another.mCopiesLeft) {
+                if ((*mCopiesLeft)-- == 0) {
+                    throw std::runtime_error("copy");
+                }
+            }
+        };
+        struct Employee {
+            int mId;
+            Badge mBadge;
+            Employee(int id, Badge badge) : mId(id), mBadge(badge) {}
+            int getId() const { return mId; }
+            Badge getBadge() const { return mBadge; }
+        };
+        using EmployeeId = MyField<Employee, int, &Employee::getId>;
+        using EmployeeBadge = MyField<Employee, Badge, &Employee::getBadge>;
+        int copiesLeft = 100;
+        Employee employee(7, Badge(&copiesLeft));
+        MySoAVector<Employee, EmployeeId, EmployeeBadge> staff;
+        staff.pushBack(employee);
+        copiesLeft = 0;
+        bool rowThrew = false;
+        try {
+            staff.pushBack(employee);
+        } catch (const std::runtime_error &) {
+            rowThrew = true;
+        }
+        assert(rowThrew && staff.getSize() == 1 && staff.column<EmployeeId>().getSize() == 1);
+        assert(staff.column<EmployeeBadge>().getSize() == 1);
+        std::cout << "structure of arrays: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     PACKED BOOL VECTOR                                                        |
+     * ============================================================================================================  */
+    {
+        MyVector<bool> flags = {true, false, true};
+        flags.pushBack(true);
+        assert(flags.getSize() == 4 && flags[0] && !flags[1] && flags.count(true) == 3);
+        flags[1] = true;
+        flags[0] = flags[3] = false;
+        assert(!flags[0] && flags[1] && flags.find(false) == 0 && flags.find(true) == 1);
+
+        // 64 flags per word, words are found and counted whole
+        MyVector<bool> many;
+        many.resize(1000, false);
+        assert(many.getCapacity() == 1024 && many.none() && many.find(true) == MyVector<bool>::npos);
+        many[777] = true;
+        many[64] = true;
+        assert(many.count(true) == 2 && many.count(false) == 998 && many.find(true) == 64);
+        assert(many.find(65, 1000, true) == 777 && many.find(65, 777, true) == MyVector<bool>::npos);
+        many.resize(1100, true);
+        assert(many.count(true) == 102 && many.find(1000, 1100, false) == MyVector<bool>::npos);
+        many.resize(700);
+        assert(many.count(true) == 1 && many.getSize() == 700);
+        many.flip();
+        assert(many.count(true) == 699 && !many[64]);
+        many.erase(0, 64);
+        assert(many.getSize() == 636 && many.find(false) == 0 && many.count(false) == 1);
+
+        // Bulk operations against a reference, including a shorter right-hand side
+        MyVector<bool> left, right;
+        std::vector<bool> expectedAnd, expectedOr, expectedXor;
+        for (size_t i = 0; i < 300; i++) {
+            bool a = i % 3 == 0;
+            bool b = i % 5 == 0 && i < 200;
+            left.pushBack(a);
+            if (i < 200) {
+                right.pushBack(b);
+            }
+            expectedAnd.push_back(a && b);
+            expectedOr.push_back(a || b);
+            expectedXor.push_back(a != b);
+        }
+        MyVector<bool> conjunction = left & right, disjunction = left | right, exclusive = left ^ right;
+        assert(conjunction.getSize() == 300 && disjunction.getSize() == 300);
+        for (size_t i = 0; i < 300; i++) {
+            assert(conjunction[i] == expectedAnd[i] && disjunction[i] == expectedOr[i] && exclusive[i] == expectedXor[i]);
+        }
+        assert(conjunction.count(true) == 14 && (disjunction ^ exclusive) == conjunction);
+
+        // Raw words on disk, appended on a word boundary and off it
+        assert(left.serialize("test_bits.bin"));
+        MyVector<bool> loaded;
+        assert(loaded.deserialize("test_bits.bin") && loaded == left);
+        loaded.clear();
+        loaded.pushBack(true);
+        assert(loaded.deserialize("test_bits.bin") && loaded.getSize() == 301 && loaded[0]);
+        for (size_t i = 0; i < 300; i++) {
+            assert(loaded[i + 1] == left[i]);
+        }
+        assert(left.serialize("test_bits.bin", MyFileFormat::Text));
+        MyVector<bool> fromText;
+        assert(fromText.deserialize("test_bits.bin") && fromText == left);
+        std::remove("test_bits.bin");
+
+        int ones = 0;
+        for (bool flag : flags) {
+            ones += flag ? 1 : 0;
+        }
+        for (auto flag : flags) {
+            flag = true;
+        }
+        assert(ones == 2 && flags.all());
+        std::cout << "packed bool vector: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     COPY-ON-WRITE                                                             |
+     * ============================================================================================================  */
+    {
+        MyVector<std::string> source;
+        for (int i = 0; i < 100; i++) {
+            source.pushBack("value " + std::to_string(i));
+        }
+        MyCowVector<std::string> config(std::move(source));
+        assert(source.getSize() == 0 && config.getSize() == 100 && !config.isShared());
+
+        // Snapshots and reads through them allocate nothing
+        size_t allocationsBefore = gAllocationCount;
+        MyCowVector<std::string> first = config.snapshot();
+        MyCowVector<std::string> second(config);
+        const MyCowVector<std::string> &reader = second;
+        assert(reader[42] == "value 42" && reader.find("value 7") == 7 && reader.contains("value 99"));
+        size_t length = 0;
+        for (const auto &value : reader) {
+            length += value.size();
+        }
+        assert(length == 10 * 7 + 90 * 8 && gAllocationCount == allocationsBefore);
+        assert(config.isShared() && &first.read() == &config.read());
+
+        // The first write detaches, once; the other holders keep the old elements
+        first.pushBack("extra");
+        first[0] = "changed";
+        assert(!first.isShared() && first.getSize() == 101 && first[0] == "changed");
+        assert(config.getSize() == 100 && config.read()[0] == "value 0" && reader[0] == "value 0");
+        assert(&second.read() == &config.read() && &first.read() != &config.read());
+
+        // Non-const operator[] counts as a write, reads through a const reference don't detach
+        second.sort(std::greater<std::string>());
+        assert(reader[0] == "value 99" && config.read()[0] == "value 0" && !config.isShared());
+
+        // A vector nobody shares is written in place
+        const std::string *before = &config.read()[0];
+        config[0] = "in place";
+        assert(&config.read()[0] == before);
+
+        // A reference handed out before a snapshot can't write into it
+        std::string &kept = config[1];
+        MyCowVector<std::string> later = config.snapshot();
+        kept = "through the reference";
+        assert(later.read()[1] == "value 1" && config.read()[1] == "through the reference" && !later.isShared());
+        MyCowVector<std::string> shared = later.snapshot(); // later handed out no reference, so it shares
+        assert(shared.isShared() && &shared.read() == &later.read());
+
+        MyVector<std::string> released = first.release();
+        assert(released.getSize() == 101 && first.getSize() == 0 && released[100] == "extra");
+        MyCowVector<int> empty;
+        MyCowVector<int> emptyCopy = empty.snapshot();
+        emptyCopy.pushBack(1);
+        assert(empty.getSize() == 0 && emptyCopy.getSize() == 1 && !empty.contains(1));
+        std::cout << "copy-on-write: OK" << std::endl;
+    }
+
+    /* ============================================================================================================  *
+     *                                     HASH INDEX                                                                |
      * ============================================================================================================  */
-#if 0
-    for(const auto &element : myIntVector) {
-        std::cout << element ;
+    {
+        // The index agrees with a linear scan through appends, duplicates, pops (with slots shifting back) and
+        // the operations that rebuild it.
+        MyIndexedVector<int> ids;
+        MyVector<int> plain;
+        for (int i = 0; i < 3000; i++) {
+            int id = (i * 7919) % 1024 * 64; // Round numbers with duplicates
+            ids.pushBack(id);
+            plain.pushBack(id);
+        }
+        for (int i = 0; i < 1500; i++) {
+            ids.popBack();
+            plain.popBack();
+        }
+        auto matchesPlain = [&ids, &plain] {
+            for (int id = -64; id < 1024 * 64 + 64; id += 32) {
+                if (ids.find(id) != plain.find(id) || ids.count(id) != plain.count(id) ||
+                    ids.contains(id) != plain.contains(id)) {
+                    return false;
+                }
+            }
+            return ids.getSize() == plain.getSize();
+        };
+        assert(matchesPlain() && ids.getKeyCount() == 1024);
+        std::vector<int> batch = {5, 64, 5, 1 << 20};
+        ids.appendRange(batch.begin(), batch.end());
+        plain.appendRange(batch.begin(), batch.end());
+        assert(matchesPlain() && ids.count(5) == 2 && ids.find(1 << 20) == 1503 && ids.getKeyCount() == 1026);
+        ids.sort();
+        plain.sort();
+        assert(matchesPlain() && ids.find(ids[0]) == 0);
+        auto isOdd = [](int id) { return id / 64 % 2 == 1; };
+        assert(ids.removeIf(isOdd) == plain.removeIf(isOdd) && matchesPlain());
+        assert(ids.erase(10, 300) == plain.erase(10, 300) && matchesPlain());
+        MyIndexedVector<int> copy(ids);
+        ids.clear();
+        assert(!ids.contains(copy[0]) && ids.getSize() == 0 && copy.find(copy[0]) == 0);
+
+        assert(copy.serialize("indexed.bin"));
+        assert(ids.deserialize("indexed.bin") && ids.getSize() == copy.getSize());
+        for (size_t i = 0; i < copy.getSize(); i++) {
+            assert(ids.find(copy[i]) <= i && ids[ids.find(copy[i])] == copy[i]);
+        }
+        std::remove("indexed.bin");
+
+        // A truncated file: the elements read before the damage are indexed, popping them works.
+        MyVector<std::string> keys;
+        for (int i = 0; i < 10; i++) {
+            keys.pushBack("k" + std::to_string(i));
+        }
+        assert(keys.serialize("indexed.bin"));
+        std::string fileBytes;
+        {
+            std::ifstream file("indexed.bin", std::ios::binary);
+            fileBytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream file("indexed.bin", std::ios::binary);
+            file.write(fileBytes.data(), static_cast<std::streamsize>(fileBytes.size() - 1));
+        }
+        MyIndexedVector<std::string> truncatedKeys;
+        assert(!truncatedKeys.deserialize("indexed.bin") && truncatedKeys.getSize() == 9);
+        assert(truncatedKeys.find("k3") == 3 && truncatedKeys.find("k9") == MyIndexedVector<std::string>::npos);
+        while (truncatedKeys.getSize() > 0) {
+            truncatedKeys.popBack();
+        }
+        assert(!truncatedKeys.contains("k0"));
+        std::remove("indexed.bin");
+
+        // Indexed by a projection: people by name.
+        MyPersonNameIndex people = {Person("Andriy", 19), Person("Viktor", 18)};
+        people.emplaceBack("Youssef", 19);
+        people.pushBack(Person("Andriy", 20));
+        assert(people.find("Viktor") == 1 && people.find("Andriy") == 0 && people.count("Andriy") == 2);
+        assert(!people.contains("Nobody") && people.find("Nobody") == MyPersonNameIndex::npos);
+        people.sort([](const Person &first, const Person &second) { return first.getAge() > second.getAge(); });
+        assert(people[people.find("Andriy")].getAge() == 20);
+        people.popBack(); // Viktor, the youngest
+        assert(!people.contains("Viktor") && people.count("Andriy") == 2);
+        MyVector<Person> released = people.release();
+        assert(released.getSize() == 3 && people.getSize() == 0 && !people.contains("Andriy"));
+        std::cout << "hash index: OK" << std::endl;
     }
 
-    for (auto it = myIntVector.begin(); it != myIntVector.end(); it++) {
-        std::cout << *it;
+    /* ============================================================================================================  *
+     *                                     STATS                                                                     |
+     * ============================================================================================================  */
+#if MY_VECTOR_STATS
+    {
+        struct CountingHooks : MyVectorHooks {
+            size_t mAllocations = 0;
+            size_t mOperations = 0;
+
+            void onEvent(const MyVectorEvent &event) override {
+                mAllocations += event.mKind == MyVectorEventKind::Allocate ? 1 : 0;
+                mOperations += event.mKind == MyVectorEventKind::Operation ? 1 : 0;
+            }
+        } hooks;
+        mySetVectorHooks(&hooks);
+
+        MyVectorStats typeBefore = myTypeStats<short>().snapshot();
+        {
+            MyVector<short> shorts;
+            for (short i = 0; i < 100; i++) {
+                shorts.pushBack(i);
+            }
+            shorts.sort();
+            assert(shorts.contains(42) && shorts.count(7) == 1);
+
+            // 1, 2, 4, ..., 128: eight blocks, every growth moved the elements it had.
+            MyVectorStats stats = shorts.getStats();
+            assert(stats.mAllocations == 8 && stats.mPeakCapacity == 128);
+            assert(stats.mBytesMoved == (1 + 2 + 4 + 8 + 16 + 32 + 64) * sizeof(short));
+            assert(stats.mWastedBytes == 28 * sizeof(short) && stats.mSorts == 1 && stats.mFinds == 2);
+
+            MyVector<short> copy(shorts);
+            assert(copy.getStats().mAllocations == 1 && copy.getStats().mWastedBytes == 0);
+        }
+        MyVectorStats typeStats = myTypeStats<short>().snapshot();
+        assert(typeStats.mAllocations - typeBefore.mAllocations == 9);
+        assert(typeStats.mWastedBytes - typeBefore.mWastedBytes == 28 * sizeof(short));
+        assert(hooks.mAllocations == 9 && hooks.mOperations == 3);
+        mySetVectorHooks(nullptr);
+
+        std::ostringstream json;
+        myDumpVectorStats(json, MyStatsFormat::Json);
+        assert(json.str().front() == '[' && json.str().find("\"type\": \"short\"") != std::string::npos);
+        std::cout << "stats: OK" << std::endl;
     }
 #endif
 
+    /* ============================================================================================================  *
+     *                                     ITERATORS                                                                 |
+     * ============================================================================================================  */
+    {
+        int sum = 0;
+        for (const auto &element : myIntVector) {
+            sum += element;
+        }
+        assert(sum == 21);
+
+        std::string text;
+        for (auto it = myStringVector.begin(); it != myStringVector.end(); it++) {
+            text += *it;
+        }
+        assert(text == "123456");
+        auto last = myStringVector.end();
+        --last;
+        assert(*last == "6" && last->size() == 1);
+
+        // Random access: the std algorithms take MyVector as it is
+        MyVector<int> numbers;
+        for (int i = 0; i < 1000; i++) {
+            numbers.pushBack((i * 7919) % 1000);
+        }
+        std::sort(numbers.begin(), numbers.end());
+        assert(std::is_sorted(numbers.cbegin(), numbers.cend()) && numbers.end() - numbers.begin() == 1000);
+        assert(*std::lower_bound(numbers.begin(), numbers.end(), 500) == 500);
+        assert(std::binary_search(numbers.begin(), numbers.end(), 999));
+        assert(std::accumulate(numbers.begin(), numbers.end(), 0) == 499500);
+        assert(std::reduce(numbers.cbegin(), numbers.cend(), 0) == 499500);
+        auto it = numbers.begin() + 10;
+        it += 5;
+        it -= 3;
+        assert(it[0] == 12 && it[-2] == 10 && *(2 + it) == 14 && *(it - 12) == 0 && it - numbers.begin() == 12);
+        assert(numbers.begin() < it && it <= it && it >= numbers.begin() && numbers.end() > it);
+
+        // Const iteration, mixed with non-const iterators, reverse and raw data
+        const MyVector<int> &constNumbers = numbers;
+        MyVector<int>::const_iterator constIt = numbers.begin();
+        assert(constIt == numbers.begin() && constIt != numbers.end() && constNumbers.begin() == numbers.cbegin());
+        assert(*constNumbers.rbegin() == 999 && *numbers.rbegin() == 999 && *(numbers.crend() - 1) == 0);
+        std::reverse(numbers.begin(), numbers.end());
+        assert(numbers.data()[0] == 999 && constNumbers.data() + constNumbers.getSize() == &*constNumbers.end());
+        assert(constNumbers.at(999) == 0 && std::is_sorted(numbers.rbegin(), numbers.rend()));
+        assert(MyVector<int>().data() == nullptr && MyVector<int>().begin() == MyVector<int>().end());
+        std::cout << "iterators: OK" << std::endl;
+    }
+
 
     return 0;
 }